@@ -19,6 +19,7 @@
 
 #include "clockDialog.h"
 #include "common.h"
+#include "delaydialog.h"
 #include "editor.h"
 #include "elementfactory.h"
 #include "elementmapping.h"
@@ -70,6 +71,7 @@ BewavedDolphin::BewavedDolphin(Editor *editor, QWidget *parent)
     , m_editor(editor)
     , m_mainWindow(dynamic_cast<MainWindow *>(parent))
     , m_type(PlotType::line)
+    , m_timed(false)
 {
     m_scale = 1.0;
     m_ui->setupUi(this);
@@ -79,7 +81,15 @@ BewavedDolphin::BewavedDolphin(Editor *editor, QWidget *parent)
     QSettings settings(QSettings::IniFormat, QSettings::UserScope, QApplication::organizationName(), QApplication::applicationName());
     settings.beginGroup("BewavedDolphin");
     restoreGeometry(settings.value("geometry").toByteArray());
+    m_timed = settings.value("propagationDelays", false).toBool();
+    // Gate delays by LogicType, in delay units; see TimedNetlist::defaultDelay() for the missing ones.
+    for (const QVariant &delay : settings.value("gateDelays").toList()) {
+        m_delays.append(delay.toInt());
+    }
+    m_delays = DelayDialog::withDefaults(m_delays);
     settings.endGroup();
+    saveDelays();
+    m_ui->actionPropagationDelays->setChecked(m_timed);
     m_gv = new GraphicsView(this);
     m_ui->verticalLayout->addWidget(m_gv);
     m_scene = new QGraphicsScene(this);
@@ -104,10 +114,23 @@ BewavedDolphin::~BewavedDolphin()
     QSettings settings(QSettings::IniFormat, QSettings::UserScope, QApplication::organizationName(), QApplication::applicationName());
     settings.beginGroup("BewavedDolphin");
     settings.setValue("geometry", saveGeometry());
+    settings.setValue("propagationDelays", m_timed);
     settings.endGroup();
     delete m_ui;
 }
 
+void BewavedDolphin::saveDelays()
+{
+    QVariantList delays;
+    for (int delay : m_delays) {
+        delays.append(delay);
+    }
+    QSettings settings(QSettings::IniFormat, QSettings::UserScope, QApplication::organizationName(), QApplication::applicationName());
+    settings.beginGroup("BewavedDolphin");
+    settings.setValue("gateDelays", delays);
+    settings.endGroup();
+}
+
 void BewavedDolphin::zoomChanged()
 {
     m_ui->actionZoom_In->setEnabled(m_gv->gvzoom()->canZoomIn());
@@ -259,6 +282,10 @@ void BewavedDolphin::CreateOneElement(int row, int col, bool isInput, bool chang
 
 void BewavedDolphin::run()
 {
+    if ((m_timed && runTimed()) || runCombinational()) {
+        m_signalTableView->viewport()->update();
+        return;
+    }
     for (int itr = 0; itr < m_model->columnCount(); ++itr) {
         COMMENT("itr:" << itr, 3);
         for (int in = 0; in < m_inputs.size(); ++in) {
@@ -283,6 +310,49 @@ void BewavedDolphin::run()
     m_signalTableView->viewport()->update();
 }
 
+QVector<QVector<uchar>> BewavedDolphin::stimulus() const
+{
+    const int columns = m_model->columnCount();
+    QVector<QVector<uchar>> stimulus(m_inputs.size(), QVector<uchar>(columns));
+    for (int in = 0; in < m_inputs.size(); ++in) {
+        for (int itr = 0; itr < columns; ++itr) {
+            stimulus[in][itr] = m_model->item(in, itr)->text().toInt() != 0;
+        }
+    }
+    return stimulus;
+}
+
+void BewavedDolphin::setResults(const QVector<QVector<uchar>> &results)
+{
+    for (int row = 0; row < results.size(); ++row) {
+        for (int itr = 0; itr < results.at(row).size(); ++itr) {
+            CreateElement(m_inputs.size() + row, itr, results[row][itr], false);
+        }
+    }
+}
+
+bool BewavedDolphin::runCombinational()
+{
+    QVector<QVector<uchar>> results;
+    if (!m_sc->simulateCombinational(m_inputs, ElementMapping::outputPorts(m_outputs), stimulus(), results)) {
+        return false;
+    }
+    COMMENT("Combinational circuit: all columns evaluated in bit-parallel batches.", 3);
+    setResults(results);
+    return true;
+}
+
+bool BewavedDolphin::runTimed()
+{
+    QVector<QVector<uchar>> results;
+    if (!m_sc->simulateTimed(m_inputs, ElementMapping::outputPorts(m_outputs), stimulus(), m_delays, results)) {
+        return false;
+    }
+    COMMENT("Timed simulation: every column is one unit of propagation delay.", 3);
+    setResults(results);
+    return true;
+}
+
 void BewavedDolphin::loadNewTable(QStringList &input_labels, QStringList &output_labels)
 {
     int iterations = 32;
@@ -955,6 +1025,27 @@ void BewavedDolphin::on_actionShowCurve_triggered()
     run();
 }
 
+void BewavedDolphin::on_actionPropagationDelays_triggered(bool checked)
+{
+    m_timed = checked;
+    COMMENT("Running simulation", 0);
+    run();
+}
+
+void BewavedDolphin::on_actionGateDelays_triggered()
+{
+    DelayDialog dialog(m_delays, this);
+    if (dialog.exec() != QDialog::Accepted) {
+        return;
+    }
+    m_delays = dialog.delays();
+    saveDelays();
+    m_timed = true;
+    m_ui->actionPropagationDelays->setChecked(true);
+    COMMENT("Running simulation", 0);
+    run();
+}
+
 void BewavedDolphin::on_actionExport_to_PNG_triggered()
 {
     QString pngFile = QFileDialog::getSaveFileName(this, tr("Export to Image"), m_currentFile.absolutePath(), tr("PNG files (*.png)"));
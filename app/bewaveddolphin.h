@@ -18,6 +18,7 @@ class GraphicsView;
 class MainWindow;
 class GraphicElement;
 class QGraphicsScene;
+class QNEInputPort;
 class QPainter;
 class QTableView;
 class SimulationController;
@@ -102,6 +103,10 @@ private slots:
 
     void on_actionShowCurve_triggered();
 
+    void on_actionPropagationDelays_triggered(bool checked);
+
+    void on_actionGateDelays_triggered();
+
     void on_actionExport_to_PNG_triggered();
 
     void on_actionExport_to_PDF_triggered();
@@ -126,6 +131,9 @@ private:
     QStandardItemModel *m_model;
     PlotType m_type;
     bool m_edited;
+    //! Outputs come from a TimedNetlist, with the gate delays below, instead of zero-delay ticks.
+    bool m_timed;
+    QVector<int> m_delays;
 
     double m_scale;
     const double m_SCALE_FACTOR = 0.8;
@@ -143,6 +151,14 @@ private:
     void loadNewTable(QStringList &input_labels, QStringList &output_labels);
     QVector<char> loadSignals(QStringList &input_labels, QStringList &output_labels);
     void run();
+    QVector<QVector<uchar>> stimulus() const;
+    void setResults(const QVector<QVector<uchar>> &results);
+    //! Fills the output rows in bit-parallel batches. Returns false when the circuit is not purely combinational.
+    bool runCombinational();
+    //! Fills the output rows with propagation delays, one delay unit per column.
+    bool runTimed();
+    //! Writes m_delays to the settings, so that the gateDelays key always lists every gate type.
+    void saveDelays();
     void setLength(int sim_length, bool run_simulation = true);
     void cut(const QItemSelection &ranges, QDataStream &ds);
     void copy(const QItemSelection &ranges, QDataStream &ds);
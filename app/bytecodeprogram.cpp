@@ -0,0 +1,394 @@
+// Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "bytecodeprogram.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "compilednetlist.h"
+
+#if defined(__GNUC__)
+#define BYTECODE_COMPUTED_GOTO
+#endif
+
+BytecodeProgram::BytecodeProgram(const CompiledNetlist &netlist)
+    : m_instructions(0)
+    , m_fused(0)
+{
+    const size_t gates = netlist.m_types.size();
+    int32_t loopBegin = 0;
+    const auto closeLoop = [this, &netlist, &loopBegin](size_t gate) {
+        const int loop = netlist.m_gateLoop[gate];
+        if ((loop != -1) && (netlist.m_loopLast[loop] == static_cast<int>(gate))) {
+            emit(SETTLE_END, {loopBegin, CompiledNetlist::SettleLimit});
+        }
+    };
+    for (size_t gate = 0; gate < gates; ++gate) {
+        const int loop = netlist.m_gateLoop[gate];
+        if ((loop != -1) && (netlist.m_loopFirst[loop] == static_cast<int>(gate))) {
+            const int32_t slotBegin = netlist.m_outputBegin[gate];
+            const int32_t slotEnd = netlist.m_outputEnd[netlist.m_loopLast[loop]];
+            loopBegin = static_cast<int32_t>(m_code.size());
+            emit(SETTLE_BEGIN, {slotBegin, slotEnd});
+            m_settleBuffer.resize(std::max(m_settleBuffer.size(), static_cast<size_t>(slotEnd - slotBegin)));
+        }
+        const int32_t *in = netlist.m_inputSlots.data() + netlist.m_inputBegin[gate];
+        const int inputs = netlist.m_inputBegin[gate + 1] - netlist.m_inputBegin[gate];
+        const int32_t out = netlist.m_outputBegin[gate];
+        const int32_t state = netlist.m_stateBegin[gate];
+        const LogicType type = netlist.m_types[gate];
+        if ((type == LogicType::NOT) && (gate + 1 < gates) && (netlist.m_gateLoop[gate + 1] == loop)) {
+            // Fused only with the very next gate, so nothing in between can see the NOT output late.
+            const LogicType next = netlist.m_types[gate + 1];
+            const int32_t *nextIn = netlist.m_inputSlots.data() + netlist.m_inputBegin[gate + 1];
+            const int nextInputs = netlist.m_inputBegin[gate + 2] - netlist.m_inputBegin[gate + 1];
+            if (((next == LogicType::AND) || (next == LogicType::OR)) && (nextInputs == 2) && ((nextIn[0] == out) || (nextIn[1] == out))) {
+                const int32_t other = (nextIn[0] == out) ? nextIn[1] : nextIn[0];
+                emit((next == LogicType::AND) ? NOT_AND2 : NOT_OR2, {in[0], out, other, netlist.m_outputBegin[gate + 1]});
+                ++m_fused;
+                ++gate;
+                closeLoop(gate);
+                continue;
+            }
+        }
+        switch (type) {
+        case LogicType::AND:
+        case LogicType::OR:
+        case LogicType::XOR:
+        case LogicType::NAND:
+        case LogicType::NOR:
+        case LogicType::XNOR: {
+            static const std::pair<LogicType, std::pair<Opcode, Opcode>> ops[] = {
+                {LogicType::AND, {AND2, ANDN}},
+                {LogicType::OR, {OR2, ORN}},
+                {LogicType::XOR, {XOR2, XORN}},
+                {LogicType::NAND, {NAND2, NANDN}},
+                {LogicType::NOR, {NOR2, NORN}},
+                {LogicType::XNOR, {XNOR2, XNORN}},
+            };
+            for (const auto &op : ops) {
+                if (op.first != type) {
+                    continue;
+                }
+                if (inputs == 2) {
+                    emit(op.second.first, {in[0], in[1], out});
+                } else {
+                    emit(op.second.second, {inputs, out});
+                    m_code.insert(m_code.end(), in, in + inputs);
+                }
+            }
+            break;
+        }
+        case LogicType::NOT:
+            emit(NOT, {in[0], out});
+            break;
+        case LogicType::NODE:
+        case LogicType::OUTPUT:
+            for (int port = 0; port < inputs; ++port) {
+                emit(COPY, {in[port], out + port});
+            }
+            break;
+        case LogicType::MUX:
+            emit(MUX, {in[0], in[1], in[2], out});
+            break;
+        case LogicType::DEMUX:
+            emit(DEMUX, {in[0], in[1], out});
+            break;
+        case LogicType::DLATCH:
+            emit(DLATCH, {in[0], in[1], out});
+            break;
+        case LogicType::DFLIPFLOP:
+            emit(DFF_EDGE, {in[0], in[1], in[2], in[3], out, state});
+            break;
+        case LogicType::TFLIPFLOP:
+            emit(TFF_EDGE, {in[0], in[1], in[2], in[3], out, state});
+            break;
+        case LogicType::JKFLIPFLOP:
+            emit(JK_EDGE, {in[0], in[1], in[2], in[3], in[4], out, state});
+            break;
+        case LogicType::SRFLIPFLOP:
+            emit(SR_EDGE, {in[0], in[1], in[2], in[3], in[4], out, state});
+            break;
+        case LogicType::INPUT:
+            break;
+        }
+        closeLoop(gate);
+    }
+    m_code.push_back(HALT);
+}
+
+void BytecodeProgram::emit(Opcode op, std::initializer_list<int32_t> operands)
+{
+    m_code.push_back(op);
+    m_code.insert(m_code.end(), operands);
+    ++m_instructions;
+}
+
+int BytecodeProgram::instructionCount() const
+{
+    return m_instructions;
+}
+
+int BytecodeProgram::fusedCount() const
+{
+    return m_fused;
+}
+
+#ifdef BYTECODE_COMPUTED_GOTO
+// Labels as values are a GNU extension, enabled above only for compilers that have it.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#define VM_CASE(op) label_##op
+#define VM_NEXT() goto *labels[*pc]
+#else
+#define VM_CASE(op) case op
+#define VM_NEXT() continue
+#endif
+//! Writes a signal or state byte, and records whether it changed.
+#define VM_SET(target, value)            \
+    do {                                 \
+        const uint8_t set_ = (value);    \
+        changed |= (target) ^ set_;      \
+        (target) = set_;                 \
+    } while (false)
+
+bool BytecodeProgram::run(uint8_t *s, uint8_t *st) const
+{
+    // The behavior of every opcode is the one of CompiledNetlist::evaluate() for the matching LogicType.
+    const int32_t *pc = m_code.data();
+    int passes = 0;
+    // Changes are tracked like in CompiledNetlist::evaluate(), see VM_SET().
+    uint8_t changed = 0;
+#ifdef BYTECODE_COMPUTED_GOTO
+    static const void *const labels[] = {
+        &&label_AND2, &&label_OR2, &&label_XOR2, &&label_NAND2, &&label_NOR2, &&label_XNOR2,
+        &&label_ANDN, &&label_ORN, &&label_XORN, &&label_NANDN, &&label_NORN, &&label_XNORN,
+        &&label_NOT, &&label_COPY, &&label_NOT_AND2, &&label_NOT_OR2, &&label_MUX, &&label_DEMUX,
+        &&label_DLATCH, &&label_DFF_EDGE, &&label_TFF_EDGE, &&label_JK_EDGE, &&label_SR_EDGE,
+        &&label_SETTLE_BEGIN, &&label_SETTLE_END, &&label_HALT,
+    };
+    static_assert(sizeof(labels) / sizeof(labels[0]) == HALT + 1, "One label per opcode");
+    VM_NEXT();
+    {
+#else
+    for (;;) {
+        switch (*pc) {
+#endif
+    VM_CASE(AND2):
+        VM_SET(s[pc[3]], s[pc[1]] & s[pc[2]]);
+        pc += 4;
+        VM_NEXT();
+    VM_CASE(OR2):
+        VM_SET(s[pc[3]], s[pc[1]] | s[pc[2]]);
+        pc += 4;
+        VM_NEXT();
+    VM_CASE(XOR2):
+        VM_SET(s[pc[3]], s[pc[1]] ^ s[pc[2]]);
+        pc += 4;
+        VM_NEXT();
+    VM_CASE(NAND2):
+        VM_SET(s[pc[3]], !(s[pc[1]] & s[pc[2]]));
+        pc += 4;
+        VM_NEXT();
+    VM_CASE(NOR2):
+        VM_SET(s[pc[3]], !(s[pc[1]] | s[pc[2]]));
+        pc += 4;
+        VM_NEXT();
+    VM_CASE(XNOR2):
+        VM_SET(s[pc[3]], !(s[pc[1]] ^ s[pc[2]]));
+        pc += 4;
+        VM_NEXT();
+    VM_CASE(ANDN):
+    VM_CASE(NANDN): {
+        uint8_t result = 1;
+        for (int idx = 0; idx < pc[1]; ++idx) {
+            result &= s[pc[3 + idx]];
+        }
+        VM_SET(s[pc[2]], (*pc == ANDN) ? result : !result);
+        pc += 3 + pc[1];
+        VM_NEXT();
+    }
+    VM_CASE(ORN):
+    VM_CASE(NORN): {
+        uint8_t result = 0;
+        for (int idx = 0; idx < pc[1]; ++idx) {
+            result |= s[pc[3 + idx]];
+        }
+        VM_SET(s[pc[2]], (*pc == ORN) ? result : !result);
+        pc += 3 + pc[1];
+        VM_NEXT();
+    }
+    VM_CASE(XORN):
+    VM_CASE(XNORN): {
+        uint8_t result = 0;
+        for (int idx = 0; idx < pc[1]; ++idx) {
+            result ^= s[pc[3 + idx]];
+        }
+        VM_SET(s[pc[2]], (*pc == XORN) ? result : !result);
+        pc += 3 + pc[1];
+        VM_NEXT();
+    }
+    VM_CASE(NOT):
+        VM_SET(s[pc[2]], !s[pc[1]]);
+        pc += 3;
+        VM_NEXT();
+    VM_CASE(COPY):
+        VM_SET(s[pc[2]], s[pc[1]]);
+        pc += 3;
+        VM_NEXT();
+    VM_CASE(NOT_AND2):
+        VM_SET(s[pc[2]], !s[pc[1]]);
+        VM_SET(s[pc[4]], s[pc[2]] & s[pc[3]]);
+        pc += 5;
+        VM_NEXT();
+    VM_CASE(NOT_OR2):
+        VM_SET(s[pc[2]], !s[pc[1]]);
+        VM_SET(s[pc[4]], s[pc[2]] | s[pc[3]]);
+        pc += 5;
+        VM_NEXT();
+    VM_CASE(MUX):
+        VM_SET(s[pc[4]], s[pc[3]] ? s[pc[2]] : s[pc[1]]);
+        pc += 5;
+        VM_NEXT();
+    VM_CASE(DEMUX): {
+        const uint8_t data = s[pc[1]];
+        const uint8_t choice = s[pc[2]];
+        VM_SET(s[pc[3]], choice ? 0 : data);
+        VM_SET(s[pc[3] + 1], choice ? data : 0);
+        pc += 4;
+        VM_NEXT();
+    }
+    VM_CASE(DLATCH):
+        if (s[pc[2]]) {
+            const uint8_t data = s[pc[1]];
+            VM_SET(s[pc[3]], data);
+            VM_SET(s[pc[3] + 1], !data);
+        }
+        pc += 4;
+        VM_NEXT();
+    VM_CASE(DFF_EDGE): {
+        const uint8_t data = s[pc[1]];
+        const uint8_t clk = s[pc[2]];
+        const uint8_t prst = s[pc[3]];
+        const uint8_t clr = s[pc[4]];
+        uint8_t *q = s + pc[5];
+        uint8_t *state = st + pc[6];
+        if (clk && !state[0]) {
+            VM_SET(q[0], state[1]);
+            VM_SET(q[1], !state[1]);
+        }
+        if (!prst || !clr) {
+            VM_SET(q[0], !prst);
+            VM_SET(q[1], !clr);
+        }
+        VM_SET(state[0], clk);
+        VM_SET(state[1], data);
+        pc += 7;
+        VM_NEXT();
+    }
+    VM_CASE(TFF_EDGE): {
+        const uint8_t toggle = s[pc[1]];
+        const uint8_t clk = s[pc[2]];
+        const uint8_t prst = s[pc[3]];
+        const uint8_t clr = s[pc[4]];
+        uint8_t *q = s + pc[5];
+        uint8_t *state = st + pc[6];
+        if (clk && !state[0] && state[1]) {
+            VM_SET(q[0], !q[0]);
+            VM_SET(q[1], !q[0]);
+        }
+        if (!prst || !clr) {
+            VM_SET(q[0], !prst);
+            VM_SET(q[1], !clr);
+        }
+        VM_SET(state[0], clk);
+        VM_SET(state[1], toggle);
+        pc += 7;
+        VM_NEXT();
+    }
+    VM_CASE(JK_EDGE): {
+        const uint8_t j = s[pc[1]];
+        const uint8_t clk = s[pc[2]];
+        const uint8_t k = s[pc[3]];
+        const uint8_t prst = s[pc[4]];
+        const uint8_t clr = s[pc[5]];
+        uint8_t *q = s + pc[6];
+        uint8_t *state = st + pc[7];
+        if (clk && !state[0]) {
+            if (state[1] && state[2]) {
+                const uint8_t q0 = q[0];
+                VM_SET(q[0], q[1]);
+                VM_SET(q[1], q0);
+            } else if (state[1]) {
+                VM_SET(q[0], 1);
+                VM_SET(q[1], 0);
+            } else if (state[2]) {
+                VM_SET(q[0], 0);
+                VM_SET(q[1], 1);
+            }
+        }
+        if (!prst || !clr) {
+            VM_SET(q[0], !prst);
+            VM_SET(q[1], !clr);
+        }
+        VM_SET(state[0], clk);
+        VM_SET(state[1], j);
+        VM_SET(state[2], k);
+        pc += 8;
+        VM_NEXT();
+    }
+    VM_CASE(SR_EDGE): {
+        const uint8_t set = s[pc[1]];
+        const uint8_t clk = s[pc[2]];
+        const uint8_t reset = s[pc[3]];
+        const uint8_t prst = s[pc[4]];
+        const uint8_t clr = s[pc[5]];
+        uint8_t *q = s + pc[6];
+        uint8_t *state = st + pc[7];
+        if (clk && !state[0]) {
+            if (set && reset) {
+                VM_SET(q[0], 1);
+                VM_SET(q[1], 1);
+            } else if (set != reset) {
+                VM_SET(q[0], set);
+                VM_SET(q[1], reset);
+            }
+        }
+        if (!prst || !clr) {
+            VM_SET(q[0], !prst);
+            VM_SET(q[1], !clr);
+        }
+        VM_SET(state[0], clk);
+        pc += 8;
+        VM_NEXT();
+    }
+    VM_CASE(SETTLE_BEGIN):
+        std::copy(s + pc[1], s + pc[2], m_settleBuffer.begin());
+        pc += 3;
+        VM_NEXT();
+    VM_CASE(SETTLE_END): {
+        // Same bound as CompiledNetlist::settle(): at most passLimit passes, fewer once nothing changed.
+        const int32_t *begin = m_code.data() + pc[1];
+        if ((++passes < pc[2]) && !std::equal(s + begin[1], s + begin[2], m_settleBuffer.cbegin())) {
+            pc = begin;
+        } else {
+            passes = 0;
+            pc += 3;
+        }
+        VM_NEXT();
+    }
+    VM_CASE(HALT):
+        return changed != 0;
+#ifndef BYTECODE_COMPUTED_GOTO
+        }
+#endif
+    }
+}
+
+#undef VM_CASE
+#undef VM_NEXT
+#undef VM_SET
+#ifdef BYTECODE_COMPUTED_GOTO
+#pragma GCC diagnostic pop
+#endif
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef BYTECODEPROGRAM_H
+#define BYTECODEPROGRAM_H
+
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+class CompiledNetlist;
+
+/**
+ * @brief The BytecodeProgram class is a register based program equivalent to one sweep of a CompiledNetlist.
+ *
+ * Registers are the signal slots of the netlist. Every gate becomes one instruction with fixed operands
+ * (two input gates get their own opcodes), and a NOT gate directly followed by the two input AND/OR it
+ * feeds is fused into a single instruction that still writes both outputs. The gates of a combinational loop
+ * sit between SETTLE_BEGIN and SETTLE_END, which jumps back until the loop outputs stop changing. The
+ * interpreter loop uses computed goto when the compiler supports it.
+ */
+class BytecodeProgram
+{
+public:
+    enum Opcode : int32_t {
+        AND2,     // a b out
+        OR2,      // a b out
+        XOR2,     // a b out
+        NAND2,    // a b out
+        NOR2,     // a b out
+        XNOR2,    // a b out
+        ANDN,     // count out in...
+        ORN,      // count out in...
+        XORN,     // count out in...
+        NANDN,    // count out in...
+        NORN,     // count out in...
+        XNORN,    // count out in...
+        NOT,      // a out
+        COPY,     // a out
+        NOT_AND2, // a notOut b out: notOut = !a, out = notOut & b
+        NOT_OR2,  // a notOut b out: notOut = !a, out = notOut | b
+        MUX,      // in0 in1 select out
+        DEMUX,    // data select out (two outputs)
+        DLATCH,   // data enable q
+        DFF_EDGE, // d clk prst clr q state
+        TFF_EDGE, // t clk prst clr q state
+        JK_EDGE,  // j clk k prst clr q state
+        SR_EDGE,  // s clk r prst clr q state
+        SETTLE_BEGIN, // slotBegin slotEnd
+        SETTLE_END,   // beginOffset passLimit
+        HALT,
+    };
+
+    explicit BytecodeProgram(const CompiledNetlist &netlist);
+
+    //! Runs the program once over the signal and state arrays of the netlist it was built from.
+    //! Returns true when a signal or state byte changed.
+    bool run(uint8_t *signals, uint8_t *state) const;
+
+    int instructionCount() const;
+    int fusedCount() const;
+
+private:
+    void emit(Opcode op, std::initializer_list<int32_t> operands);
+
+    std::vector<int32_t> m_code;
+    //! Loop outputs before a pass; a program never runs on two threads at once.
+    mutable std::vector<uint8_t> m_settleBuffer;
+    int m_instructions;
+    int m_fused;
+};
+
+#endif // BYTECODEPROGRAM_H
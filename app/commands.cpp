@@ -148,6 +148,7 @@ void addItems(Editor *editor, const QList<QGraphicsItem *>& items)
             item->setSelected(true);
         }
     }
+    editor->getSimulationController()->patchItems({}, items);
 }
 
 QList<QGraphicsItem *> loadItems(QByteArray &itemData, const QVector<int> &ids, Editor *editor, QVector<int> &otherIds)
@@ -184,6 +185,7 @@ QList<QGraphicsItem *> loadItems(QByteArray &itemData, const QVector<int> &ids,
 
 void deleteItems(const QList<QGraphicsItem *> &items, Editor *editor)
 {
+    editor->getSimulationController()->patchItems(items, {});
     QVector<QGraphicsItem *> itemsVec = items.toVector();
     /* Delete items on reverse order */
     for (int i = itemsVec.size() - 1; i >= 0; --i) {
@@ -238,12 +240,7 @@ void AddItemsCommand::undo()
 {
     COMMENT("UNDO " + text().toStdString(), 0);
     QList<QGraphicsItem *> items = findItems(m_ids);
-
-    SimulationController *sc = m_editor->getSimulationController();
-    // We need to restart the simulation controller when deleting through the Undo command to
-    // guarantee that no crashes occur when deleting input elements (clocks, input buttons, etc.)
-    sc->setRestart();
-
+    // deleteItems() drops the inputs (clocks, input buttons, etc.) from the simulation before deleting them.
     saveItems(m_itemData, items, m_otherIds);
     deleteItems(items, m_editor);
     emit m_editor->circuitHasChanged();
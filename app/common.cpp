@@ -3,6 +3,8 @@
 
 #include "common.h"
 
+uint64_t RepaintCounter::repaints = 0;
+
 #ifdef DEBUG
 int Comment::verbosity = DEBUG;
 #else
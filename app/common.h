@@ -6,6 +6,7 @@
 #ifndef COMMON_H
 #define COMMON_H
 
+#include <cstdint>
 #include <iostream>
 
 class Comment
@@ -19,6 +20,18 @@ public:
     }
 };
 
+//! Repaints requested by a port, connection or element changing its look, since the program started.
+class RepaintCounter
+{
+public:
+    static uint64_t repaints;
+
+    static void countRepaint()
+    {
+        ++repaints;
+    }
+};
+
 #ifdef DEBUG
 #define COMMENT(exp, num)                                                                                                                                      \
     if (Comment::verbosity > num) {                                                                                                                            \
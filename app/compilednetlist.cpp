@@ -0,0 +1,992 @@
+// Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "compilednetlist.h"
+
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+#include "bytecodeprogram.h"
+#include "workerpool.h"
+
+CompiledNetlist::CompiledNetlist(const QVector<LogicElement *> &sortedElms, const QVector<QVector<LogicElement *>> &loops, const QSet<const LogicElement *> *constants,
+                                 const QSet<const LogicElement *> *observed, bool hashing)
+    : m_feedback(false)
+    , m_sequential(false)
+    , m_levelNext(nullptr)
+    , m_levelChanged(false)
+    , m_pool(nullptr)
+    , m_native(nullptr)
+    , m_bytecode(nullptr)
+    , m_eventDriven(false)
+    , m_quiescent(false)
+    , m_evaluations(0)
+    , m_skippedEvaluations(0)
+    , m_sourceGates(0)
+    , m_bufferAliases(0)
+    , m_mergedGates(0)
+{
+    for (LogicElement *elm : sortedElms) {
+        allocateSlots(elm);
+    }
+    /* Folding: the known value of every slot (-1 when it may change), the elements already built, the ones whose
+     * outputs are read before they are evaluated and the members of loops. Neither of the last two is folded. */
+    std::vector<int8_t> constant;
+    QSet<const LogicElement *> built;
+    QSet<const LogicElement *> readEarly;
+    QSet<const LogicElement *> looped;
+    if (constants) {
+        constant.assign(m_signals.size(), -1);
+        for (const LogicElement *elm : *constants) {
+            const int base = m_outputBase.value(elm, -1);
+            for (int out = 0; (base != -1) && (out < static_cast<int>(elm->outputSize())); ++out) {
+                constant[base + out] = static_cast<int8_t>(m_signals[base + out]);
+            }
+        }
+    }
+    for (const QVector<LogicElement *> &loop : loops) {
+        for (const LogicElement *elm : loop) {
+            looped.insert(elm);
+        }
+    }
+    /* Pruning: the fan-in cones of the observed elements, and of everything holding state between ticks, which
+     * would come back stale otherwise. The other gates only feed outputs nobody reads. */
+    QSet<const LogicElement *> live;
+    if (observed) {
+        QVector<const LogicElement *> pending;
+        for (const LogicElement *elm : sortedElms) {
+            if (observed->contains(elm) || looped.contains(elm) || (stateSize(elm->type()) > 0) || (elm->type() == LogicType::DLATCH)) {
+                pending.append(elm);
+            }
+        }
+        while (!pending.isEmpty()) {
+            const LogicElement *elm = pending.takeLast();
+            if (live.contains(elm)) {
+                continue;
+            }
+            live.insert(elm);
+            for (size_t in = 0; in < elm->inputSize(); ++in) {
+                if (elm->predecessor(in)) {
+                    pending.append(elm->predecessor(in));
+                }
+            }
+        }
+    }
+    /* Structural hashing: the output slot of the first gate of every type and inputs (sorted when their order
+     * does not matter), and the input of every NOT, for inverters in a row. */
+    std::map<std::vector<int>, int> shared;
+    std::unordered_map<int, int> inverted;
+    std::vector<int> key;
+    std::vector<int> inputs;
+    m_inputBegin.push_back(0);
+    m_outputBegin.reserve(sortedElms.size());
+    m_stateBegin.push_back(0);
+    for (LogicElement *elm : sortedElms) {
+        // Inputs never change by themselves and invalid elements are never updated by the reference engine.
+        if (!elm->isValid() || (elm->type() == LogicType::INPUT)) {
+            continue;
+        }
+        ++m_sourceGates;
+        if (observed && !live.contains(elm)) {
+            // Nothing observed reads it: the slots keep their value until a rebuild observes the element.
+            m_pruned.insert(elm);
+            continue;
+        }
+        inputs.clear();
+        bool early = false;
+        for (size_t in = 0; in < elm->inputSize(); ++in) {
+            const LogicElement *pred = elm->predecessor(in);
+            Q_ASSERT(pred);
+            int base = m_outputBase.value(pred, -1);
+            if ((base != -1) && pred->isValid() && (pred->type() != LogicType::INPUT) && !built.contains(pred)) {
+                // Read before its producer is evaluated: the value comes from the previous tick.
+                m_feedback = true;
+                early = true;
+                readEarly.insert(pred);
+            }
+            if (base == -1) {
+                // Predecessor outside the sorted list: a constant like the global VCC/GND.
+                base = allocateSlots(pred);
+                if (constants) {
+                    constant.resize(m_signals.size(), -1);
+                    std::copy(m_signals.cbegin() + base, m_signals.cend(), constant.begin() + base);
+                }
+            }
+            inputs.push_back(base + elm->predecessorPort(in));
+        }
+        built.insert(elm);
+        LogicType type = elm->type();
+        const bool optimize = constants && !readEarly.contains(elm) && !looped.contains(elm);
+        const int value = optimize ? fold(type, inputs, constant) : -1;
+        if (value != -1) {
+            // Fully determined: the output slot takes its value for good and the gate is never evaluated.
+            const int out = m_outputBase.value(elm);
+            m_signals[out] = static_cast<uint8_t>(value);
+            constant[out] = static_cast<int8_t>(value);
+            m_folded.emplace_back(out, static_cast<uint8_t>(value));
+            continue;
+        }
+        if (optimize && !early && (type == LogicType::NODE) && (inputs.size() == 1)) {
+            /* A buffer (a Node, an IC port or a folded MUX) reads its source after the source was evaluated,
+             * and nothing read it before, so its readers may as well read the source: the element becomes an
+             * alias of that slot. Readers built later take it through m_outputBase, chains included. */
+            m_outputBase.insert(elm, inputs.front());
+            m_aliased.insert(elm);
+            ++m_bufferAliases;
+            continue;
+        }
+        if (hashing && !early && !readEarly.contains(elm) && !looped.contains(elm) && isMergeable(type)) {
+            // Same as a gate built before, or the NOT of a NOT: an alias too, of the slot holding the same value.
+            int same = -1;
+            if ((type == LogicType::NOT) && (inverted.count(inputs.front()) > 0)) {
+                same = inverted.at(inputs.front());
+            } else {
+                key.assign(1, static_cast<int>(type));
+                key.insert(key.end(), inputs.cbegin(), inputs.cend());
+                if ((type != LogicType::MUX) && (type != LogicType::DEMUX)) {
+                    std::sort(key.begin() + 1, key.end());
+                }
+                const auto found = shared.find(key);
+                if (found != shared.cend()) {
+                    same = found->second;
+                } else {
+                    shared.emplace(key, m_outputBase.value(elm));
+                    if (type == LogicType::NOT) {
+                        inverted.emplace(m_outputBase.value(elm), inputs.front());
+                    }
+                }
+            }
+            if (same != -1) {
+                m_outputBase.insert(elm, same);
+                m_aliased.insert(elm);
+                ++m_mergedGates;
+                continue;
+            }
+        }
+        m_inputSlots.insert(m_inputSlots.end(), inputs.cbegin(), inputs.cend());
+        m_gate.insert(elm, static_cast<int>(m_types.size()));
+        m_types.push_back(type);
+        m_gateNode.push_back(m_node.value(elm));
+        m_inputBegin.push_back(static_cast<int>(m_inputSlots.size()));
+        m_outputBegin.push_back(m_outputBase.value(elm));
+        m_outputEnd.push_back(m_outputBase.value(elm) + static_cast<int>(elm->outputSize()));
+        m_stateBegin.push_back(m_stateBegin.back() + stateSize(elm->type()));
+        // Flip-flops keep state between ticks and latches hold their outputs.
+        m_sequential |= (stateSize(elm->type()) > 0) || (elm->type() == LogicType::DLATCH);
+    }
+    m_state.resize(m_stateBegin.back(), 0);
+    for (size_t gate = 0; gate < m_types.size(); ++gate) {
+        // Same initial state as the constructors of the reference flip-flops.
+        uint8_t *state = m_state.data() + m_stateBegin[gate];
+        switch (m_types[gate]) {
+        case LogicType::JKFLIPFLOP:
+            state[1] = true;
+            state[2] = true;
+            break;
+        case LogicType::DFLIPFLOP:
+        case LogicType::TFLIPFLOP:
+            state[1] = true;
+            break;
+        default:
+            break;
+        }
+    }
+    m_gateLoop.assign(m_types.size(), -1);
+    std::vector<std::pair<int, int>> ranges;
+    for (const QVector<LogicElement *> &loop : loops) {
+        // Invalid members are not compiled; the others are consecutive gates.
+        int first = gateCount();
+        int last = -1;
+        int members = 0;
+        for (const LogicElement *elm : loop) {
+            const int gate = m_gate.value(elm, -1);
+            if (gate != -1) {
+                first = std::min(first, gate);
+                last = std::max(last, gate);
+                ++members;
+            }
+        }
+        Q_ASSERT((last == -1) || (last - first + 1 == members));
+        if (last != -1) {
+            ranges.emplace_back(first, last);
+        }
+    }
+    std::sort(ranges.begin(), ranges.end());
+    size_t loopSlots = 0;
+    for (const auto &range : ranges) {
+        std::fill(m_gateLoop.begin() + range.first, m_gateLoop.begin() + range.second + 1, static_cast<int>(m_loopFirst.size()));
+        m_loopFirst.push_back(range.first);
+        m_loopLast.push_back(range.second);
+        loopSlots = std::max(loopSlots, static_cast<size_t>(m_outputEnd[range.second] - m_outputBegin[range.first]));
+    }
+    m_settleStart.resize(loopSlots);
+    buildFanout();
+    if (!m_feedback) {
+        buildLevels();
+    }
+    setBytecode(true);
+}
+
+CompiledNetlist::~CompiledNetlist()
+{
+    delete m_bytecode;
+    delete[] m_levelNext;
+}
+
+void CompiledNetlist::buildLevels()
+{
+    // A gate goes one level after the latest gate it reads from; inputs and constants are level zero.
+    std::vector<int> slotLevel(m_signals.size(), -1);
+    std::vector<int> gateLevel(m_types.size());
+    int levels = 0;
+    for (size_t gate = 0; gate < m_types.size(); ++gate) {
+        int level = 0;
+        for (int in = m_inputBegin[gate]; in < m_inputBegin[gate + 1]; ++in) {
+            level = std::max(level, slotLevel[m_inputSlots[in]] + 1);
+        }
+        gateLevel[gate] = level;
+        std::fill(slotLevel.begin() + m_outputBegin[gate], slotLevel.begin() + m_outputEnd[gate], level);
+        levels = std::max(levels, level + 1);
+    }
+    m_levelBegin.assign(levels + 1, 0);
+    for (int level : gateLevel) {
+        ++m_levelBegin[level + 1];
+    }
+    for (int level = 0; level < levels; ++level) {
+        m_levelBegin[level + 1] += m_levelBegin[level];
+    }
+    m_levelGates.resize(m_types.size());
+    std::vector<int> fill(m_levelBegin.cbegin(), m_levelBegin.cend() - 1);
+    for (size_t gate = 0; gate < m_types.size(); ++gate) {
+        m_levelGates[fill[gateLevel[gate]]++] = static_cast<int>(gate);
+    }
+    m_levelNext = new std::atomic<int>[levels];
+}
+
+void CompiledNetlist::buildFanout()
+{
+    // Readers of an alias read the slot of its source, so the fan-out follows the slots, not the successors.
+    QVector<QVector<int>> fanout(m_node.size());
+    for (size_t gate = 0; gate < m_types.size(); ++gate) {
+        for (int in = m_inputBegin[gate]; in < m_inputBegin[gate + 1]; ++in) {
+            fanout[m_slotNode[m_inputSlots[in]]].append(static_cast<int>(gate));
+        }
+    }
+    m_fanoutBegin.push_back(0);
+    for (QVector<int> &gates : fanout) {
+        // A gate reading several outputs of a node is listed once.
+        std::sort(gates.begin(), gates.end());
+        gates.erase(std::unique(gates.begin(), gates.end()), gates.end());
+        m_fanout.insert(m_fanout.end(), gates.cbegin(), gates.cend());
+        m_fanoutBegin.push_back(static_cast<int>(m_fanout.size()));
+    }
+    m_queued.resize(m_types.size(), 0);
+    m_deferred.resize(m_types.size(), 0);
+}
+
+int CompiledNetlist::allocateSlots(const LogicElement *elm)
+{
+    const int base = static_cast<int>(m_signals.size());
+    const int node = m_node.size();
+    m_outputBase.insert(elm, base);
+    m_node.insert(elm, node);
+    for (size_t out = 0; out < elm->outputSize(); ++out) {
+        m_signals.push_back(elm->getOutputValue(out));
+        m_slotNode.push_back(node);
+    }
+    return base;
+}
+
+int CompiledNetlist::fold(LogicType &type, std::vector<int> &inputs, const std::vector<int8_t> &constant)
+{
+    switch (type) {
+    case LogicType::AND:
+    case LogicType::NAND:
+    case LogicType::OR:
+    case LogicType::NOR: {
+        // A controlling input decides the output; the other constant inputs leave it to the remaining ones.
+        const int controlling = ((type == LogicType::AND) || (type == LogicType::NAND)) ? 0 : 1;
+        const int inverted = ((type == LogicType::NAND) || (type == LogicType::NOR)) ? 1 : 0;
+        size_t kept = 0;
+        for (int slot : inputs) {
+            if (constant[slot] == controlling) {
+                return controlling ^ inverted;
+            }
+            if (constant[slot] == -1) {
+                inputs[kept++] = slot;
+            }
+        }
+        inputs.resize(kept);
+        return inputs.empty() ? (!controlling ^ inverted) : -1;
+    }
+    case LogicType::XOR:
+    case LogicType::XNOR: {
+        int parity = (type == LogicType::XNOR) ? 1 : 0;
+        size_t kept = 0;
+        for (int slot : inputs) {
+            if (constant[slot] == -1) {
+                inputs[kept++] = slot;
+            } else {
+                parity ^= constant[slot];
+            }
+        }
+        inputs.resize(kept);
+        if (inputs.empty()) {
+            return parity;
+        }
+        type = parity ? LogicType::XNOR : LogicType::XOR;
+        return -1;
+    }
+    case LogicType::NOT:
+        return (constant[inputs[0]] == -1) ? -1 : !constant[inputs[0]];
+    case LogicType::NODE:
+        return constant[inputs[0]];
+    case LogicType::MUX: {
+        const int select = constant[inputs[2]];
+        if (select != -1) {
+            // Only the selected input is left, as a wire.
+            const int data = inputs[select];
+            if (constant[data] != -1) {
+                return constant[data];
+            }
+            type = LogicType::NODE;
+            inputs.assign(1, data);
+            return -1;
+        }
+        const int data0 = constant[inputs[0]];
+        const int data1 = constant[inputs[1]];
+        if ((data0 == -1) || (data1 == -1)) {
+            return -1;
+        }
+        if (data0 == data1) {
+            return data0;
+        }
+        // Constant, different data inputs: the output follows the select input.
+        type = data0 ? LogicType::NOT : LogicType::NODE;
+        inputs.assign(1, inputs[2]);
+        return -1;
+    }
+    default:
+        return -1;
+    }
+}
+
+bool CompiledNetlist::isMergeable(LogicType type)
+{
+    switch (type) {
+    case LogicType::AND:
+    case LogicType::OR:
+    case LogicType::NAND:
+    case LogicType::NOR:
+    case LogicType::XOR:
+    case LogicType::XNOR:
+    case LogicType::NOT:
+    case LogicType::MUX:
+    case LogicType::DEMUX:
+        return true;
+    default:
+        return false;
+    }
+}
+
+int CompiledNetlist::stateSize(LogicType type)
+{
+    switch (type) {
+    case LogicType::JKFLIPFLOP:
+        return 3; // lastClk, lastJ, lastK
+    case LogicType::DFLIPFLOP:
+    case LogicType::TFLIPFLOP:
+        return 2; // lastClk, lastValue
+    case LogicType::SRFLIPFLOP:
+        return 1; // lastClk
+    default:
+        return 0;
+    }
+}
+
+void CompiledNetlist::update()
+{
+    bool changed;
+    if (m_eventDriven) {
+        updateEvents();
+        // Only what the queue holds can change, and it is empty once nothing did.
+        changed = !m_queue.empty();
+    } else if (m_native) {
+        changed = m_native(m_signals.data(), m_state.data()) != 0;
+        m_evaluations += m_types.size();
+    } else if (m_pool) {
+        changed = updateLevels();
+    } else if (m_bytecode) {
+        changed = m_bytecode->run(m_signals.data(), m_state.data());
+        m_evaluations += m_types.size();
+    } else {
+        changed = updateSweep();
+    }
+    // Each tick is a function of the signals and state alone, so a tick that changes neither is a fixed point.
+    m_quiescent = !changed;
+}
+
+void CompiledNetlist::updateIfActive()
+{
+    if (m_quiescent && !m_eventDriven) {
+        m_skippedEvaluations += m_types.size();
+        return;
+    }
+    update();
+}
+
+bool CompiledNetlist::isQuiescent() const
+{
+    return m_quiescent;
+}
+
+bool CompiledNetlist::updateSweep()
+{
+    bool changed = false;
+    size_t gate = 0;
+    for (size_t loop = 0; loop < m_loopFirst.size(); ++loop) {
+        changed |= sweep(gate, m_loopFirst[loop]);
+        settle(loop, changed);
+        gate = m_loopLast[loop] + 1;
+    }
+    changed |= sweep(gate, m_types.size());
+    m_evaluations += m_types.size();
+    return changed;
+}
+
+bool CompiledNetlist::sweep(size_t first, size_t last)
+{
+    const int *inputs = m_inputSlots.data();
+    uint8_t *signals = m_signals.data();
+    uint8_t *state = m_state.data();
+    bool changed = false;
+    for (size_t gate = first; gate < last; ++gate) {
+        changed |= evaluate(m_types[gate],
+                            signals,
+                            inputs + m_inputBegin[gate],
+                            inputs + m_inputBegin[gate + 1],
+                            signals + m_outputBegin[gate],
+                            state + m_stateBegin[gate]);
+    }
+    return changed;
+}
+
+bool CompiledNetlist::settle(size_t loop, bool &changed)
+{
+    for (int pass = 0; pass < SettleLimit; ++pass) {
+        if (!sweep(m_loopFirst[loop], m_loopLast[loop] + 1)) {
+            return true;
+        }
+        changed = true;
+    }
+    return false;
+}
+
+bool CompiledNetlist::updateLevels()
+{
+    const int levels = levelCount();
+    for (int level = 0; level < levels; ++level) {
+        m_levelNext[level].store(0, std::memory_order_relaxed);
+    }
+    m_levelChanged.store(false, std::memory_order_relaxed);
+    m_pool->run([this, levels](int) {
+        const int *inputs = m_inputSlots.data();
+        uint8_t *signals = m_signals.data();
+        uint8_t *state = m_state.data();
+        bool changed = false;
+        for (int level = 0; level < levels; ++level) {
+            const int end = m_levelBegin[level + 1];
+            int begin;
+            while ((begin = m_levelBegin[level] + ParallelChunk * m_levelNext[level].fetch_add(1, std::memory_order_relaxed)) < end) {
+                for (int idx = begin; idx < std::min(begin + ParallelChunk, end); ++idx) {
+                    const int gate = m_levelGates[idx];
+                    changed |= evaluate(m_types[gate],
+                                        signals,
+                                        inputs + m_inputBegin[gate],
+                                        inputs + m_inputBegin[gate + 1],
+                                        signals + m_outputBegin[gate],
+                                        state + m_stateBegin[gate]);
+                }
+            }
+            if (level + 1 < levels) {
+                m_pool->barrier();
+            }
+        }
+        // run() only returns once every thread finished, under the mutex of the pool, so relaxed is enough.
+        if (changed) {
+            m_levelChanged.store(true, std::memory_order_relaxed);
+        }
+    });
+    m_evaluations += m_types.size();
+    return m_levelChanged.load(std::memory_order_relaxed);
+}
+
+void CompiledNetlist::updateEvents()
+{
+    quint64 evaluated = 0;
+    while (!m_queue.empty()) {
+        const int gate = m_queue.top();
+        m_queue.pop();
+        m_queued[gate] = false;
+        if (m_gateLoop[gate] != -1) {
+            evaluated += settleEvents(m_gateLoop[gate]);
+            continue;
+        }
+        evaluateGate(gate);
+        ++evaluated;
+    }
+    // Gates fed back from later gates see the new values on the next tick, like in the full sweep.
+    for (int gate : m_nextTick) {
+        m_deferred[gate] = false;
+        if (!m_queued[gate]) {
+            m_queued[gate] = true;
+            m_queue.push(gate);
+        }
+    }
+    m_nextTick.clear();
+    m_evaluations += evaluated;
+    m_skippedEvaluations += m_types.size() - evaluated;
+}
+
+int CompiledNetlist::settleEvents(int loop)
+{
+    // Settling covers every member, so the ones still queued are dropped.
+    const int first = m_loopFirst[loop];
+    const int last = m_loopLast[loop];
+    while (!m_queue.empty() && (m_queue.top() <= last)) {
+        m_queued[m_queue.top()] = false;
+        m_queue.pop();
+    }
+    const uint8_t *signals = m_signals.data();
+    std::copy(signals + m_outputBegin[first], signals + m_outputEnd[last], m_settleStart.begin());
+    bool changed = false;
+    const bool settled = settle(loop, changed);
+    for (int gate = first; changed && (gate <= last); ++gate) {
+        const int offset = m_outputBegin[gate] - m_outputBegin[first];
+        if (std::equal(signals + m_outputBegin[gate], signals + m_outputEnd[gate], m_settleStart.cbegin() + offset)) {
+            continue;
+        }
+        const int node = m_gateNode[gate];
+        for (int idx = m_fanoutBegin[node]; idx < m_fanoutBegin[node + 1]; ++idx) {
+            const int target = m_fanout[idx];
+            if (target > last) {
+                enqueue(target);
+            } else if (target < first) {
+                defer(target);
+            }
+        }
+    }
+    if (!settled) {
+        // Like the full sweep, the next tick goes on from the last pass.
+        defer(first);
+    }
+    return last - first + 1;
+}
+
+void CompiledNetlist::evaluateGate(size_t gate)
+{
+    uint8_t *out = m_signals.data() + m_outputBegin[gate];
+    const int outputs = m_outputEnd[gate] - m_outputBegin[gate];
+    uint8_t previous[64];
+    Q_ASSERT(outputs <= 64);
+    std::copy(out, out + outputs, previous);
+    const int *inputs = m_inputSlots.data();
+    evaluate(m_types[gate], m_signals.data(), inputs + m_inputBegin[gate], inputs + m_inputBegin[gate + 1], out, m_state.data() + m_stateBegin[gate]);
+    if (!std::equal(out, out + outputs, previous)) {
+        schedule(m_gateNode[gate], static_cast<int>(gate));
+    }
+}
+
+void CompiledNetlist::schedule(int node, int fromGate)
+{
+    for (int idx = m_fanoutBegin[node]; idx < m_fanoutBegin[node + 1]; ++idx) {
+        const int gate = m_fanout[idx];
+        if (gate > fromGate) {
+            enqueue(gate);
+        } else {
+            defer(gate);
+        }
+    }
+}
+
+void CompiledNetlist::enqueue(int gate)
+{
+    if (!m_queued[gate]) {
+        m_queued[gate] = true;
+        m_queue.push(gate);
+    }
+}
+
+void CompiledNetlist::defer(int gate)
+{
+    if (!m_deferred[gate]) {
+        m_deferred[gate] = true;
+        m_nextTick.push_back(gate);
+    }
+}
+
+void CompiledNetlist::scheduleAll()
+{
+    for (size_t gate = 0; gate < m_types.size(); ++gate) {
+        enqueue(static_cast<int>(gate));
+    }
+}
+
+bool CompiledNetlist::isEventDriven() const
+{
+    return m_eventDriven;
+}
+
+void CompiledNetlist::setEventDriven(bool eventDriven)
+{
+    if (eventDriven && !m_eventDriven) {
+        // Nothing is known about what changed while sweeping, so everything is evaluated once.
+        scheduleAll();
+    }
+    m_eventDriven = eventDriven;
+    m_quiescent = false;
+}
+
+void CompiledNetlist::setWorkerPool(WorkerPool *pool)
+{
+    m_pool = (pool && (pool->participantCount() > 1) && isParallelizable()) ? pool : nullptr;
+}
+
+bool CompiledNetlist::isParallelizable() const
+{
+    // With feedback the sweep order matters beyond levels: a gate must see the previous value of later gates.
+    return !m_feedback && (gateCount() >= ParallelThreshold);
+}
+
+bool CompiledNetlist::isMultiThreaded() const
+{
+    return m_pool != nullptr;
+}
+
+int CompiledNetlist::levelCount() const
+{
+    return m_levelBegin.empty() ? 0 : static_cast<int>(m_levelBegin.size()) - 1;
+}
+
+void CompiledNetlist::setNativeUpdate(NativeUpdate update)
+{
+    m_native = update;
+}
+
+bool CompiledNetlist::isNative() const
+{
+    return m_native != nullptr;
+}
+
+void CompiledNetlist::setBytecode(bool bytecode)
+{
+    if (bytecode && !m_bytecode) {
+        m_bytecode = new BytecodeProgram(*this);
+    } else if (!bytecode) {
+        delete m_bytecode;
+        m_bytecode = nullptr;
+    }
+}
+
+const BytecodeProgram *CompiledNetlist::bytecode() const
+{
+    return m_bytecode;
+}
+
+int CompiledNetlist::loopCount() const
+{
+    return static_cast<int>(m_loopFirst.size());
+}
+
+quint64 CompiledNetlist::evaluationCount() const
+{
+    return m_evaluations;
+}
+
+quint64 CompiledNetlist::skippedEvaluationCount() const
+{
+    return m_skippedEvaluations;
+}
+
+bool CompiledNetlist::evaluate(LogicType type, const uint8_t *signals, const int *first, const int *last, uint8_t *out, uint8_t *state)
+{
+    // Signals and state are 0 or 1, so the bits that differ between the old and new bytes tell what changed.
+    uint8_t changed = 0;
+    auto assign = [&changed](uint8_t &target, uint8_t value) {
+        changed |= target ^ value;
+        target = value;
+    };
+    switch (type) {
+    case LogicType::AND:
+    case LogicType::NAND: {
+        uint8_t result = 1;
+        for (const int *in = first; in != last; ++in) {
+            result &= signals[*in];
+        }
+        assign(out[0], (type == LogicType::AND) ? result : !result);
+        break;
+    }
+    case LogicType::OR:
+    case LogicType::NOR: {
+        uint8_t result = 0;
+        for (const int *in = first; in != last; ++in) {
+            result |= signals[*in];
+        }
+        assign(out[0], (type == LogicType::OR) ? result : !result);
+        break;
+    }
+    case LogicType::XOR:
+    case LogicType::XNOR: {
+        uint8_t result = 0;
+        for (const int *in = first; in != last; ++in) {
+            result ^= signals[*in];
+        }
+        assign(out[0], (type == LogicType::XOR) ? result : !result);
+        break;
+    }
+    case LogicType::NOT:
+        assign(out[0], !signals[first[0]]);
+        break;
+    case LogicType::NODE:
+    case LogicType::OUTPUT:
+        for (const int *in = first; in != last; ++in) {
+            assign(*out++, signals[*in]);
+        }
+        break;
+    case LogicType::MUX:
+        assign(out[0], signals[first[2]] ? signals[first[1]] : signals[first[0]]);
+        break;
+    case LogicType::DEMUX: {
+        const uint8_t data = signals[first[0]];
+        const uint8_t choice = signals[first[1]];
+        assign(out[0], choice ? 0 : data);
+        assign(out[1], choice ? data : 0);
+        break;
+    }
+    case LogicType::DLATCH:
+        if (signals[first[1]]) {
+            const uint8_t data = signals[first[0]];
+            assign(out[0], data);
+            assign(out[1], !data);
+        }
+        break;
+    case LogicType::DFLIPFLOP: {
+        // Inputs are read before Q changes, since a flip-flop may be fed by its own outputs.
+        const uint8_t data = signals[first[0]];
+        const uint8_t clk = signals[first[1]];
+        const uint8_t prst = signals[first[2]];
+        const uint8_t clr = signals[first[3]];
+        if (clk && !state[0]) {
+            assign(out[0], state[1]);
+            assign(out[1], !state[1]);
+        }
+        if (!prst || !clr) {
+            assign(out[0], !prst);
+            assign(out[1], !clr);
+        }
+        assign(state[0], clk);
+        assign(state[1], data);
+        break;
+    }
+    case LogicType::TFLIPFLOP: {
+        const uint8_t toggle = signals[first[0]];
+        const uint8_t clk = signals[first[1]];
+        const uint8_t prst = signals[first[2]];
+        const uint8_t clr = signals[first[3]];
+        if (clk && !state[0] && state[1]) {
+            // Mirrors LogicTFlipFlop, where q1 is derived from the already toggled q0.
+            assign(out[0], !out[0]);
+            assign(out[1], !out[0]);
+        }
+        if (!prst || !clr) {
+            assign(out[0], !prst);
+            assign(out[1], !clr);
+        }
+        assign(state[0], clk);
+        assign(state[1], toggle);
+        break;
+    }
+    case LogicType::JKFLIPFLOP: {
+        const uint8_t j = signals[first[0]];
+        const uint8_t clk = signals[first[1]];
+        const uint8_t k = signals[first[2]];
+        const uint8_t prst = signals[first[3]];
+        const uint8_t clr = signals[first[4]];
+        if (clk && !state[0]) {
+            if (state[1] && state[2]) {
+                const uint8_t q0 = out[0];
+                assign(out[0], out[1]);
+                assign(out[1], q0);
+            } else if (state[1]) {
+                assign(out[0], 1);
+                assign(out[1], 0);
+            } else if (state[2]) {
+                assign(out[0], 0);
+                assign(out[1], 1);
+            }
+        }
+        if (!prst || !clr) {
+            assign(out[0], !prst);
+            assign(out[1], !clr);
+        }
+        assign(state[0], clk);
+        assign(state[1], j);
+        assign(state[2], k);
+        break;
+    }
+    case LogicType::SRFLIPFLOP: {
+        const uint8_t s = signals[first[0]];
+        const uint8_t clk = signals[first[1]];
+        const uint8_t r = signals[first[2]];
+        const uint8_t prst = signals[first[3]];
+        const uint8_t clr = signals[first[4]];
+        if (clk && !state[0]) {
+            if (s && r) {
+                assign(out[0], 1);
+                assign(out[1], 1);
+            } else if (s != r) {
+                assign(out[0], s);
+                assign(out[1], r);
+            }
+        }
+        if (!prst || !clr) {
+            assign(out[0], !prst);
+            assign(out[1], !clr);
+        }
+        assign(state[0], clk);
+        break;
+    }
+    case LogicType::INPUT:
+        break;
+    }
+    return changed != 0;
+}
+
+int CompiledNetlist::outputSlot(const LogicElement *elm, int port) const
+{
+    Q_ASSERT(m_outputBase.contains(elm));
+    return m_outputBase.value(elm) + port;
+}
+
+int CompiledNetlist::inputSlot(const LogicElement *elm, int port) const
+{
+    return outputSlot(elm->predecessor(port), elm->predecessorPort(port));
+}
+
+bool CompiledNetlist::value(int slot) const
+{
+    return m_signals[slot];
+}
+
+const uint8_t *CompiledNetlist::signalData() const
+{
+    return m_signals.data();
+}
+
+void CompiledNetlist::setValue(int slot, bool value)
+{
+    if (m_signals[slot] == value) {
+        return;
+    }
+    m_signals[slot] = value;
+    m_quiescent = false;
+    if (m_eventDriven) {
+        schedule(m_slotNode[slot], -1);
+    }
+}
+
+void CompiledNetlist::copyState(const CompiledNetlist &other)
+{
+    // Elements are matched by address: the ones only in other must still be alive, or a new element could reuse one.
+    for (auto iter = m_outputBase.cbegin(); iter != m_outputBase.cend(); ++iter) {
+        const int base = other.m_outputBase.value(iter.key(), -1);
+        // An alias shares the slot of its source, which takes its own value.
+        if ((base != -1) && !m_aliased.contains(iter.key())) {
+            std::copy_n(other.m_signals.cbegin() + base, iter.key()->outputSize(), m_signals.begin() + iter.value());
+        }
+    }
+    for (auto iter = m_gate.cbegin(); iter != m_gate.cend(); ++iter) {
+        const int gate = other.m_gate.value(iter.key(), -1);
+        if ((gate != -1) && (other.m_types[gate] == m_types[iter.value()])) {
+            std::copy(other.m_state.cbegin() + other.m_stateBegin[gate], other.m_state.cbegin() + other.m_stateBegin[gate + 1], m_state.begin() + m_stateBegin[iter.value()]);
+        }
+    }
+    // Folded gates are never evaluated again, so a value other had not settled yet would stay for good.
+    for (const auto &folded : m_folded) {
+        m_signals[folded.first] = folded.second;
+    }
+    m_quiescent = false;
+}
+
+void CompiledNetlist::saveState(std::vector<uint8_t> &out) const
+{
+    out.insert(out.end(), m_signals.cbegin(), m_signals.cend());
+    out.insert(out.end(), m_state.cbegin(), m_state.cend());
+}
+
+void CompiledNetlist::restoreState(const uint8_t *in)
+{
+    std::copy_n(in, m_signals.size(), m_signals.begin());
+    std::copy_n(in + m_signals.size(), m_state.size(), m_state.begin());
+    m_quiescent = false;
+    if (m_eventDriven) {
+        scheduleAll();
+    }
+}
+
+int CompiledNetlist::stateVectorSize() const
+{
+    return static_cast<int>(m_signals.size() + m_state.size());
+}
+
+int CompiledNetlist::signalCount() const
+{
+    return static_cast<int>(m_signals.size());
+}
+
+int CompiledNetlist::foldedGateCount() const
+{
+    return static_cast<int>(m_folded.size());
+}
+
+int CompiledNetlist::aliasCount() const
+{
+    return m_bufferAliases;
+}
+
+int CompiledNetlist::mergedGateCount() const
+{
+    return m_mergedGates;
+}
+
+int CompiledNetlist::sourceGateCount() const
+{
+    return m_sourceGates;
+}
+
+int CompiledNetlist::prunedGateCount() const
+{
+    return m_pruned.size();
+}
+
+bool CompiledNetlist::isPruned(const LogicElement *elm) const
+{
+    return m_pruned.contains(elm);
+}
+
+int CompiledNetlist::gateCount() const
+{
+    return static_cast<int>(m_types.size());
+}
+
+bool CompiledNetlist::hasFeedback() const
+{
+    return m_feedback;
+}
+
+bool CompiledNetlist::isCombinational() const
+{
+    return !m_feedback && !m_sequential;
+}
@@ -0,0 +1,262 @@
+/*
+ * Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef COMPILEDNETLIST_H
+#define COMPILEDNETLIST_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include <QHash>
+#include <QSet>
+#include <QVector>
+
+#include "logicelement.h"
+
+class BytecodeProgram;
+class WorkerPool;
+
+/**
+ * @brief The CompiledNetlist class is a flat, structure-of-arrays copy of a sorted LogicElement graph.
+ *
+ * Every output port of every LogicElement owns one slot of a single packed signal array. Gates are stored
+ * in evaluation order as parallel arrays (type, input range, output slot, state range), so a simulation
+ * tick is a linear sweep over contiguous memory instead of a walk through heap allocated objects.
+ * Predecessors that are not part of the element list (e.g. the global VCC/GND inputs) become constant slots.
+ *
+ * Given the elements that never change, constants are folded while the gates are built: a gate whose output
+ * they decide is not compiled and its slot keeps that value, and inputs that cannot change the output are
+ * dropped from the others (a MUX with a constant select becomes a wire to the selected input). Buffers, like
+ * Nodes and the port nodes of ICs, are not compiled either: a chain of them is an alias of the slot at its
+ * start, which outputSlot() returns for every element of the chain. Optionally, structural hashing merges a
+ * gate into an earlier one of the same type reading the same slots, like the same decoder term built twice.
+ *
+ * Given the elements whose outputs are read, gates that only feed unread outputs (e.g. the unused outputs of
+ * an IC) are pruned: they keep their slots, whose values go stale, until a netlist that observes them is built.
+ *
+ * The LogicElement graph remains the reference implementation; a compiled netlist must be built from
+ * freshly initialized elements, right after ElementMapping::sort(), or take the state of the netlist it
+ * replaces through copyState() when ElementMapping::patch() rebuilds it after an edit.
+ *
+ * Combinational loops found by ElementMapping (e.g. a latch made of two NOR gates) are runs of consecutive
+ * gates evaluated again and again, inside the tick, until their outputs stop changing or SettleLimit passes
+ * were made. Gates outside loops are swept once, without paying for the settling.
+ *
+ * In event-driven mode only the fan-out (taken from LogicElement::successors()) of signals that actually
+ * changed is evaluated, still in priority order. A gate fed back from a later gate is deferred to the next
+ * tick, exactly like the full sweep reads the previous tick value, so both modes produce the same signals.
+ *
+ * Large netlists without feedback are swept level by level on a WorkerPool: gates of the same level never
+ * read each other, so each level is split in chunks that the threads claim until it is done. Serial sweeps
+ * run a BytecodeProgram of the same gates, which avoids the per-gate dispatch through evaluate().
+ */
+class CompiledNetlist
+{
+public:
+    //! Update function of a netlist compiled to machine code, see NativeCompiler. Returns nonzero when a signal or state byte changed.
+    typedef int (*NativeUpdate)(uint8_t *signals, uint8_t *state);
+
+    /**
+     * @brief Each loop must be a run of consecutive elements of sortedElms, see ElementMapping::loops().
+     * @param constants Input elements that never change; with it, constants are folded and buffers collapsed.
+     * Every gate is compiled as is without.
+     * @param observed Elements whose outputs are read; with it, the gates none of them depends on are not
+     * evaluated. Memory elements and loops are always evaluated.
+     * @param hashing Merges gates computing the same function of the same slots, see mergedGateCount().
+     */
+    explicit CompiledNetlist(const QVector<LogicElement *> &sortedElms, const QVector<QVector<LogicElement *>> &loops = {}, const QSet<const LogicElement *> *constants = nullptr,
+                             const QSet<const LogicElement *> *observed = nullptr, bool hashing = false);
+    ~CompiledNetlist();
+
+    CompiledNetlist(const CompiledNetlist &) = delete;
+    CompiledNetlist &operator=(const CompiledNetlist &) = delete;
+
+    //! Smallest gate count swept by several threads.
+    static constexpr int ParallelThreshold = 4096;
+    //! Gates evaluated by a thread in one go.
+    static constexpr int ParallelChunk = 256;
+    //! Most passes over a combinational loop in one tick; an oscillating loop keeps its last pass.
+    static constexpr int SettleLimit = 32;
+
+    //! Evaluates the gates once, in priority order: all of them, or only the scheduled ones in event-driven mode.
+    //! Afterwards isQuiescent() is up to date.
+    void update();
+    //! Like update(), but skips the sweep while the netlist is quiescent.
+    void updateIfActive();
+    //! True when another update() would change nothing until an input changes.
+    bool isQuiescent() const;
+
+    bool isEventDriven() const;
+    void setEventDriven(bool eventDriven);
+
+    /**
+     * @brief Runs full sweeps on pool, which the netlist does not own and which must outlive it, or serially
+     * with nullptr (the default). Netlists that are not parallelizable always stay serial.
+     */
+    void setWorkerPool(WorkerPool *pool);
+    //! True without feedback and with at least ParallelThreshold gates.
+    bool isParallelizable() const;
+    //! True when full sweeps run on several threads.
+    bool isMultiThreaded() const;
+    //! Number of levels of a netlist without feedback, zero otherwise.
+    int levelCount() const;
+
+    //! Runs full sweeps through a native update function instead of the interpreter, or back with nullptr.
+    void setNativeUpdate(NativeUpdate update);
+    bool isNative() const;
+
+    //! Runs serial sweeps through the bytecode interpreter (the default) or through evaluate() for every gate.
+    void setBytecode(bool bytecode);
+    //! The bytecode program of the serial sweeps, nullptr when disabled.
+    const BytecodeProgram *bytecode() const;
+
+    //! Number of combinational loops settled on every tick.
+    int loopCount() const;
+
+    //! Gate evaluations performed and skipped since the netlist was built. Settle passes count once.
+    quint64 evaluationCount() const;
+    quint64 skippedEvaluationCount() const;
+
+    int outputSlot(const LogicElement *elm, int port = 0) const;
+    int inputSlot(const LogicElement *elm, int port = 0) const;
+
+    bool value(int slot) const;
+    void setValue(int slot, bool value);
+    //! All signals, indexed by slot.
+    const uint8_t *signalData() const;
+    //! Takes the signals and flip-flop state of every element that was also compiled into other.
+    void copyState(const CompiledNetlist &other);
+    //! Appends every signal, then the flip-flop state, to out: everything a tick depends on besides the clocks.
+    void saveState(std::vector<uint8_t> &out) const;
+    //! Takes back a state saved by saveState(), starting at in.
+    void restoreState(const uint8_t *in);
+    //! Bytes appended by saveState().
+    int stateVectorSize() const;
+
+    int signalCount() const;
+    int gateCount() const;
+    //! Gates left out because constants decide their output.
+    int foldedGateCount() const;
+    //! Buffers left out because their readers read the slot of their source.
+    int aliasCount() const;
+    //! Gates left out because nothing observed depends on them.
+    int prunedGateCount() const;
+    //! Gates left out by structural hashing: duplicates of a gate built before, and inverters of an inverter.
+    int mergedGateCount() const;
+    //! Gates of the element list, before folding, collapsing, pruning and merging.
+    int sourceGateCount() const;
+    //! True when elm is left out for being unobserved: its outputs are stale.
+    bool isPruned(const LogicElement *elm) const;
+
+    //! True when some gate reads a signal produced by itself or by a later gate.
+    bool hasFeedback() const;
+    //! True without feedback and without memory elements: one sweep fully settles the outputs.
+    bool isCombinational() const;
+
+private:
+    friend class BytecodeProgram;
+    friend class NativeCompiler;
+    friend class ParallelNetlist;
+    friend class TimedNetlist;
+
+
+    //! Returns true when an output or state byte changed.
+    static bool evaluate(LogicType type, const uint8_t *signals, const int *first, const int *last, uint8_t *out, uint8_t *state);
+    static int stateSize(LogicType type);
+    //! Combinational gates that structural hashing may merge.
+    static bool isMergeable(LogicType type);
+    /**
+     * @brief Folds the constant inputs (values in constant, -1 when unknown) of a gate of type. Returns the output
+     * when they decide it, -1 otherwise, with the inputs left to evaluate and possibly a simpler type.
+     */
+    static int fold(LogicType &type, std::vector<int> &inputs, const std::vector<int8_t> &constant);
+
+    int allocateSlots(const LogicElement *elm);
+    void buildFanout();
+    void buildLevels();
+    /* The full sweeps return true when a signal or state byte changed. */
+    bool updateSweep();
+    bool sweep(size_t first, size_t last);
+    //! Returns false when the loop still changes after SettleLimit passes; changed tells whether any pass changed something.
+    bool settle(size_t loop, bool &changed);
+    int settleEvents(int loop);
+    bool updateLevels();
+    void updateEvents();
+    void evaluateGate(size_t gate);
+    void schedule(int node, int fromGate);
+    void enqueue(int gate);
+    void defer(int gate);
+    void scheduleAll();
+
+    QHash<const LogicElement *, int> m_outputBase;
+    QHash<const LogicElement *, int> m_node;
+    QHash<const LogicElement *, int> m_gate;
+
+    /* Gates, in evaluation order. */
+    std::vector<LogicType> m_types;
+    std::vector<int> m_inputBegin;
+    std::vector<int> m_outputBegin;
+    std::vector<int> m_outputEnd;
+    std::vector<int> m_stateBegin;
+    std::vector<int> m_gateNode;
+
+    /* Flattened gate inputs, indexed by m_inputBegin. */
+    std::vector<int> m_inputSlots;
+
+    std::vector<uint8_t> m_signals;
+    std::vector<uint8_t> m_state;
+    //! Output slots of the folded gates, with their value.
+    std::vector<std::pair<int, uint8_t>> m_folded;
+    //! Collapsed buffers and merged gates, whose m_outputBase is the slot of the same signal.
+    QSet<const LogicElement *> m_aliased;
+    //! Elements of unobserved cones, which keep their slots but no gate.
+    QSet<const LogicElement *> m_pruned;
+
+    bool m_feedback;
+    bool m_sequential;
+
+    /* Combinational loops as inclusive gate ranges, in evaluation order, the loop of every gate (-1 outside of
+     * loops) and room for the loop outputs before settling. */
+    std::vector<int> m_loopFirst;
+    std::vector<int> m_loopLast;
+    std::vector<int> m_gateLoop;
+    std::vector<uint8_t> m_settleStart;
+
+    /* Levelized sweep: gate indices grouped by level, and the chunk counter of each level. */
+    std::vector<int> m_levelGates;
+    std::vector<int> m_levelBegin;
+    std::atomic<int> *m_levelNext;
+    std::atomic<bool> m_levelChanged;
+    WorkerPool *m_pool;
+
+    NativeUpdate m_native;
+    BytecodeProgram *m_bytecode;
+
+    /* Event-driven scheduling. A node is any element owning signal slots; fan-out lists hold gate indices. */
+    bool m_eventDriven;
+    std::vector<int> m_slotNode;
+    std::vector<int> m_fanoutBegin;
+    std::vector<int> m_fanout;
+    std::priority_queue<int, std::vector<int>, std::greater<int>> m_queue;
+    std::vector<uint8_t> m_queued;
+    std::vector<int> m_nextTick;
+    std::vector<uint8_t> m_deferred;
+
+    //! Whether the last update changed no signal nor state.
+    bool m_quiescent;
+
+    quint64 m_evaluations;
+    quint64 m_skippedEvaluations;
+
+    int m_sourceGates;
+    int m_bufferAliases;
+    int m_mergedGates;
+};
+
+#endif // COMPILEDNETLIST_H
@@ -0,0 +1,80 @@
+// Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "delaydialog.h"
+
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QPair>
+#include <QSpinBox>
+#include <QVBoxLayout>
+
+#include "timednetlist.h"
+
+DelayDialog::DelayDialog(const QVector<int> &delays, QWidget *parent)
+    : QDialog(parent)
+    , m_delays(withDefaults(delays))
+    , m_spinBoxes(TimedNetlist::TypeCount, nullptr)
+{
+    setWindowTitle(tr("Gate Delays"));
+    const QVector<QPair<LogicType, QString>> gates = {
+        {LogicType::NOT, tr("Not")},
+        {LogicType::AND, tr("And")},
+        {LogicType::OR, tr("Or")},
+        {LogicType::NAND, tr("Nand")},
+        {LogicType::NOR, tr("Nor")},
+        {LogicType::XOR, tr("Xor")},
+        {LogicType::XNOR, tr("Xnor")},
+        {LogicType::MUX, tr("Mux")},
+        {LogicType::DEMUX, tr("Demux")},
+        {LogicType::DLATCH, tr("D Latch")},
+        {LogicType::DFLIPFLOP, tr("D Flip-Flop")},
+        {LogicType::JKFLIPFLOP, tr("JK Flip-Flop")},
+        {LogicType::SRFLIPFLOP, tr("SR Flip-Flop")},
+        {LogicType::TFLIPFLOP, tr("T Flip-Flop")},
+    };
+    auto *form = new QFormLayout;
+    for (const auto &gate : gates) {
+        const int type = static_cast<int>(gate.first);
+        auto *spinBox = new QSpinBox(this);
+        spinBox->setRange(0, 1000);
+        spinBox->setValue(m_delays.at(type));
+        form->addRow(gate.second, spinBox);
+        m_spinBoxes[type] = spinBox;
+    }
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+    connect(buttons, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+    auto *layout = new QVBoxLayout(this);
+    layout->addLayout(form);
+    layout->addWidget(buttons);
+}
+
+QVector<int> DelayDialog::delays() const
+{
+    QVector<int> delays(m_delays);
+    for (int type = 0; type < m_spinBoxes.size(); ++type) {
+        if (m_spinBoxes.at(type)) {
+            delays[type] = m_spinBoxes.at(type)->value();
+        }
+    }
+    return delays;
+}
+
+void DelayDialog::setDelay(int type, int delay)
+{
+    if (m_spinBoxes.at(type)) {
+        m_spinBoxes.at(type)->setValue(delay);
+    } else {
+        m_delays[type] = delay;
+    }
+}
+
+QVector<int> DelayDialog::withDefaults(const QVector<int> &delays)
+{
+    QVector<int> complete(delays.mid(0, TimedNetlist::TypeCount));
+    for (int type = complete.size(); type < TimedNetlist::TypeCount; ++type) {
+        complete.append(TimedNetlist::defaultDelay(static_cast<LogicType>(type)));
+    }
+    return complete;
+}
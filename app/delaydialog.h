@@ -0,0 +1,37 @@
+/*
+ * Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef DELAYDIALOG_H
+#define DELAYDIALOG_H
+
+#include <QDialog>
+#include <QVector>
+
+class QSpinBox;
+
+//!
+//! \brief The DelayDialog class edits the propagation delay of every gate type, in delay units.
+//!
+class DelayDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit DelayDialog(const QVector<int> &delays, QWidget *parent = nullptr);
+
+    //! One delay per LogicType, by index.
+    QVector<int> delays() const;
+    void setDelay(int type, int delay);
+
+    //! delays, then TimedNetlist::defaultDelay() for the types it lacks.
+    static QVector<int> withDefaults(const QVector<int> &delays);
+
+private:
+    QVector<int> m_delays;
+    //! Indexed by LogicType; inputs, outputs and nodes have no spin box and keep their delay.
+    QVector<QSpinBox *> m_spinBoxes;
+};
+
+#endif /* DELAYDIALOG_H */
@@ -105,6 +105,21 @@ void Clock::resetClock()
     m_elapsed = 0;
 }
 
+int Clock::interval() const
+{
+    return m_interval;
+}
+
+int Clock::elapsed() const
+{
+    return m_elapsed;
+}
+
+void Clock::setElapsed(int elapsed)
+{
+    m_elapsed = elapsed;
+}
+
 QString Clock::genericProperties()
 {
     return QString("%1 Hz").arg(static_cast<double>(getFrequency()));
@@ -29,6 +29,11 @@ public:
     void setFrequency(float freq) override;
     void updateClock();
     void resetClock();
+    //! Tick-based schedule, for engines that advance the clock away from the element (see SimulationWorker).
+    int interval() const;
+    int elapsed() const;
+    //! Moves the schedule, e.g. back to a state recorded by the simulation history.
+    void setElapsed(int elapsed);
     QString genericProperties() override;
 
 public:
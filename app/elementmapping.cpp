@@ -3,7 +3,11 @@
 
 #include "elementmapping.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "clock.h"
+#include "compilednetlist.h"
 #include "graphicelement.h"
 #include "ic.h"
 #include "icmanager.h"
@@ -11,8 +15,13 @@
 #include "icprototype.h"
 #include "input.h"
 #include "logicelement.h"
+#include "nativecompiler.h"
+#include "parallelnetlist.h"
 #include "qneconnection.h"
 #include "qneport.h"
+#include "sccscheduler.h"
+#include "simulationworker.h"
+#include "timednetlist.h"
 
 #include "logicelement/logicand.h"
 #include "logicelement/logicdemux.h"
@@ -31,12 +40,65 @@
 #include "logicelement/logicxnor.h"
 #include "logicelement/logicxor.h"
 
+namespace
+{
+//! Flip-flops only sample their inputs on a clock edge: a cycle through one is plain feedback, not a loop to settle.
+bool cutsLoops(LogicType type)
+{
+    return (type == LogicType::DFLIPFLOP) || (type == LogicType::TFLIPFLOP) || (type == LogicType::JKFLIPFLOP) || (type == LogicType::SRFLIPFLOP);
+}
+
+//! Evaluates a combinational loop until its outputs stop changing, with the bound and order of CompiledNetlist.
+void settle(const QVector<LogicElement *> &loop)
+{
+    std::vector<uint8_t> previous;
+    for (int pass = 0; pass < CompiledNetlist::SettleLimit; ++pass) {
+        previous.clear();
+        for (LogicElement *elm : loop) {
+            for (size_t port = 0; port < elm->outputSize(); ++port) {
+                previous.push_back(elm->getOutputValue(port));
+            }
+        }
+        for (LogicElement *elm : loop) {
+            elm->updateLogic();
+        }
+        bool settled = true;
+        auto value = previous.cbegin();
+        for (LogicElement *elm : loop) {
+            for (size_t port = 0; port < elm->outputSize(); ++port) {
+                settled &= (*value++ == elm->getOutputValue(port));
+            }
+        }
+        if (settled) {
+            return;
+        }
+    }
+}
+}
+
 ElementMapping::ElementMapping(const QVector<GraphicElement *> &elms, const QString &file)
     : m_currentFile(file)
     , m_initialized(false)
     , m_elements(elms)
     , m_globalGND(false)
     , m_globalVCC(true)
+    , m_netlist(nullptr)
+    , m_pool(nullptr)
+    , m_signalsShown(false)
+    , m_eventDriven(false)
+    , m_native(false)
+    , m_nativeBuild(nullptr)
+    , m_structuralHashing(false)
+    , m_worker(nullptr)
+    , m_workerTickInterval(0)
+    , m_speed(1)
+    , m_ticks(0)
+    , m_historyInterval(DefaultHistoryInterval)
+    , m_lastRecord(0)
+    , m_recorded(false)
+    , m_recordingInputs(false)
+    , m_replayingInputs(false)
+    , m_restartWorker(false)
 {
 }
 
@@ -47,29 +109,60 @@ ElementMapping::~ElementMapping()
 
 void ElementMapping::clear()
 {
+    stopWorker();
     m_initialized = false;
+    delete m_nativeBuild;
+    m_nativeBuild = nullptr;
+    delete m_netlist;
+    m_netlist = nullptr;
     m_globalGND.clearSucessors();
     m_globalVCC.clearSucessors();
     qDeleteAll(m_deletableElements);
     m_deletableElements.clear();
+    m_observed.clear();
     qDeleteAll(m_icMappings);
     m_icMappings.clear();
     m_elementMap.clear();
     m_inputMap.clear();
     m_clocks.clear();
     m_logicElms.clear();
+    m_loops.clear();
+    m_loopHead.clear();
+    m_rewired.clear();
+    m_staleElements.clear();
+    qDeleteAll(m_retiredElements);
+    m_retiredElements.clear();
+    qDeleteAll(m_retiredMappings);
+    m_retiredMappings.clear();
+    m_restartWorker = false;
 }
 
 QVector<GraphicElement *> ElementMapping::sortGraphicElements(QVector<GraphicElement *> elms)
 {
-    //! Clazy warning: Use QHash<K, T> instead of QMap<K, T> when K is a pointer
-    QHash<GraphicElement *, bool> beingvisited;
+    QHash<GraphicElement *, int> index;
+    for (int node = 0; node < elms.size(); ++node) {
+        index.insert(elms.at(node), node);
+    }
+    SccScheduler scheduler(elms.size());
+    for (int node = 0; node < elms.size(); ++node) {
+        const auto elm_outputs = elms.at(node)->outputs();
+        for (QNEPort *port : elm_outputs) {
+            for (QNEConnection *conn : port->connections()) {
+                QNEPort *successor = conn->otherPort(port);
+                const int target = successor ? index.value(successor->graphicElement(), -1) : -1;
+                if (target != -1) {
+                    scheduler.addEdge(node, target);
+                }
+            }
+        }
+    }
+    scheduler.run();
     QHash<GraphicElement *, int> priority;
-    for (GraphicElement *elm : elms) {
-        calculatePriority(elm, beingvisited, priority);
+    for (int node = 0; node < elms.size(); ++node) {
+        priority.insert(elms.at(node), scheduler.priority(node));
     }
-    std::sort(elms.begin(), elms.end(), [priority](GraphicElement *e1, GraphicElement *e2) {
-        return priority[e2] < priority[e1];
+    std::stable_sort(elms.begin(), elms.end(), [&priority](GraphicElement *e1, GraphicElement *e2) {
+        return priority.value(e2) < priority.value(e1);
     });
 
     return elms;
@@ -96,7 +189,6 @@ void ElementMapping::insertIC(IC *ic)
     if (proto) {
         ICMapping *icMap = proto->generateMapping();
         Q_ASSERT(icMap);
-        icMap->initialize();
         m_icMappings.insert(ic, icMap);
         m_logicElms.append(icMap->m_logicElms);
     }
@@ -187,12 +279,98 @@ void ElementMapping::sort()
 {
     sortLogicElements();
     validateElements();
+    compile();
+}
+
+void ElementMapping::compile()
+{
+    delete m_nativeBuild;
+    m_nativeBuild = nullptr;
+    delete m_netlist;
+    const QSet<const LogicElement *> constants = constantElements();
+    const QSet<const LogicElement *> observed = observedElements();
+    m_netlist = new CompiledNetlist(m_logicElms, m_loops, &constants, &observed, m_structuralHashing);
+    if (m_pool && m_netlist->isParallelizable()) {
+        m_netlist->setWorkerPool(m_pool);
+    }
+    m_signalsShown = false;
+    m_netlist->setEventDriven(m_eventDriven);
+    if (m_native) {
+        // A module built before is taken right away; otherwise the interpreter runs until the build is done.
+        m_nativeBuild = new NativeCompiler(*m_netlist);
+        adoptNative();
+    }
+    // Recorded states no longer match the slots of the new netlist, nor do input logs.
+    m_history.clear();
+    m_recorded = false;
+    if (m_recordingInputs) {
+        m_inputLog.setEndTick(m_ticks);
+    }
+    m_recordingInputs = false;
+    m_replayingInputs = false;
+}
+
+QSet<const LogicElement *> ElementMapping::constantElements() const
+{
+    // Inputs the user cannot change: VCC, GND and whatever input ends up inside an IC.
+    QSet<const LogicElement *> constants;
+    for (LogicElement *elm : qAsConst(m_logicElms)) {
+        if (elm->type() == LogicType::INPUT) {
+            constants.insert(elm);
+        }
+    }
+    for (auto iter = m_inputMap.cbegin(); iter != m_inputMap.cend(); ++iter) {
+        constants.remove(iter.value());
+    }
+    return constants;
+}
+
+QSet<const LogicElement *> ElementMapping::observedElements() const
+{
+    // What the scene shows: output elements and outputs wired to something. Other gates are not evaluated.
+    QSet<const LogicElement *> observed;
+    for (LogicElement *elm : qAsConst(m_observed)) {
+        observed.insert(elm);
+    }
+    for (GraphicElement *elm : qAsConst(m_elements)) {
+        ICMapping *icMap = (elm->elementType() == ElementType::IC) ? m_icMappings.value(dynamic_cast<IC *>(elm)) : nullptr;
+        if (elm->elementGroup() == ElementGroup::OUTPUT) {
+            observed.insert(m_elementMap.value(elm));
+        }
+        const auto elm_outputs = elm->outputs();
+        for (QNEOutputPort *out : elm_outputs) {
+            if (!out->connections().isEmpty()) {
+                observed.insert(icMap ? icMap->getOutput(out->index()) : m_elementMap.value(elm));
+            }
+        }
+    }
+    return observed;
+}
+
+void ElementMapping::recompile()
+{
+    const int tickInterval = m_workerTickInterval;
+    const bool threaded = hasWorker();
+    stopWorker();
+    CompiledNetlist *previous = m_netlist;
+    m_netlist = nullptr;
+    compile();
+    m_netlist->copyState(*previous);
+    delete previous;
+    if (threaded) {
+        startWorker(tickInterval);
+    }
 }
 
 // TODO: This function can easily cause crashes when using the Undo command to delete elements
 void ElementMapping::update()
 {
     //  bool resetSimulationController = false;
+    if (m_worker) {
+        // The worker ticks on its own.
+        return;
+    }
+    adoptNative();
     if (canRun()) {
         for (Clock *clk : qAsConst(m_clocks)) {
             if (!clk) {
@@ -205,6 +383,18 @@ void ElementMapping::update()
             }
         }
         Clock::reset = false;
+        // Inputs change on the tick about to run, as on the worker.
+        while (m_replayingInputs && (m_replayReader.tick() <= m_ticks + 1)) {
+            m_logInputs.at(m_replayReader.event().input)->setOn(m_replayReader.event().value);
+            m_replayReader.advance();
+        }
+        for (int input = 0; m_recordingInputs && (input < m_logInputs.size()); ++input) {
+            const bool value = m_logInputs.at(input)->getOn();
+            if (value != m_logValues.at(input)) {
+                m_inputLog.append(m_ticks + 1, input, value);
+                m_logValues[input] = value;
+            }
+        }
         for (auto iter = m_inputMap.begin(); iter != m_inputMap.end(); ++iter) {
             if (!iter.key()) {
                 continue;
@@ -212,15 +402,189 @@ void ElementMapping::update()
             if (!iter.value()) {
                 continue;
             }
-            iter.value()->setOutputValue(iter.key()->getOn());
+            if (m_netlist) {
+                m_netlist->setValue(m_netlist->outputSlot(iter.value()), iter.key()->getOn());
+            } else {
+                iter.value()->setOutputValue(iter.key()->getOn());
+            }
         }
-        for (LogicElement *elm : qAsConst(m_logicElms)) {
-            elm->updateLogic();
+        ++m_ticks;
+        if (m_netlist) {
+            // Between clock edges and input changes a settled netlist is not swept again.
+            m_netlist->updateIfActive();
+            if (m_historyInterval > 0) {
+                recordState();
+            }
+        } else {
+            updateLogicElements();
         }
     }
     //  return resetSimulationController;
 }
 
+void ElementMapping::updateLogicElements()
+{
+    int loop = 0;
+    for (int idx = 0; idx < m_logicElms.size(); ++idx) {
+        if ((loop < m_loops.size()) && (m_logicElms.at(idx) == m_loops.at(loop).first())) {
+            settle(m_loops.at(loop));
+            idx += m_loops.at(loop).size() - 1;
+            ++loop;
+        } else {
+            m_logicElms.at(idx)->updateLogic();
+        }
+    }
+}
+
+void ElementMapping::removeElements(const QVector<GraphicElement *> &elements)
+{
+    if (m_worker) {
+        // The worker reads the inputs being removed; patch() starts it again.
+        m_restartWorker = true;
+        stopWorker();
+    }
+    QSet<LogicElement *> removed;
+    for (GraphicElement *elm : elements) {
+        QVector<LogicElement *> logic;
+        if (elm->elementType() == ElementType::IC) {
+            ICMapping *icMap = m_icMappings.take(dynamic_cast<IC *>(elm));
+            if (!icMap) {
+                continue;
+            }
+            logic = icMap->m_logicElms;
+            // The constants of the IC go away with its mapping.
+            removed.insert(&icMap->m_globalGND);
+            removed.insert(&icMap->m_globalVCC);
+            m_retiredMappings.append(icMap);
+        } else {
+            LogicElement *logElm = m_elementMap.take(elm);
+            if (!logElm) {
+                continue;
+            }
+            logic.append(logElm);
+            m_inputMap.remove(dynamic_cast<Input *>(elm));
+            m_clocks.removeAll(dynamic_cast<Clock *>(elm));
+            m_deletableElements.removeOne(logElm);
+            m_retiredElements.append(logElm);
+        }
+        for (LogicElement *logElm : qAsConst(logic)) {
+            for (size_t in = 0; in < logElm->inputSize(); ++in) {
+                if (logElm->predecessor(in)) {
+                    m_staleElements.insert(logElm->predecessor(in));
+                }
+            }
+            logElm->clearPredecessors();
+            logElm->clearSucessors();
+            m_loopHead.remove(logElm);
+            removed.insert(logElm);
+        }
+        m_elements.removeOne(elm);
+        m_rewired.remove(elm);
+    }
+    m_logicElms.erase(std::remove_if(m_logicElms.begin(), m_logicElms.end(), [&removed](LogicElement *logElm) {
+        return removed.contains(logElm);
+    }), m_logicElms.end());
+    for (auto &loop : m_loops) {
+        loop.erase(std::remove_if(loop.begin(), loop.end(), [&removed](LogicElement *logElm) {
+            return removed.contains(logElm);
+        }), loop.end());
+    }
+    m_loops.erase(std::remove_if(m_loops.begin(), m_loops.end(), [](const QVector<LogicElement *> &loop) {
+        return loop.isEmpty();
+    }), m_loops.end());
+    m_staleElements.subtract(removed);
+    m_observed.subtract(removed);
+}
+
+void ElementMapping::markRewired(const QVector<GraphicElement *> &elements)
+{
+    for (GraphicElement *elm : elements) {
+        m_rewired.insert(elm);
+    }
+}
+
+bool ElementMapping::patch(const QVector<GraphicElement *> &elements)
+{
+    if (!m_initialized || !m_netlist) {
+        return false;
+    }
+    QVector<GraphicElement *> added;
+    for (GraphicElement *elm : elements) {
+        if (elm->elementType() == ElementType::IC) {
+            IC *ic = dynamic_cast<IC *>(elm);
+            if (!m_icMappings.contains(ic)) {
+                if (!ICManager::instance()->getPrototype(ic->getFile())) {
+                    return false;
+                }
+                added.append(elm);
+            }
+        } else if (!m_elementMap.contains(elm)) {
+            added.append(elm);
+        }
+    }
+    if ((m_elements.size() + added.size()) != elements.size()) {
+        return false;
+    }
+    const int tickInterval = m_workerTickInterval;
+    const bool threaded = m_restartWorker || hasWorker();
+    m_restartWorker = false;
+    stopWorker();
+
+    const int firstNew = m_logicElms.size();
+    for (GraphicElement *elm : qAsConst(added)) {
+        m_elements.append(elm);
+        if (elm->elementType() == ElementType::CLOCK) {
+            m_clocks.append(dynamic_cast<Clock *>(elm));
+        }
+        if (elm->elementType() == ElementType::IC) {
+            insertIC(dynamic_cast<IC *>(elm));
+        } else {
+            insertElement(elm);
+        }
+        m_rewired.insert(elm);
+    }
+    QVector<LogicElement *> changed = m_logicElms.mid(firstNew);
+    for (GraphicElement *elm : qAsConst(m_rewired)) {
+        QVector<LogicElement *> targets;
+        if (elm->elementType() == ElementType::IC) {
+            ICMapping *icMap = m_icMappings.value(dynamic_cast<IC *>(elm));
+            for (int in = 0; in < elm->inputSize(); ++in) {
+                targets.append(icMap->getInput(in));
+            }
+        } else {
+            targets.append(m_elementMap.value(elm));
+        }
+        for (LogicElement *logElm : qAsConst(targets)) {
+            for (size_t in = 0; in < logElm->inputSize(); ++in) {
+                if (logElm->predecessor(in)) {
+                    m_staleElements.insert(logElm->predecessor(in));
+                }
+            }
+            logElm->clearPredecessors();
+            changed.append(logElm);
+        }
+        const auto elm_inputs = elm->inputs();
+        for (QNEPort *in : elm_inputs) {
+            applyConnection(elm, in);
+        }
+    }
+    m_rewired.clear();
+    changed.append(m_staleElements.values().toVector());
+    m_staleElements.clear();
+    updatePriorities(changed);
+    validateElements();
+
+    recompile();
+    qDeleteAll(m_retiredElements);
+    m_retiredElements.clear();
+    qDeleteAll(m_retiredMappings);
+    m_retiredMappings.clear();
+    if (threaded) {
+        startWorker(tickInterval);
+    }
+    return true;
+}
+
 ICMapping *ElementMapping::getICMapping(IC *ic) const
 {
     Q_ASSERT(ic);
@@ -233,6 +597,611 @@ LogicElement *ElementMapping::getLogicElement(GraphicElement *elm) const
     return m_elementMap[elm];
 }
 
+const QVector<LogicElement *> &ElementMapping::logicElements() const
+{
+    return m_logicElms;
+}
+
+const QVector<QVector<LogicElement *>> &ElementMapping::loops() const
+{
+    return m_loops;
+}
+
+void ElementMapping::observe(LogicElement *elm)
+{
+    observe(QVector<LogicElement *>{elm});
+}
+
+void ElementMapping::observe(const QVector<LogicElement *> &elms)
+{
+    bool pruned = false;
+    for (LogicElement *elm : elms) {
+        Q_ASSERT(elm);
+        m_observed.insert(elm);
+        pruned = pruned || isPruned(elm);
+    }
+    if (pruned) {
+        recompile();
+    }
+}
+
+void ElementMapping::unobserve(LogicElement *elm)
+{
+    m_observed.remove(elm);
+}
+
+bool ElementMapping::isPruned(LogicElement *elm) const
+{
+    return m_netlist && m_netlist->isPruned(elm);
+}
+
+bool ElementMapping::getOutputValue(LogicElement *elm, int port) const
+{
+    Q_ASSERT(elm);
+    if (m_worker) {
+        return m_worker->snapshot()[m_netlist->outputSlot(elm, port)];
+    }
+    if (m_netlist) {
+        return m_netlist->value(m_netlist->outputSlot(elm, port));
+    }
+    return elm->getOutputValue(port);
+}
+
+bool ElementMapping::getInputValue(LogicElement *elm, int port) const
+{
+    Q_ASSERT(elm);
+    if (m_worker) {
+        return m_worker->snapshot()[m_netlist->inputSlot(elm, port)];
+    }
+    if (m_netlist) {
+        return m_netlist->value(m_netlist->inputSlot(elm, port));
+    }
+    return elm->getInputValue(port);
+}
+
+const uint8_t *ElementMapping::signalData() const
+{
+    if (m_worker) {
+        return m_worker->snapshot();
+    }
+    return m_netlist ? m_netlist->signalData() : nullptr;
+}
+
+int ElementMapping::outputSlot(LogicElement *elm, int port) const
+{
+    Q_ASSERT(elm);
+    return m_netlist ? m_netlist->outputSlot(elm, port) : -1;
+}
+
+int ElementMapping::inputSlot(LogicElement *elm, int port) const
+{
+    Q_ASSERT(elm);
+    return m_netlist ? m_netlist->inputSlot(elm, port) : -1;
+}
+
+bool ElementMapping::takeChangedSlots(QVector<int> &changed)
+{
+    changed.clear();
+    if (!m_netlist) {
+        return false;
+    }
+    const uint8_t *values = signalData();
+    const size_t count = static_cast<size_t>(m_netlist->signalCount());
+    if (!m_signalsShown) {
+        m_shownSignals.assign(values, values + count);
+        m_signalsShown = true;
+        return false;
+    }
+    // Eight slots per comparison: a settled circuit costs a fraction of a pass over the scene.
+    uint8_t *shown = m_shownSignals.data();
+    for (size_t first = 0; first < count; first += sizeof(quint64)) {
+        const size_t last = std::min(first + sizeof(quint64), count);
+        if (last - first == sizeof(quint64)) {
+            quint64 now;
+            quint64 before;
+            std::memcpy(&now, values + first, sizeof(quint64));
+            std::memcpy(&before, shown + first, sizeof(quint64));
+            if (now == before) {
+                continue;
+            }
+        }
+        for (size_t slot = first; slot < last; ++slot) {
+            if (values[slot] != shown[slot]) {
+                shown[slot] = values[slot];
+                changed.append(static_cast<int>(slot));
+            }
+        }
+    }
+    return true;
+}
+
+void ElementMapping::setEventDriven(bool eventDriven)
+{
+    m_eventDriven = eventDriven;
+    if (m_netlist) {
+        const int tickInterval = m_workerTickInterval;
+        const bool threaded = hasWorker();
+        stopWorker();
+        m_netlist->setEventDriven(eventDriven);
+        if (threaded) {
+            startWorker(tickInterval);
+        }
+    }
+}
+
+void ElementMapping::setNative(bool native)
+{
+    m_native = native;
+    delete m_nativeBuild;
+    m_nativeBuild = nullptr;
+    if (!m_netlist) {
+        return;
+    }
+    if (native) {
+        m_nativeBuild = new NativeCompiler(*m_netlist);
+        adoptNative();
+    } else if (m_netlist->isNative()) {
+        setNativeUpdate(nullptr);
+    }
+}
+
+void ElementMapping::adoptNative()
+{
+    if (!m_nativeBuild || !m_nativeBuild->isFinished()) {
+        return;
+    }
+    const CompiledNetlist::NativeUpdate update = m_nativeBuild->result();
+    delete m_nativeBuild;
+    m_nativeBuild = nullptr;
+    if (update) {
+        setNativeUpdate(update);
+    }
+}
+
+void ElementMapping::setNativeUpdate(CompiledNetlist::NativeUpdate update)
+{
+    // The worker owns the netlist while it runs.
+    const int tickInterval = m_workerTickInterval;
+    const bool threaded = hasWorker();
+    stopWorker();
+    m_netlist->setNativeUpdate(update);
+    if (threaded) {
+        startWorker(tickInterval);
+    }
+}
+
+void ElementMapping::setStructuralHashing(bool hashing)
+{
+    if (hashing == m_structuralHashing) {
+        return;
+    }
+    m_structuralHashing = hashing;
+    if (m_netlist) {
+        recompile();
+    }
+}
+
+void ElementMapping::setWorkerPool(WorkerPool *pool)
+{
+    m_pool = pool;
+}
+
+int ElementMapping::sourceGateCount() const
+{
+    return m_netlist ? m_netlist->sourceGateCount() : 0;
+}
+
+int ElementMapping::gateCount() const
+{
+    return m_netlist ? m_netlist->gateCount() : 0;
+}
+
+bool ElementMapping::isNative() const
+{
+    return m_netlist && m_netlist->isNative();
+}
+
+quint64 ElementMapping::evaluationCount() const
+{
+    if (m_worker) {
+        return m_worker->evaluationCount();
+    }
+    return m_netlist ? m_netlist->evaluationCount() : 0;
+}
+
+quint64 ElementMapping::skippedEvaluationCount() const
+{
+    if (m_worker) {
+        return m_worker->skippedEvaluationCount();
+    }
+    return m_netlist ? m_netlist->skippedEvaluationCount() : 0;
+}
+
+void ElementMapping::startWorker(int tickInterval)
+{
+    if (m_worker || !m_netlist || !canRun()) {
+        return;
+    }
+    QVector<SimulationWorker::ClockState> clocks;
+    for (Clock *clk : qAsConst(m_clocks)) {
+        LogicElement *logElm = m_elementMap.value(clk);
+        if (clk && logElm) {
+            clocks.append({m_netlist->outputSlot(logElm), clk->interval(), clk->elapsed(), clk->getOn(), clk->disabled()});
+        }
+    }
+    m_workerInputs.clear();
+    m_workerInputValues.clear();
+    for (auto iter = m_inputMap.cbegin(); iter != m_inputMap.cend(); ++iter) {
+        if (iter.key() && iter.value() && !dynamic_cast<Clock *>(iter.key())) {
+            const int slot = m_netlist->outputSlot(iter.value());
+            m_workerInputs.append(qMakePair(iter.key(), slot));
+            m_workerInputValues.append(m_netlist->value(slot));
+        }
+    }
+    m_workerTickInterval = tickInterval;
+    m_worker = new SimulationWorker(*m_netlist, clocks, Clock::reset, tickInterval, m_speed, (m_historyInterval > 0) ? &m_history : nullptr, m_ticks, m_historyInterval,
+                                    m_recordingInputs ? &m_inputLog : nullptr, m_replayingInputs ? &m_replayLog : nullptr, m_logSlots);
+    Clock::reset = false;
+}
+
+void ElementMapping::stopWorker()
+{
+    if (!m_worker) {
+        return;
+    }
+    // Clock elements may already be gone here, so the clock schedule is not written back; clocks keep the
+    // value and phase taken by the last syncWorker().
+    m_worker->stop();
+    m_ticks += m_worker->tickCount();
+    delete m_worker;
+    m_worker = nullptr;
+    if (m_history.count() > 0) {
+        m_lastRecord = m_history.tick(m_history.count() - 1);
+        m_recorded = true;
+    }
+    // The worker went on with both logs: pick them up where it stopped.
+    for (int input = 0; m_recordingInputs && (input < m_logInputs.size()); ++input) {
+        m_logValues[input] = m_netlist->value(m_logSlots.at(input));
+    }
+    if (m_replayingInputs) {
+        m_replayReader = InputLog::Reader(&m_replayLog, m_ticks + 1);
+    }
+}
+
+void ElementMapping::setSpeed(int speed)
+{
+    m_speed = speed;
+    if (m_worker) {
+        m_worker->setSpeed(speed);
+    }
+}
+
+quint64 ElementMapping::tickCount() const
+{
+    return m_ticks + (m_worker ? m_worker->tickCount() : 0);
+}
+
+const StateHistory &ElementMapping::history() const
+{
+    return m_history;
+}
+
+int ElementMapping::historyInterval() const
+{
+    return m_historyInterval;
+}
+
+void ElementMapping::setHistoryInterval(int interval)
+{
+    m_historyInterval = qMax(interval, 0);
+}
+
+void ElementMapping::recordState()
+{
+    if (m_recorded && (m_ticks < m_lastRecord + static_cast<quint64>(m_historyInterval))) {
+        return;
+    }
+    // Same layout as SimulationWorker::record(), so either can continue the other's history.
+    m_stateVector.clear();
+    m_netlist->saveState(m_stateVector);
+    for (Clock *clk : qAsConst(m_clocks)) {
+        if (clk && m_elementMap.value(clk)) {
+            SimulationWorker::saveClock(m_stateVector, clk->getOn(), clk->elapsed() % qMax(clk->interval(), 1));
+        }
+    }
+    m_history.record(m_ticks, m_stateVector);
+    m_lastRecord = m_ticks;
+    m_recorded = true;
+}
+
+bool ElementMapping::stepHistory(int steps)
+{
+    stopWorker();
+    if (!m_netlist || (m_history.count() == 0)) {
+        return false;
+    }
+    int index = m_history.indexOf(m_ticks);
+    int target = index + steps;
+    if ((steps < 0) && (index >= 0) && (m_history.tick(index) < m_ticks)) {
+        // Between two records: the first step back goes to the one before the current tick.
+        ++target;
+    }
+    target = qBound(0, target, m_history.count() - 1);
+    if ((target == index) && (m_history.tick(index) == m_ticks)) {
+        return false;
+    }
+    // The inputs of a recording must stay in tick order, so going back ends it; a replay just goes back too.
+    if (m_recordingInputs) {
+        m_inputLog.setEndTick(m_ticks);
+        m_recordingInputs = false;
+    }
+    m_history.state(target, m_stateVector);
+    m_netlist->restoreState(m_stateVector.data());
+    const uint8_t *clockState = m_stateVector.data() + m_netlist->stateVectorSize();
+    for (Clock *clk : qAsConst(m_clocks)) {
+        if (clk && m_elementMap.value(clk)) {
+            bool on;
+            int phase;
+            SimulationWorker::restoreClock(clockState, on, phase);
+            clk->setOn(on);
+            clk->setElapsed(phase);
+            clockState += SimulationWorker::ClockStateSize;
+        }
+    }
+    // update() drives the netlist from the input elements, so they go back too.
+    for (auto iter = m_inputMap.cbegin(); iter != m_inputMap.cend(); ++iter) {
+        if (iter.key() && iter.value() && !dynamic_cast<Clock *>(iter.key()) && (iter.value()->outputSize() == 1)) {
+            iter.key()->setOn(m_netlist->value(m_netlist->outputSlot(iter.value())));
+        }
+    }
+    m_ticks = m_history.tick(target);
+    m_lastRecord = m_ticks;
+    m_recorded = true;
+    if (m_replayingInputs) {
+        m_replayReader = InputLog::Reader(&m_replayLog, m_ticks + 1);
+    }
+    Clock::reset = false;
+    return true;
+}
+
+bool ElementMapping::setLogInputs()
+{
+    if (!m_netlist || m_worker || (m_ticks != 0)) {
+        return false;
+    }
+    // m_inputMap is ordered by address; the element order is the one of the circuit file.
+    m_logInputs.clear();
+    m_logSlots.clear();
+    m_logValues.clear();
+    for (GraphicElement *elm : qAsConst(m_elements)) {
+        auto *in = dynamic_cast<Input *>(elm);
+        LogicElement *logElm = in ? m_inputMap.value(in) : nullptr;
+        if (logElm && !dynamic_cast<Clock *>(in)) {
+            m_logInputs.append(in);
+            m_logSlots.append(m_netlist->outputSlot(logElm));
+            m_logValues.append(in->getOn());
+        }
+    }
+    return true;
+}
+
+bool ElementMapping::startRecording()
+{
+    if (m_replayingInputs || !setLogInputs()) {
+        return false;
+    }
+    // The first events set every input, whatever the netlist starts with.
+    m_inputLog.clear(m_logInputs.size());
+    for (int input = 0; input < m_logInputs.size(); ++input) {
+        m_inputLog.append(1, input, m_logValues.at(input));
+    }
+    m_recordingInputs = true;
+    return true;
+}
+
+const InputLog &ElementMapping::stopRecording()
+{
+    stopWorker();
+    if (m_recordingInputs) {
+        m_inputLog.setEndTick(m_ticks);
+        m_recordingInputs = false;
+    }
+    return m_inputLog;
+}
+
+bool ElementMapping::isRecording() const
+{
+    return m_recordingInputs;
+}
+
+bool ElementMapping::startReplay(const InputLog &log)
+{
+    if (m_recordingInputs || !setLogInputs() || (log.inputCount() != m_logInputs.size())) {
+        return false;
+    }
+    m_replayLog = log;
+    m_replayReader = InputLog::Reader(&m_replayLog);
+    m_replayingInputs = true;
+    return true;
+}
+
+bool ElementMapping::isReplaying() const
+{
+    return m_replayingInputs;
+}
+
+quint64 ElementMapping::replayEndTick() const
+{
+    return m_replayLog.endTick();
+}
+
+bool ElementMapping::hasWorker() const
+{
+    return m_worker != nullptr;
+}
+
+void ElementMapping::syncWorker()
+{
+    if (!m_worker) {
+        return;
+    }
+    adoptNative();
+    if (Clock::reset) {
+        // A clock was added or its frequency changed: restart the worker with the new schedule.
+        const int tickInterval = m_workerTickInterval;
+        stopWorker();
+        startWorker(tickInterval);
+    }
+    for (int idx = 0; !m_replayingInputs && (idx < m_workerInputs.size()); ++idx) {
+        const bool value = m_workerInputs.at(idx).first->getOn();
+        // A full queue keeps the old value here, so the change is sent again on the next sync.
+        if ((value != m_workerInputValues.at(idx)) && m_worker->setInput(m_workerInputs.at(idx).second, value)) {
+            m_workerInputValues[idx] = value;
+        }
+    }
+    const uint8_t *snapshot = m_worker->acquireSnapshot();
+    // The clocks follow the signals, in the order startWorker() gave them.
+    const uint8_t *clockState = snapshot + m_netlist->signalCount();
+    for (Clock *clk : qAsConst(m_clocks)) {
+        if (clk && m_elementMap.value(clk)) {
+            bool on;
+            int phase;
+            SimulationWorker::restoreClock(clockState, on, phase);
+            if (clk->getOn() != on) {
+                clk->setOn(on);
+            }
+            clk->setElapsed(phase);
+            clockState += SimulationWorker::ClockStateSize;
+        }
+    }
+    // A replay drives the inputs from the worker, so the input elements follow the snapshot like the clocks.
+    for (int idx = 0; m_replayingInputs && (idx < m_workerInputs.size()); ++idx) {
+        const bool value = snapshot[m_workerInputs.at(idx).second];
+        if (m_workerInputs.at(idx).first->getOn() != value) {
+            m_workerInputs.at(idx).first->setOn(value);
+        }
+        m_workerInputValues[idx] = value;
+    }
+}
+
+bool ElementMapping::simulateCombinational(const QVector<GraphicElement *> &inputs, const QVector<QNEInputPort *> &outputPorts, const QVector<QVector<uchar>> &stimulus, QVector<QVector<uchar>> &results) const
+{
+    if (!canRun() || !m_netlist || m_worker || !m_clocks.isEmpty() || !m_netlist->isCombinational()) {
+        return false;
+    }
+    QVector<int> inputSlots;
+    for (GraphicElement *elm : inputs) {
+        LogicElement *logElm = m_elementMap.value(elm);
+        if (!logElm) {
+            return false;
+        }
+        inputSlots.append(m_netlist->outputSlot(logElm));
+    }
+    QVector<int> outputSlots;
+    for (QNEInputPort *port : outputPorts) {
+        LogicElement *logElm = m_elementMap.value(port->graphicElement());
+        if (!logElm || !logElm->isValid()) {
+            return false;
+        }
+        outputSlots.append(m_netlist->inputSlot(logElm, port->index()));
+    }
+    ParallelNetlist parallel(*m_netlist);
+    // Inputs outside the batch keep their current value on every lane.
+    for (auto iter = m_inputMap.cbegin(); iter != m_inputMap.cend(); ++iter) {
+        if (iter.key() && iter.value()) {
+            parallel.setValue(m_netlist->outputSlot(iter.value()), iter.key()->getOn());
+        }
+    }
+    const int columns = stimulus.isEmpty() ? 0 : stimulus.first().size();
+    results = QVector<QVector<uchar>>(outputSlots.size(), QVector<uchar>(columns));
+    for (int first = 0; first < columns; first += ParallelNetlist::Lanes) {
+        const int lanes = qMin(ParallelNetlist::Lanes, columns - first);
+        for (int in = 0; in < inputSlots.size(); ++in) {
+            ParallelNetlist::Word word = 0;
+            for (int lane = 0; lane < lanes; ++lane) {
+                if (stimulus[in][first + lane]) {
+                    word |= ParallelNetlist::Word(1) << lane;
+                }
+            }
+            parallel.setLanes(inputSlots[in], word);
+        }
+        parallel.update();
+        for (int out = 0; out < outputSlots.size(); ++out) {
+            const ParallelNetlist::Word word = parallel.lanes(outputSlots[out]);
+            for (int lane = 0; lane < lanes; ++lane) {
+                results[out][first + lane] = (word >> lane) & 1;
+            }
+        }
+    }
+    return true;
+}
+
+QVector<QNEInputPort *> ElementMapping::outputPorts(const QVector<GraphicElement *> &outputs)
+{
+    QVector<QNEInputPort *> ports;
+    for (GraphicElement *out : outputs) {
+        for (int port = out->inputSize() - 1; port >= 0; --port) {
+            ports.append(out->input(port));
+        }
+    }
+    return ports;
+}
+
+QVector<QVector<uchar>> ElementMapping::truthTable(int inputCount, int columns)
+{
+    QVector<QVector<uchar>> stimulus(inputCount, QVector<uchar>(columns));
+    for (int in = 0; in < inputCount; ++in) {
+        for (int itr = 0; itr < columns; ++itr) {
+            stimulus[in][itr] = (itr >> in) & 1;
+        }
+    }
+    return stimulus;
+}
+
+bool ElementMapping::simulateTimed(const QVector<GraphicElement *> &inputs, const QVector<QNEInputPort *> &outputPorts, const QVector<QVector<uchar>> &stimulus, const QVector<int> &delays, QVector<QVector<uchar>> &results) const
+{
+    if (!canRun() || !m_netlist || m_worker) {
+        return false;
+    }
+    // Folding drops and rewrites gates, and so their delays: the timed netlist takes every gate as drawn.
+    CompiledNetlist netlist(m_logicElms, m_loops);
+    netlist.copyState(*m_netlist);
+    QVector<int> inputSlots;
+    for (GraphicElement *elm : inputs) {
+        LogicElement *logElm = m_elementMap.value(elm);
+        if (!logElm) {
+            return false;
+        }
+        inputSlots.append(netlist.outputSlot(logElm));
+    }
+    QVector<int> outputSlots;
+    for (QNEInputPort *port : outputPorts) {
+        LogicElement *logElm = m_elementMap.value(port->graphicElement());
+        if (!logElm || !logElm->isValid()) {
+            return false;
+        }
+        outputSlots.append(netlist.inputSlot(logElm, port->index()));
+    }
+    TimedNetlist timed(netlist);
+    for (int type = 0; type < qMin(delays.size(), TimedNetlist::TypeCount); ++type) {
+        timed.setDelay(static_cast<LogicType>(type), delays.at(type));
+    }
+    const int columns = stimulus.isEmpty() ? 0 : stimulus.first().size();
+    results = QVector<QVector<uchar>>(outputSlots.size(), QVector<uchar>(columns));
+    for (int col = 0; col < columns; ++col) {
+        // Inputs change at the start of their column and outputs are sampled at its end.
+        timed.advance(static_cast<uint64_t>(col));
+        for (int in = 0; in < inputSlots.size(); ++in) {
+            timed.setValue(inputSlots.at(in), stimulus.at(in).at(col));
+        }
+        timed.advance(static_cast<uint64_t>(col));
+        for (int out = 0; out < outputSlots.size(); ++out) {
+            results[out][col] = timed.value(outputSlots.at(out));
+        }
+    }
+    return true;
+}
+
 bool ElementMapping::canRun() const
 {
     return m_initialized;
@@ -311,38 +1280,99 @@ void ElementMapping::validateElements()
 
 void ElementMapping::sortLogicElements()
 {
-    for (LogicElement *elm : qAsConst(m_logicElms)) {
-        elm->calculatePriority();
-    }
-    std::sort(m_logicElms.begin(), m_logicElms.end(), [](LogicElement *e1, LogicElement *e2) {
-        return *e2 < *e1;
-    });
+    m_loopHead.clear();
+    schedule(m_logicElms);
+    orderLogicElements();
 }
 
-int ElementMapping::calculatePriority(GraphicElement *elm, QHash<GraphicElement *, bool> &beingvisited, QHash<GraphicElement *, int> &priority)
+void ElementMapping::updatePriorities(const QVector<LogicElement *> &changed)
 {
-    if (!elm) {
-        return 0;
+    // A priority only depends on the successors, so an edit can only move the priorities of its fan-in cone.
+    // A loop through a changed element lies entirely in that cone, so loops are found again as well.
+    QSet<LogicElement *> visited;
+    QVector<LogicElement *> cone;
+    QVector<LogicElement *> pending = changed;
+    while (!pending.isEmpty()) {
+        LogicElement *elm = pending.takeLast();
+        if (visited.contains(elm)) {
+            continue;
+        }
+        visited.insert(elm);
+        cone.append(elm);
+        for (size_t in = 0; in < elm->inputSize(); ++in) {
+            if (elm->predecessor(in)) {
+                pending.append(elm->predecessor(in));
+            }
+        }
     }
-    if (beingvisited.contains(elm) && (beingvisited[elm])) {
-        return 0;
+    schedule(cone);
+    orderLogicElements();
+}
+
+void ElementMapping::schedule(const QVector<LogicElement *> &elms)
+{
+    QHash<LogicElement *, int> index;
+    for (int node = 0; node < elms.size(); ++node) {
+        index.insert(elms.at(node), node);
     }
-    if (priority.contains(elm)) {
-        return priority[elm];
+    SccScheduler scheduler(elms.size());
+    for (int node = 0; node < elms.size(); ++node) {
+        LogicElement *elm = elms.at(node);
+        scheduler.setCutsLoops(node, cutsLoops(elm->type()));
+        for (LogicElement *succ : elm->successors()) {
+            const int target = index.value(succ, -1);
+            if (target != -1) {
+                scheduler.addEdge(node, target);
+            } else {
+                // Successors left out keep their priority.
+                scheduler.raiseBase(node, succ->priority() + 1);
+            }
+        }
     }
-    beingvisited[elm] = true;
-    int max = 0;
-    auto const elm_outputs = elm->outputs();
-    for (QNEPort *port : elm_outputs) {
-        for (QNEConnection *conn : port->connections()) {
-            QNEPort *successor = conn->otherPort(port);
-            if (successor) {
-                max = qMax(calculatePriority(successor->graphicElement(), beingvisited, priority), max);
+    scheduler.run();
+    QVector<LogicElement *> heads(scheduler.loopCount(), nullptr);
+    for (int node = 0; node < elms.size(); ++node) {
+        LogicElement *elm = elms.at(node);
+        elm->setPriority(scheduler.priority(node));
+        m_loopHead.remove(elm);
+        const int loop = scheduler.loop(node);
+        if (loop != -1) {
+            if (!heads.at(loop)) {
+                heads[loop] = elm;
             }
+            m_loopHead.insert(elm, heads.at(loop));
+        }
+    }
+}
+
+void ElementMapping::orderLogicElements()
+{
+    // Higher priorities first. Members of a loop share their priority and stay together, in their previous order.
+    QHash<LogicElement *, int> rank;
+    for (int idx = 0; idx < m_logicElms.size(); ++idx) {
+        rank.insert(m_logicElms.at(idx), idx);
+    }
+    QHash<LogicElement *, int> group;
+    for (LogicElement *elm : qAsConst(m_logicElms)) {
+        group.insert(elm, rank.value(m_loopHead.value(elm, elm)));
+    }
+    std::stable_sort(m_logicElms.begin(), m_logicElms.end(), [&group](LogicElement *e1, LogicElement *e2) {
+        if (e1->priority() != e2->priority()) {
+            return e2->priority() < e1->priority();
+        }
+        return group.value(e1) < group.value(e2);
+    });
+    m_loops.clear();
+    for (int idx = 0; idx < m_logicElms.size();) {
+        LogicElement *head = m_loopHead.value(m_logicElms.at(idx), nullptr);
+        if (!head) {
+            ++idx;
+            continue;
+        }
+        QVector<LogicElement *> loop;
+        while ((idx < m_logicElms.size()) && (m_loopHead.value(m_logicElms.at(idx), nullptr) == head)) {
+            loop.append(m_logicElms.at(idx++));
         }
+        m_loops.append(loop);
     }
-    int p = max + 1;
-    priority[elm] = p;
-    beingvisited[elm] = false;
-    return p;
 }
@@ -8,15 +8,23 @@
 
 #include <QHash>
 #include <QMap>
+#include <QSet>
 
+#include "compilednetlist.h"
+#include "inputlog.h"
 #include "logicelement/logicinput.h"
+#include "statehistory.h"
 
 class Clock;
 class GraphicElement;
 class IC;
+class NativeCompiler;
 class Input;
 class LogicElement;
+class QNEInputPort;
 class QNEPort;
+class SimulationWorker;
+class WorkerPool;
 
 class ElementMapping;
 class ICMapping;
@@ -38,9 +46,153 @@ public:
     void sort();
 
     void update();
+    //! One tick of the reference LogicElement graph, settling its combinational loops like the compiled netlist.
+    void updateLogicElements();
+
+    /**
+     * @brief Drops the logic of elements about to be deleted from the scene. Their neighbors are rewired by
+     * the next patch(), which must come before anything else uses the mapping.
+     */
+    void removeElements(const QVector<GraphicElement *> &elements);
+    //! Marks elements added to the scene or whose input wires changed, for the next patch().
+    void markRewired(const QVector<GraphicElement *> &elements);
+    /**
+     * @brief Applies the removals and rewires reported since the last patch to the live simulation layer.
+     * New elements are built, marked ones reconnected, and priorities recomputed only over the fan-in cone of
+     * what changed. The netlist is then recompiled keeping the signals and flip-flop state of every other element.
+     * @param elements All the elements now in the scene.
+     * @return false when the scene changed in a way that was not reported; the mapping must then be rebuilt.
+     */
+    bool patch(const QVector<GraphicElement *> &elements);
 
     ICMapping *getICMapping(IC *ic) const;
     LogicElement *getLogicElement(GraphicElement *elm) const;
+    //! Logic elements in evaluation order, once sorted.
+    const QVector<LogicElement *> &logicElements() const;
+    //! Combinational loops, each a run of consecutive logicElements() evaluated until it settles.
+    const QVector<QVector<LogicElement *>> &loops() const;
+    //! Inputs the netlist folds as constants: the ones the user cannot change.
+    QSet<const LogicElement *> constantElements() const;
+    //! Elements the netlist keeps evaluated: what the scene shows, and what observe() asked for.
+    QSet<const LogicElement *> observedElements() const;
+
+    /**
+     * @brief Keeps elm evaluated although nothing in the scene shows its outputs, e.g. for a probe. The netlist
+     * only evaluates what output elements and wires show, so when elm was pruned it is rebuilt like by patch().
+     */
+    void observe(LogicElement *elm);
+    //! Observes every element of elms, with a single rebuild.
+    void observe(const QVector<LogicElement *> &elms);
+    //! Lets elm be pruned again by the next rebuild, once nothing shows it.
+    void unobserve(LogicElement *elm);
+    //! True when elm is not evaluated, see CompiledNetlist::isPruned().
+    bool isPruned(LogicElement *elm) const;
+
+    //! Current simulated values. Reads the compiled netlist once it is available.
+    bool getOutputValue(LogicElement *elm, int port = 0) const;
+    bool getInputValue(LogicElement *elm, int port = 0) const;
+    //! Signals read by getOutputValue() and getInputValue(), indexed by slot; nullptr without a compiled netlist.
+    const uint8_t *signalData() const;
+    //! Slots read by getOutputValue() and getInputValue(), -1 without a compiled netlist.
+    int outputSlot(LogicElement *elm, int port = 0) const;
+    int inputSlot(LogicElement *elm, int port = 0) const;
+    /**
+     * @brief Fills changed with the slots whose value changed since the last call, in the values read by
+     * getOutputValue(). Returns false, with no slots, when there is nothing to compare to: on the first call after
+     * the netlist was compiled, or without one. Everything must then be read again.
+     */
+    bool takeChangedSlots(QVector<int> &changed);
+
+    //! Selects event-driven evaluation of the compiled netlist instead of a full sweep every tick.
+    void setEventDriven(bool eventDriven);
+    quint64 evaluationCount() const;
+    quint64 skippedEvaluationCount() const;
+
+    /**
+     * @brief Requests the native backend: the netlist is compiled to machine code when a C++ compiler is
+     * available. The build runs in the background; the interpreter keeps running until update() or
+     * syncWorker() find it finished.
+     */
+    void setNative(bool native);
+    //! True when the native backend is actually in use, i.e. not while the module is being built.
+    bool isNative() const;
+
+    //! Merges duplicated gates when compiling, see CompiledNetlist. A running netlist is rebuilt like by patch().
+    void setStructuralHashing(bool hashing);
+    //! Threads the netlists compiled from now on sweep their levels with, when large enough. Not owned.
+    void setWorkerPool(WorkerPool *pool);
+    //! Gates of the circuit, and gates the netlist evaluates once folded, collapsed, pruned and merged.
+    int sourceGateCount() const;
+    int gateCount() const;
+
+    /**
+     * @brief Evaluates a batch of input vectors, 64 per sweep, on a purely combinational circuit.
+     * The columns do not depend on each other, so the waveforms get them all without setting the inputs
+     * and updating the scene once per column.
+     * @param outputPorts The rows of results, see outputPorts().
+     * @param stimulus One row per input, one column per input vector, see truthTable().
+     * @param results Receives one row per output port, one column per input vector.
+     * @return false, leaving results untouched, when the circuit has clocks, memory or feedback.
+     */
+    bool simulateCombinational(const QVector<GraphicElement *> &inputs, const QVector<QNEInputPort *> &outputPorts, const QVector<QVector<uchar>> &stimulus, QVector<QVector<uchar>> &results) const;
+    //! Input ports of the output elements, as the waveforms list them: elements in order, ports from the last to the first.
+    static QVector<QNEInputPort *> outputPorts(const QVector<GraphicElement *> &outputs);
+    //! Every combination of inputCount inputs: row in holds bit in of the column number.
+    static QVector<QVector<uchar>> truthTable(int inputCount, int columns);
+
+    /**
+     * @brief Runs a waveform with propagation delays on a TimedNetlist, one delay unit per column.
+     * @param delays Delay of every LogicType, by index; missing entries keep TimedNetlist::defaultDelay().
+     * @return false, leaving results untouched, when the circuit cannot be simulated.
+     */
+    bool simulateTimed(const QVector<GraphicElement *> &inputs, const QVector<QNEInputPort *> &outputPorts, const QVector<QVector<uchar>> &stimulus, const QVector<int> &delays, QVector<QVector<uchar>> &results) const;
+
+    /**
+     * @brief Moves the ticks to a SimulationWorker thread, which owns the compiled netlist until stopWorker().
+     * While it runs, update() does nothing and values are read from the snapshot taken by syncWorker().
+     */
+    void startWorker(int tickInterval);
+    void stopWorker();
+    bool hasWorker() const;
+    //! GUI side of the worker: sends the input changes and takes the latest snapshot.
+    void syncWorker();
+    //! Ticks per tick interval of the worker, see SimulationWorker::setSpeed().
+    void setSpeed(int speed);
+    //! Ticks run since the mapping was built, by update() and by the worker.
+    quint64 tickCount() const;
+
+    /**
+     * @brief Recorded states: the compiled netlist and the clocks, every historyInterval() ticks, whether the
+     * ticks run on update() or on the worker. Rebuilding the netlist starts a new history.
+     */
+    const StateHistory &history() const;
+    int historyInterval() const;
+    //! Ticks between two recorded states; 0 stops recording. A running worker takes it on its next start.
+    void setHistoryInterval(int interval);
+    static constexpr int DefaultHistoryInterval = 64;
+    /**
+     * @brief Goes back (negative steps) or forward through the recorded states, restoring the netlist, the
+     * clocks, the inputs and the tick count. Stops the worker. Returns false when there is nothing to go to.
+     */
+    bool stepHistory(int steps);
+
+    /**
+     * @brief Records every input change, whether the ticks run on update() or on the worker. Only a freshly
+     * built mapping can record, so the log replays from the same state; rebuilding the netlist or stepping
+     * through the history ends the recording. Returns false when the mapping already ran.
+     */
+    bool startRecording();
+    //! Ends the recording at the current tick. Stops the worker.
+    const InputLog &stopRecording();
+    bool isRecording() const;
+    /**
+     * @brief Drives the inputs from a log recorded on the same circuit: each change is applied on its tick, and
+     * the input elements follow. Like startRecording(), it needs a freshly built mapping.
+     */
+    bool startReplay(const InputLog &log);
+    bool isReplaying() const;
+    //! Last tick of the replayed log.
+    quint64 replayEndTick() const;
 
     bool canRun() const;
     bool canInitialize() const;
@@ -55,11 +207,61 @@ protected:
     QVector<GraphicElement *> m_elements;
     QMap<IC *, ICMapping *> m_icMappings;
     QVector<LogicElement *> m_logicElms;
+    QVector<QVector<LogicElement *>> m_loops;
+    //! Elements of a combinational loop, mapped to the member that keeps the loop together when sorting.
+    QHash<LogicElement *, LogicElement *> m_loopHead;
 
     LogicInput m_globalGND;
     LogicInput m_globalVCC;
 
     QVector<LogicElement *> m_deletableElements;
+    //! Elements kept evaluated by observe().
+    QSet<LogicElement *> m_observed;
+
+    CompiledNetlist *m_netlist;
+    //! Threads of the levelized sweep, see setWorkerPool().
+    WorkerPool *m_pool;
+    //! Signals as of the last takeChangedSlots(), valid when m_signalsShown.
+    std::vector<uint8_t> m_shownSignals;
+    bool m_signalsShown;
+    bool m_eventDriven;
+    bool m_native;
+    //! Build of the native module of m_netlist, until it is finished.
+    NativeCompiler *m_nativeBuild;
+    bool m_structuralHashing;
+
+    SimulationWorker *m_worker;
+    int m_workerTickInterval;
+    int m_speed;
+    quint64 m_ticks;
+    //! Inputs driven through the worker queue (clocks run inside the worker) and the last value sent.
+    QVector<QPair<Input *, int>> m_workerInputs;
+    QVector<bool> m_workerInputValues;
+
+    StateHistory m_history;
+    int m_historyInterval;
+    //! Tick of the last state recorded on this timeline, valid when m_recorded.
+    quint64 m_lastRecord;
+    bool m_recorded;
+    std::vector<uint8_t> m_stateVector;
+
+    /* Input logs: the inputs in log order, with their slot and the last value recorded. */
+    QVector<Input *> m_logInputs;
+    QVector<int> m_logSlots;
+    QVector<bool> m_logValues;
+    InputLog m_inputLog;
+    bool m_recordingInputs;
+    InputLog m_replayLog;
+    InputLog::Reader m_replayReader;
+    bool m_replayingInputs;
+
+    /* Pending patch: elements to reconnect, elements that lost successors, and the logic of removed elements,
+     * deleted only once the new netlist took the state of the old one. */
+    QSet<GraphicElement *> m_rewired;
+    QSet<LogicElement *> m_staleElements;
+    QVector<LogicElement *> m_retiredElements;
+    QVector<ICMapping *> m_retiredMappings;
+    bool m_restartWorker;
 
     // Methods
     LogicElement *buildLogicElement(GraphicElement *elm);
@@ -70,7 +272,19 @@ protected:
     void connectElements();
     void validateElements();
     void sortLogicElements();
-    static int calculatePriority(GraphicElement *elm, QHash<GraphicElement *, bool> &beingvisited, QHash<GraphicElement *, int> &priority);
+    void updatePriorities(const QVector<LogicElement *> &changed);
+    void schedule(const QVector<LogicElement *> &elms);
+    void orderLogicElements();
+    void compile();
+    //! Compiles again, keeping the state of the current netlist. A running worker is restarted.
+    void recompile();
+    //! Switches to the native module once its build is finished.
+    void adoptNative();
+    //! Sets the native update function of the netlist, restarting a running worker around the change.
+    void setNativeUpdate(CompiledNetlist::NativeUpdate update);
+    void recordState();
+    //! Fills the log inputs; false when the mapping cannot be logged.
+    bool setLogInputs();
     void insertElement(GraphicElement *elm);
     void insertIC(IC *ic);
 };
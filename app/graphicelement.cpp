@@ -5,6 +5,7 @@
 #include <stdexcept>
 
 #include <QFileInfo>
+#include <QHash>
 #include <QKeyEvent>
 #include <QPainter>
 #include <QStyleOptionGraphicsItem>
@@ -12,13 +13,93 @@
 
 #include "common.h"
 #include "graphicelement.h"
+#include "graphicsviewzoom.h"
 #include "nodes/qneconnection.h"
 #include "nodes/qneport.h"
 #include "scene.h"
 #include "thememanager.h"
 
+namespace
+{
+/* Skins are interned: an element keeps the index of its skin, and the pixmap of each theme is loaded once for
+ * every element showing it. */
+struct Skin {
+    QString name;
+    //! Part of the file kept, the whole pixmap when null.
+    QRect size;
+    //! Loaded pixmap of each theme slot, see themeSlot().
+    QPixmap *pixmaps[3];
+};
+
 // TODO - WARNING: non-POD static
-static QMap<QString, QPixmap> loadedPixmaps;
+QMap<QString, QPixmap> loadedPixmaps;
+QVector<Skin> skins;
+QHash<QString, int> skinIds;
+
+//! 0 without a theme manager, then one slot per Theme.
+int themeSlot()
+{
+    return ThemeManager::globalMngr ? 1 + static_cast<int>(ThemeManager::globalMngr->theme()) : 0;
+}
+
+int internSkin(const QString &name, const QRect &size)
+{
+    auto it = skinIds.constFind(name);
+    if (it != skinIds.constEnd()) {
+        return it.value();
+    }
+    skins.append({name, size, {nullptr, nullptr, nullptr}});
+    skinIds.insert(name, skins.size() - 1);
+    return skins.size() - 1;
+}
+
+QPixmap *skinPixmap(int skin)
+{
+    Skin &entry = skins[skin];
+    const int slot = themeSlot();
+    if (!entry.pixmaps[slot]) {
+        QString pixmapPath = entry.name;
+        if ((slot != 0) && pixmapPath.contains("memory")) {
+            switch (ThemeManager::globalMngr->theme()) {
+            case Theme::Panda_Light:
+                pixmapPath.replace("memory", "memory/light");
+                break;
+            case Theme::Panda_Dark:
+                pixmapPath.replace("memory", "memory/dark");
+                break;
+            }
+        }
+        if (!loadedPixmaps.contains(pixmapPath)) {
+            // TODO: use QPixmap::loadFromData() here
+            QPixmap pixmap;
+            if (!pixmap.load(pixmapPath)) {
+                std::cerr << "Problem loading pixmapPath = " << pixmapPath.toStdString() << '\n';
+                throw std::runtime_error(ERRORMSG("Couldn't load pixmap."));
+            }
+            loadedPixmaps[pixmapPath] = entry.size.isNull() ? pixmap : pixmap.copy(entry.size);
+        }
+        entry.pixmaps[slot] = &loadedPixmaps[pixmapPath];
+    }
+    return entry.pixmaps[slot];
+}
+
+//! Label text is unreadable when zoomed out, and the most expensive thing an element draws.
+class ElementLabel : public QGraphicsTextItem
+{
+public:
+    explicit ElementLabel(QGraphicsItem *parent)
+        : QGraphicsTextItem(parent)
+    {
+    }
+
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override
+    {
+        if (GraphicsViewZoom::showsDetails(painter)) {
+            QGraphicsTextItem::paint(painter, option, widget);
+        }
+    }
+};
+}
 
 GraphicElement::GraphicElement(
     ElementType type,
@@ -30,7 +111,8 @@ GraphicElement::GraphicElement(
     QGraphicsItem *parent):
     QGraphicsObject(parent)
     , m_pixmap(nullptr)
-    , m_label(new QGraphicsTextItem(this))
+    , m_skin(-1)
+    , m_label(new ElementLabel(this))
     , m_topPosition(0)
     , m_bottomPosition(64)
     , m_maxInputSz(maxInputSz)
@@ -100,64 +182,24 @@ void GraphicElement::enable()
 
 void GraphicElement::setPixmap(const QString &pixmapName)
 {
-    QString pixmapPath = pixmapName;
-    if (ThemeManager::globalMngr) { // TODO: This has to be changed. Not a good way to do it. Probably better inside the class.
-        if (pixmapPath.contains("memory")) {
-            switch (ThemeManager::globalMngr->theme()) {
-            case Theme::Panda_Light:
-                pixmapPath.replace("memory", "memory/light");
-                break;
-            case Theme::Panda_Dark:
-                pixmapPath.replace("memory", "memory/dark");
-                break;
-            }
-        }
-    }
-    if (pixmapPath != m_currentPixmapName) {
-        if (!loadedPixmaps.contains(pixmapPath)) {
-            // TODO: use QPixmap::loadFromData() here
-
-            if (!loadedPixmaps[pixmapPath].load(pixmapPath)) {
-                std::cerr << "Problem loading pixmapPath = " << pixmapPath.toStdString() << '\n';
-                throw std::runtime_error(ERRORMSG("Couldn't load pixmap."));
-            }
-        }
-        m_pixmap = &loadedPixmaps[pixmapPath];
-        setTransformOriginPoint(m_pixmap->rect().center());
-        update(boundingRect());
-    }
-    m_currentPixmapName = pixmapName;
+    showSkin(internSkin(pixmapName, QRect()));
 }
 
 void GraphicElement::setPixmap(const QString &pixmapName, QRect size)
 {
-    QString pixmapPath = pixmapName;
-    if (ThemeManager::globalMngr) { // TODO: This has to be changed. Not a good way to do it. Probably better inside the class.
-        if (pixmapPath.contains("memory")) {
-            switch (ThemeManager::globalMngr->theme()) {
-            case Theme::Panda_Light:
-                pixmapPath.replace("memory", "memory/light");
-                break;
-            case Theme::Panda_Dark:
-                pixmapPath.replace("memory", "memory/dark");
-                break;
-            }
-        }
-    }
-    if (pixmapPath != m_currentPixmapName) {
-        if (!loadedPixmaps.contains(pixmapPath)) {
-            // TODO: use QPixmap::loadFromData() here
-            QPixmap pixmap;
-            if (!pixmap.load(pixmapPath)) {
-                throw std::runtime_error(ERRORMSG("Couldn't load pixmap."));
-            }
-            loadedPixmaps[pixmapPath] = pixmap.copy(size);
-        }
-        m_pixmap = &loadedPixmaps[pixmapPath];
+    showSkin(internSkin(pixmapName, size));
+}
+
+void GraphicElement::showSkin(int skin)
+{
+    QPixmap *pixmap = skinPixmap(skin);
+    m_skin = skin;
+    if (pixmap != m_pixmap) {
+        m_pixmap = pixmap;
         setTransformOriginPoint(m_pixmap->rect().center());
         update(boundingRect());
+        RepaintCounter::countRepaint();
     }
-    m_currentPixmapName = pixmapName;
 }
 
 QVector<QNEOutputPort *> GraphicElement::outputs() const
@@ -460,6 +502,24 @@ void GraphicElement::setInputs(const QVector<QNEInputPort *> &inputs)
     m_inputs = inputs;
 }
 
+const QNEPort *GraphicElement::statePort() const
+{
+    return m_outputs.isEmpty() ? (m_inputs.isEmpty() ? nullptr : m_inputs.first()) : m_outputs.first();
+}
+
+QColor GraphicElement::stateColor() const
+{
+    const QNEPort *port = statePort();
+    if (!port || !ThemeManager::globalMngr) {
+        return Qt::gray;
+    }
+    const ThemeAttrs &attrs = ThemeManager::globalMngr->getAttrs();
+    if (port->value() == -1) {
+        return attrs.qneConnection_invalid;
+    }
+    return (port->value() == 1) ? attrs.qneConnection_true : attrs.qneConnection_false;
+}
+
 QRectF GraphicElement::boundingRect() const
 {
     return m_pixmap->rect();
@@ -469,12 +529,17 @@ void GraphicElement::paint(QPainter *painter, const QStyleOptionGraphicsItem *op
 {
     Q_UNUSED(widget)
     painter->setClipRect(option->exposedRect);
+    if (!GraphicsViewZoom::showsDetails(painter)) {
+        // A few pixels wide, the pixmap reads no better than a block in the color of the element's state.
+        painter->fillRect(boundingRect(), isSelected() ? m_selectionPen : stateColor());
+        return;
+    }
     if (isSelected()) {
         painter->setBrush(m_selectionBrush);
         painter->setPen(QPen(m_selectionPen, 0.5, Qt::SolidLine));
         painter->drawRoundedRect(boundingRect(), 5, 5);
     }
-    painter->drawPixmap(QPoint(0, 0), getPixmap());
+    painter->drawPixmap(QPoint(0, 0), *m_pixmap);
 }
 
 QNEPort *GraphicElement::addPort(const QString &name, bool isOutput, int flags, int ptr)
@@ -658,7 +723,9 @@ void GraphicElement::updateTheme()
         }
         updateThemeLocal();
 
-        setPixmap(m_currentPixmapName);
+        if (m_skin != -1) {
+            showSkin(m_skin);
+        }
         update();
     }
 }
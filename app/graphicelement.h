@@ -184,12 +184,20 @@ public:
     void updateLabel();
     void updateSkinsPath(const QString &newSkinPath);
 
+    //! Port whose value colors the block drawn when zoomed out: the first output, or the first input of an output element.
+    const QNEPort *statePort() const;
+
 private:
+    QColor stateColor() const;
+    //! Shows an interned skin: once its pixmap is loaded, this only swaps a pointer.
+    void showSkin(int skin);
+
     /**
      * @brief Current pixmap displayed for this GraphicElement.
      */
     QPixmap *m_pixmap;
-    QString m_currentPixmapName;
+    //! Interned skin shown, -1 before the first setPixmap().
+    int m_skin;
     QColor m_selectionBrush;
     QColor m_selectionPen;
     QGraphicsTextItem *m_label;
@@ -8,6 +8,7 @@
 #include <QGraphicsView>
 #include <QMouseEvent>
 #include <QScrollBar>
+#include <QStyleOptionGraphicsItem>
 #include <QtMath>
 
 #define ZOOMFAC 0.1
@@ -22,6 +23,22 @@ GraphicsViewZoom::GraphicsViewZoom(QGraphicsView *view)
     m_zoomFactorBase = 1.0015;
 }
 
+bool GraphicsViewZoom::showsDetails(const QPainter *painter)
+{
+    return QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform()) >= detailZoom;
+}
+
+bool GraphicsViewZoom::showsDetails(const QGraphicsScene *scene)
+{
+    const auto views = scene->views();
+    for (const QGraphicsView *view : views) {
+        if (QStyleOptionGraphicsItem::levelOfDetailFromTransform(view->transform()) < detailZoom) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void GraphicsViewZoom::gentleZoom(double factor)
 {
     QTransform tr = m_view->transform().scale(factor, factor);
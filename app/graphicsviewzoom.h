@@ -9,6 +9,8 @@
 #include <QObject>
 #include <QPointF>
 
+class QGraphicsScene;
+class QPainter;
 /*!
  * This class adds ability to zoom QGraphicsView using mouse wheel. The point under cursor
  * remains motionless while it's possible.
@@ -48,6 +50,11 @@ class GraphicsViewZoom : public QObject
 public:
     static constexpr double maxZoom = 1.5;
     static constexpr double minZoom = 0.2;
+    //! Below this scale, items skip their details: elements are blocks, wires are lines, ports and labels are not drawn.
+    static constexpr double detailZoom = 0.5;
+    static bool showsDetails(const QPainter *painter);
+    //! False when some view of scene draws it below detailZoom.
+    static bool showsDetails(const QGraphicsScene *scene);
     explicit GraphicsViewZoom(QGraphicsView *view);
     void gentleZoom(double factor);
     void setModifiers(Qt::KeyboardModifiers modifiers);
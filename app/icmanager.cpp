@@ -144,6 +144,10 @@ void ICManager::reloadFile(const QString& fileName)
         if (m_ics.contains(bname)) {
             try {
                 m_ics[bname]->reload();
+                // Templates have the inner ICs expanded, so any of them may embed the reloaded one.
+                for (ICPrototype *prototype : qAsConst(m_ics)) {
+                    prototype->clearTemplate();
+                }
             } catch (std::runtime_error &e) {
                 QMessageBox::warning(m_mainWindow, "Error", tr("Error reloading IC: ") + e.what(), QMessageBox::Ok, QMessageBox::NoButton);
             }
@@ -3,6 +3,8 @@
 
 #include "icmapping.h"
 
+#include "ictemplate.h"
+
 ICMapping::ICMapping(const QString &file, const ElementVector &elms, const QNEPortVector &inputs, const QNEPortVector &outputs)
     : ElementMapping(elms, file)
     , m_icInputs(inputs)
@@ -10,6 +12,20 @@ ICMapping::ICMapping(const QString &file, const ElementVector &elms, const QNEPo
 {
 }
 
+ICMapping::ICMapping(const QString &file, const ICTemplate &icTemplate)
+    : ElementMapping(ElementVector(), file)
+{
+    m_logicElms = icTemplate.instantiate(&m_globalGND, &m_globalVCC);
+    m_deletableElements = m_logicElms;
+    for (int index : icTemplate.inputs()) {
+        m_inputs.append(m_logicElms.at(index));
+    }
+    for (int index : icTemplate.outputs()) {
+        m_outputs.append(m_logicElms.at(index));
+    }
+    m_initialized = true;
+}
+
 ICMapping::~ICMapping() = default;
 
 void ICMapping::initialize()
@@ -35,12 +51,12 @@ void ICMapping::clearConnections()
 
 LogicElement *ICMapping::getInput(int index)
 {
-    Q_ASSERT(index < m_icInputs.size());
+    Q_ASSERT(index < m_inputs.size());
     return m_inputs[index];
 }
 
 LogicElement *ICMapping::getOutput(int index)
 {
-    Q_ASSERT(index < m_icOutputs.size());
+    Q_ASSERT(index < m_outputs.size());
     return m_outputs[index];
 }
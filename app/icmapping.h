@@ -10,10 +10,13 @@
 #include "graphicelement.h"
 #include "qneport.h"
 
+class ICTemplate;
 class LogicElement;
 
 class ICMapping : public ElementMapping
 {
+    friend class ICTemplate;
+
 private:
     QNEPortVector m_icInputs;
     QNEPortVector m_icOutputs;
@@ -23,6 +26,8 @@ private:
 
 public:
     ICMapping(const QString &file, const ElementVector &elms, const QNEPortVector &inputs, const QNEPortVector &outputs);
+    //! An instance cloned from the template of its prototype, already initialized.
+    ICMapping(const QString &file, const ICTemplate &icTemplate);
 
     ~ICMapping() override;
 
@@ -83,6 +83,11 @@ ICMapping *ICPrototype::generateMapping() const
     return m_ICImpl.generateMapping(fileName());
 }
 
+void ICPrototype::clearTemplate()
+{
+    m_ICImpl.clearTemplate();
+}
+
 void ICPrototype::clear()
 {
     m_ICImpl.clear();
@@ -40,6 +40,8 @@ public:
     bool isInputRequired(int index);
 
     ICMapping *generateMapping() const;
+    //! Forgets the logic template, e.g. after an IC used inside this one was reloaded.
+    void clearTemplate();
 
 private:
     void clear();
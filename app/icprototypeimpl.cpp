@@ -11,12 +11,19 @@
 #include "ic.h"
 #include "icprototype.h"
 #include "icmapping.h"
+#include "ictemplate.h"
 #include "qneconnection.h"
 #include "qneport.h"
 #include "serializationfunctions.h"
 
+ICPrototypeImpl::ICPrototypeImpl()
+    : m_template(nullptr)
+{
+}
+
 ICPrototypeImpl::~ICPrototypeImpl()
 {
+    delete m_template;
     qDeleteAll(m_elements);
 }
 
@@ -202,6 +209,7 @@ void ICPrototypeImpl::loadItem(QGraphicsItem *item)
 
 void ICPrototypeImpl::clear()
 {
+    clearTemplate();
     m_inputs.clear();
     m_outputs.clear();
     setInputSize(0);
@@ -257,5 +265,16 @@ QNEPort *ICPrototypeImpl::getOutput(int index)
 
 ICMapping *ICPrototypeImpl::generateMapping(const QString &fileName) const
 {
-    return new ICMapping(fileName, m_elements, m_inputs, m_outputs);
+    if (!m_template) {
+        ICMapping mapping(fileName, m_elements, m_inputs, m_outputs);
+        mapping.initialize();
+        m_template = new ICTemplate(mapping);
+    }
+    return new ICMapping(fileName, *m_template);
+}
+
+void ICPrototypeImpl::clearTemplate()
+{
+    delete m_template;
+    m_template = nullptr;
 }
@@ -12,10 +12,12 @@ class GraphicElement;
 class QGraphicsItem;
 class QNEPort;
 class ICMapping;
+class ICTemplate;
 
 class ICPrototypeImpl
 {
 public:
+    ICPrototypeImpl();
     ~ICPrototypeImpl();
     void loadFile(const QString &fileName);
     void clear();
@@ -34,7 +36,10 @@ public:
     QString getOutputLabel(int index) const;
     QNEPort *getInput(int index);
     QNEPort *getOutput(int index);
+    //! Clones the template of the IC, which is recorded from the elements on the first call.
     ICMapping *generateMapping(const QString &fileName) const;
+    //! Drops the template, so the next generateMapping() records it again.
+    void clearTemplate();
 
 private:
     void sortPorts(QVector<QNEPort *> &map);
@@ -48,6 +53,8 @@ private:
 
     QVector<QNEPort *> m_inputs;
     QVector<QNEPort *> m_outputs;
+
+    mutable ICTemplate *m_template;
 };
 
 #endif // ICPROTOTYPEIMPL_H
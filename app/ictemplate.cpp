@@ -0,0 +1,146 @@
+// Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "ictemplate.h"
+
+#include <QHash>
+
+#include "icmapping.h"
+
+#include "logicelement/logicand.h"
+#include "logicelement/logicdemux.h"
+#include "logicelement/logicdflipflop.h"
+#include "logicelement/logicdlatch.h"
+#include "logicelement/logicinput.h"
+#include "logicelement/logicjkflipflop.h"
+#include "logicelement/logicmux.h"
+#include "logicelement/logicnand.h"
+#include "logicelement/logicnode.h"
+#include "logicelement/logicnor.h"
+#include "logicelement/logicnot.h"
+#include "logicelement/logicor.h"
+#include "logicelement/logicoutput.h"
+#include "logicelement/logicsrflipflop.h"
+#include "logicelement/logictflipflop.h"
+#include "logicelement/logicxnor.h"
+#include "logicelement/logicxor.h"
+
+ICTemplate::ICTemplate(const ICMapping &mapping)
+{
+    const QVector<LogicElement *> &elms = mapping.m_logicElms;
+    QHash<const LogicElement *, int> index;
+    for (int elm = 0; elm < elms.size(); ++elm) {
+        index.insert(elms.at(elm), elm);
+    }
+    m_inputBegin.push_back(0);
+    m_outputBegin.push_back(0);
+    for (const LogicElement *elm : elms) {
+        m_types.push_back(elm->type());
+        for (size_t in = 0; in < elm->inputSize(); ++in) {
+            const LogicElement *pred = elm->predecessor(in);
+            int source = Unconnected;
+            if (pred) {
+                // Anything outside the element list is one of the GND/VCC constants of a (nested) mapping.
+                source = index.value(pred, pred->getOutputValue() ? Vcc : Ground);
+            }
+            m_predecessors.emplace_back(source, pred ? elm->predecessorPort(in) : 0);
+        }
+        for (size_t out = 0; out < elm->outputSize(); ++out) {
+            m_outputValues.push_back(elm->getOutputValue(out));
+        }
+        m_inputBegin.push_back(static_cast<int>(m_predecessors.size()));
+        m_outputBegin.push_back(static_cast<int>(m_outputValues.size()));
+    }
+    for (const LogicElement *elm : mapping.m_inputs) {
+        m_inputs.append(index.value(elm));
+    }
+    for (const LogicElement *elm : mapping.m_outputs) {
+        m_outputs.append(index.value(elm));
+    }
+}
+
+QVector<LogicElement *> ICTemplate::instantiate(LogicElement *gnd, LogicElement *vcc) const
+{
+    QVector<LogicElement *> elms(elementCount());
+    for (int elm = 0; elm < elementCount(); ++elm) {
+        elms[elm] = create(m_types[elm], m_inputBegin[elm + 1] - m_inputBegin[elm]);
+        for (int out = m_outputBegin[elm]; out < m_outputBegin[elm + 1]; ++out) {
+            elms[elm]->setOutputValue(out - m_outputBegin[elm], m_outputValues[out]);
+        }
+    }
+    for (int elm = 0; elm < elementCount(); ++elm) {
+        for (int in = m_inputBegin[elm]; in < m_inputBegin[elm + 1]; ++in) {
+            const std::pair<int, int> &pred = m_predecessors[in];
+            switch (pred.first) {
+            case Unconnected:
+                break;
+            case Ground:
+                elms[elm]->connectPredecessor(in - m_inputBegin[elm], gnd, 0);
+                break;
+            case Vcc:
+                elms[elm]->connectPredecessor(in - m_inputBegin[elm], vcc, 0);
+                break;
+            default:
+                elms[elm]->connectPredecessor(in - m_inputBegin[elm], elms[pred.first], pred.second);
+                break;
+            }
+        }
+    }
+    return elms;
+}
+
+int ICTemplate::elementCount() const
+{
+    return static_cast<int>(m_types.size());
+}
+
+const QVector<int> &ICTemplate::inputs() const
+{
+    return m_inputs;
+}
+
+const QVector<int> &ICTemplate::outputs() const
+{
+    return m_outputs;
+}
+
+LogicElement *ICTemplate::create(LogicType type, size_t inputSize)
+{
+    switch (type) {
+    case LogicType::INPUT:
+        return new LogicInput();
+    case LogicType::OUTPUT:
+        return new LogicOutput(inputSize);
+    case LogicType::NODE:
+        return new LogicNode();
+    case LogicType::AND:
+        return new LogicAnd(inputSize);
+    case LogicType::OR:
+        return new LogicOr(inputSize);
+    case LogicType::NAND:
+        return new LogicNand(inputSize);
+    case LogicType::NOR:
+        return new LogicNor(inputSize);
+    case LogicType::XOR:
+        return new LogicXor(inputSize);
+    case LogicType::XNOR:
+        return new LogicXnor(inputSize);
+    case LogicType::NOT:
+        return new LogicNot();
+    case LogicType::JKFLIPFLOP:
+        return new LogicJKFlipFlop();
+    case LogicType::SRFLIPFLOP:
+        return new LogicSRFlipFlop();
+    case LogicType::TFLIPFLOP:
+        return new LogicTFlipFlop();
+    case LogicType::DFLIPFLOP:
+        return new LogicDFlipFlop();
+    case LogicType::DLATCH:
+        return new LogicDLatch();
+    case LogicType::MUX:
+        return new LogicMux();
+    case LogicType::DEMUX:
+        return new LogicDemux();
+    }
+    return nullptr;
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef ICTEMPLATE_H
+#define ICTEMPLATE_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <QVector>
+
+#include "logicelement.h"
+
+class ICMapping;
+
+/**
+ * @brief The ICTemplate class is the logic of an IC prototype, recorded once and cloned for every instance.
+ *
+ * Elements are stored by index with inner ICs already expanded, and predecessors refer to other elements by
+ * index or to the GND/VCC constants. An instance is then made in one pass over flat arrays: the elements are
+ * created in order and each predecessor index is relocated to the element cloned at that position, without
+ * going through the graphic elements and ports of the prototype again.
+ */
+class ICTemplate
+{
+public:
+    //! Records the logic of a freshly initialized mapping, built from the graphic elements of the prototype.
+    explicit ICTemplate(const ICMapping &mapping);
+
+    //! Clones the elements, in template order; constant predecessors are connected to gnd and vcc.
+    QVector<LogicElement *> instantiate(LogicElement *gnd, LogicElement *vcc) const;
+
+    int elementCount() const;
+    //! Indices of the elements behind the input and output ports of the IC.
+    const QVector<int> &inputs() const;
+    const QVector<int> &outputs() const;
+
+private:
+    enum Predecessor : int {
+        Unconnected = -1,
+        Ground = -2,
+        Vcc = -3,
+    };
+
+    static LogicElement *create(LogicType type, size_t inputSize);
+
+    std::vector<LogicType> m_types;
+    std::vector<int> m_inputBegin;
+    std::vector<int> m_outputBegin;
+    /* Flattened (element or Predecessor, port) pairs, indexed by m_inputBegin. */
+    std::vector<std::pair<int, int>> m_predecessors;
+    /* Initial outputs, indexed by m_outputBegin. */
+    std::vector<uint8_t> m_outputValues;
+    QVector<int> m_inputs;
+    QVector<int> m_outputs;
+};
+
+#endif // ICTEMPLATE_H
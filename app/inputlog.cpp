@@ -0,0 +1,164 @@
+// Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "inputlog.h"
+
+#include <algorithm>
+#include <climits>
+
+namespace
+{
+const uint8_t Magic[4] = {'W', 'P', 'I', 'L'};
+const uint8_t Version = 1;
+}
+
+InputLog::Reader::Reader(const InputLog *log, quint64 from)
+    : m_log(log)
+    , m_offset(0)
+    , m_event{0, 0, false}
+    , m_atEnd(false)
+{
+    advance();
+    while (!m_atEnd && (m_event.tick < from)) {
+        advance();
+    }
+}
+
+quint64 InputLog::Reader::tick() const
+{
+    return m_atEnd ? End : m_event.tick;
+}
+
+const InputLog::Event &InputLog::Reader::event() const
+{
+    return m_event;
+}
+
+void InputLog::Reader::advance()
+{
+    quint64 gap;
+    quint64 change;
+    if (!m_log || !readVarint(m_log->m_data.data(), m_log->m_data.size(), m_offset, gap)
+        || !readVarint(m_log->m_data.data(), m_log->m_data.size(), m_offset, change)) {
+        m_atEnd = true;
+        return;
+    }
+    m_event.tick += gap;
+    m_event.input = static_cast<int>(change >> 1);
+    m_event.value = change & 1;
+}
+
+InputLog::InputLog(int inputCount)
+{
+    clear(inputCount);
+}
+
+void InputLog::clear(int inputCount)
+{
+    m_inputCount = inputCount;
+    m_count = 0;
+    m_lastTick = 0;
+    m_endTick = 0;
+    m_data.clear();
+}
+
+int InputLog::inputCount() const
+{
+    return m_inputCount;
+}
+
+void InputLog::append(quint64 tick, int input, bool value)
+{
+    Q_ASSERT((tick >= m_lastTick) && (input >= 0) && (input < m_inputCount));
+    writeVarint(m_data, tick - m_lastTick);
+    writeVarint(m_data, (static_cast<quint64>(input) << 1) | (value ? 1 : 0));
+    m_lastTick = tick;
+    m_endTick = std::max(m_endTick, tick);
+    ++m_count;
+}
+
+int InputLog::count() const
+{
+    return m_count;
+}
+
+bool InputLog::isEmpty() const
+{
+    return m_count == 0;
+}
+
+quint64 InputLog::endTick() const
+{
+    return m_endTick;
+}
+
+void InputLog::setEndTick(quint64 tick)
+{
+    m_endTick = std::max(tick, m_lastTick);
+}
+
+std::vector<uint8_t> InputLog::serialize() const
+{
+    std::vector<uint8_t> out(std::begin(Magic), std::end(Magic));
+    out.push_back(Version);
+    writeVarint(out, static_cast<quint64>(m_inputCount));
+    writeVarint(out, static_cast<quint64>(m_count));
+    writeVarint(out, m_endTick);
+    out.insert(out.end(), m_data.cbegin(), m_data.cend());
+    return out;
+}
+
+bool InputLog::deserialize(const uint8_t *data, size_t size)
+{
+    clear(0);
+    size_t offset = sizeof(Magic) + 1;
+    quint64 inputCount;
+    quint64 count;
+    quint64 endTick;
+    if ((size < offset) || !std::equal(std::begin(Magic), std::end(Magic), data) || (data[sizeof(Magic)] != Version)
+        || !readVarint(data, size, offset, inputCount) || !readVarint(data, size, offset, count) || !readVarint(data, size, offset, endTick)
+        || (inputCount > INT_MAX)) {
+        return false;
+    }
+    // Appending again checks every event, so a damaged file is refused instead of replayed halfway.
+    clear(static_cast<int>(inputCount));
+    quint64 tick = 0;
+    for (quint64 event = 0; event < count; ++event) {
+        quint64 gap;
+        quint64 change;
+        if (!readVarint(data, size, offset, gap) || !readVarint(data, size, offset, change) || ((change >> 1) >= inputCount)) {
+            clear(0);
+            return false;
+        }
+        tick += gap;
+        append(tick, static_cast<int>(change >> 1), change & 1);
+    }
+    if (offset != size) {
+        clear(0);
+        return false;
+    }
+    setEndTick(endTick);
+    return true;
+}
+
+void InputLog::writeVarint(std::vector<uint8_t> &out, quint64 value)
+{
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool InputLog::readVarint(const uint8_t *data, size_t size, size_t &offset, quint64 &value)
+{
+    value = 0;
+    for (int shift = 0; (shift < 64) && (offset < size); shift += 7) {
+        const uint8_t byte = data[offset++];
+        value |= static_cast<quint64>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef INPUTLOG_H
+#define INPUTLOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <QtGlobal>
+
+/**
+ * @brief The InputLog class is a recording of the input changes of a simulation, stamped with the tick they
+ * apply at.
+ *
+ * Inputs are numbered by the order of the input elements in the circuit, clocks excluded. A log starts from a
+ * freshly built simulation: its first events set every input, so replaying it on the same circuit goes through
+ * exactly the same states. Each event takes two varints: the ticks since the previous event, then the input
+ * number and value.
+ */
+class InputLog
+{
+public:
+    struct Event {
+        quint64 tick;
+        int input;
+        bool value;
+    };
+
+    //! Reads the events in order, starting with the first one at or after a tick.
+    class Reader
+    {
+    public:
+        explicit Reader(const InputLog *log = nullptr, quint64 from = 0);
+
+        static constexpr quint64 End = ~quint64(0);
+
+        //! Tick of the current event, End after the last one.
+        quint64 tick() const;
+        const Event &event() const;
+        void advance();
+
+    private:
+        const InputLog *m_log;
+        size_t m_offset;
+        Event m_event;
+        bool m_atEnd;
+    };
+
+    explicit InputLog(int inputCount = 0);
+
+    void clear(int inputCount);
+    int inputCount() const;
+    //! Ticks only grow along the log.
+    void append(quint64 tick, int input, bool value);
+    int count() const;
+    bool isEmpty() const;
+
+    //! Last tick of the recording; replaying runs up to it.
+    quint64 endTick() const;
+    void setEndTick(quint64 tick);
+
+    //! The log as a file: a header, then the events.
+    std::vector<uint8_t> serialize() const;
+    //! Takes back a serialized log. Returns false, and leaves the log empty, when the data is not one.
+    bool deserialize(const uint8_t *data, size_t size);
+
+private:
+    static void writeVarint(std::vector<uint8_t> &out, quint64 value);
+    static bool readVarint(const uint8_t *data, size_t size, size_t &offset, quint64 &value);
+
+    int m_inputCount;
+    int m_count;
+    quint64 m_lastTick;
+    quint64 m_endTick;
+    std::vector<uint8_t> m_data;
+};
+
+#endif // INPUTLOG_H
@@ -3,13 +3,55 @@
 
 #include "logicelement.h"
 
+#include "logicelement/logickernels.h"
+
 bool LogicElement::isValid() const
 {
     return m_isValid;
 }
 
+LogicType LogicElement::type() const
+{
+    return m_type;
+}
+
+int LogicElement::priority() const
+{
+    return m_priority;
+}
+
+size_t LogicElement::inputSize() const
+{
+    return m_inputs.size();
+}
+
+size_t LogicElement::outputSize() const
+{
+    return m_outputs.size();
+}
+
+LogicElement *LogicElement::predecessor(size_t index) const
+{
+    return m_inputs.at(index).first;
+}
+
+int LogicElement::predecessorPort(size_t index) const
+{
+    return m_inputs.at(index).second;
+}
+
+const QSet<LogicElement *> &LogicElement::successors() const
+{
+    return m_successors;
+}
+
 void LogicElement::clearPredecessors()
 {
+    for (auto &input : m_inputs) {
+        if (input.first) {
+            input.first->m_successors.remove(this);
+        }
+    }
     std::fill(m_inputs.begin(), m_inputs.end(), std::make_pair(nullptr, 0));
 }
 
@@ -26,28 +68,18 @@ void LogicElement::clearSucessors()
     m_successors.clear();
 }
 
-LogicElement::LogicElement(size_t inputSize, size_t outputSize)
+LogicElement::LogicElement(LogicType type, size_t inputSize, size_t outputSize)
     : m_isValid(true)
-    , m_beingVisited(false)
+    , m_type(type)
     , m_priority(-1)
     , m_inputs(inputSize, std::make_pair(nullptr, 0))
-    , m_inputvalues(inputSize, false)
     , m_outputs(outputSize, false)
+    , m_kernel(LogicKernels::select(type, inputSize))
 {
 }
 
 LogicElement::~LogicElement() = default;
 
-void LogicElement::updateLogic()
-{
-    if (m_isValid) {
-        for (size_t idx = 0; idx < m_inputs.size(); ++idx) {
-            m_inputvalues[idx] = getInputValue(idx);
-        }
-        _updateLogic(m_inputvalues);
-    }
-}
-
 void LogicElement::connectPredecessor(int index, LogicElement *elm, int port)
 {
     m_inputs.at(index) = std::make_pair(elm, port);
@@ -84,23 +116,9 @@ bool LogicElement::operator<(const LogicElement &other) const
     return m_priority < other.m_priority;
 }
 
-int LogicElement::calculatePriority()
+void LogicElement::setPriority(int priority)
 {
-    if (m_beingVisited) {
-        return 0;
-    }
-    if (m_priority != -1) {
-        return m_priority;
-    }
-    m_beingVisited = true;
-    int max = 0;
-    for (LogicElement *s : qAsConst(m_successors)) {
-        max = qMax(s->calculatePriority(), max);
-    }
-    const int p = max + 1;
-    m_priority = p;
-    m_beingVisited = false;
-    return p;
+    m_priority = priority;
 }
 
 bool LogicElement::getOutputValue(size_t index) const
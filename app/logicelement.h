@@ -6,34 +6,76 @@
 #ifndef LOGICELEMENT_H
 #define LOGICELEMENT_H
 
+#include <cstdint>
 #include <vector>
 
 #include <QSet>
 
+enum class LogicType : uint_fast8_t {
+    INPUT,
+    OUTPUT,
+    NODE,
+    AND,
+    OR,
+    NAND,
+    NOR,
+    XOR,
+    XNOR,
+    NOT,
+    JKFLIPFLOP,
+    SRFLIPFLOP,
+    TFLIPFLOP,
+    DFLIPFLOP,
+    DLATCH,
+    MUX,
+    DEMUX
+};
+
 /**
  * @brief The LogicElement class was designed to represent logic
  *        elements in the simulation layer of wiredpanda.
  */
 class LogicElement
 {
+public:
+    //! Computes the outputs of an element from the outputs of its predecessors.
+    typedef void (*Kernel)(LogicElement &elm);
+
 private:
+    friend class LogicKernels;
+
     /**
      * @brief m_isValid is calculated at compilation time.
      */
     bool m_isValid;
-    bool m_beingVisited;
+    LogicType m_type;
     int m_priority;
     std::vector<std::pair<LogicElement *, int>> m_inputs;
-    std::vector<bool> m_inputvalues;
-    std::vector<bool> m_outputs;
+    std::vector<uint8_t> m_outputs;
     QSet<LogicElement *> m_successors;
+    /**
+     * @brief m_kernel is taken from the table of LogicKernels, by type and input count, at construction.
+     */
+    Kernel m_kernel;
 
 protected:
-    // Main function to update the logic of an element. Computes the outputs, given the inputs
-    virtual void _updateLogic(const std::vector<bool> &inputs) = 0;
+    //! Unchecked reads and writes for the kernels: the element is valid, so every predecessor is set.
+    bool inputValue(size_t index) const
+    {
+        const auto &input = m_inputs[index];
+        return input.first->m_outputs[input.second];
+    }
+    bool outputValue(size_t index) const
+    {
+        return m_outputs[index];
+    }
+    void setOutput(size_t index, bool value)
+    {
+        m_outputs[index] = value;
+    }
 
 public:
-    explicit LogicElement(size_t inputSize, size_t outputSize);
+    explicit LogicElement(LogicType type, size_t inputSize, size_t outputSize);
 
     virtual ~LogicElement();
 
@@ -48,16 +90,30 @@ public:
 
     bool operator<(const LogicElement &other) const;
 
-    int calculatePriority();
+    //! Set by ElementMapping, which schedules the whole graph at once (see SccScheduler).
+    void setPriority(int priority);
 
     bool isValid() const;
 
+    LogicType type() const;
+    int priority() const;
+    size_t inputSize() const;
+    size_t outputSize() const;
+    LogicElement *predecessor(size_t index) const;
+    int predecessorPort(size_t index) const;
+    const QSet<LogicElement *> &successors() const;
+
     void clearPredecessors();
 
     void clearSucessors();
 
-    // Secure call to _updateLogic() with current inputs.
-    void updateLogic();
+    // Runs the kernel of the element, if it is valid.
+    void updateLogic()
+    {
+        if (m_isValid) {
+            m_kernel(*this);
+        }
+    }
 };
 
 #endif /* LOGICELEMENT_H */
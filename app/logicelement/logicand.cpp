@@ -4,12 +4,6 @@
 #include "logicand.h"
 
 LogicAnd::LogicAnd(size_t inputSize)
-    : LogicElement(inputSize, 1)
+    : LogicElement(LogicType::AND, inputSize, 1)
 {
-}
-
-void LogicAnd::_updateLogic(const std::vector<bool> &inputs)
-{
-    auto result = std::accumulate(inputs.begin(), inputs.end(), true, std::bit_and<bool>());
-    setOutputValue(result);
 }
\ No newline at end of file
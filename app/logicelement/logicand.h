@@ -12,10 +12,6 @@ class LogicAnd : public LogicElement
 {
 public:
     explicit LogicAnd(size_t inputSize);
-
-    /* LogicElement interface */
-protected:
-    void _updateLogic(const std::vector<bool> &inputs) override;
 };
 
 #endif // LOGICAND_H
\ No newline at end of file
@@ -4,14 +4,15 @@
 #include "logicdemux.h"
 
 LogicDemux::LogicDemux()
-    : LogicElement(2, 2)
+    : LogicElement(LogicType::DEMUX, 2, 2)
 {
 }
 
-void LogicDemux::_updateLogic(const std::vector<bool> &inputs)
+void LogicDemux::kernel(LogicElement &elm)
 {
-    bool data = inputs[0];
-    bool choice = inputs[1];
+    auto &demux = static_cast<LogicDemux &>(elm);
+    bool data = demux.inputValue(0);
+    bool choice = demux.inputValue(1);
 
     bool out0 = false;
     bool out1 = false;
@@ -20,6 +21,6 @@ void LogicDemux::_updateLogic(const std::vector<bool> &inputs)
     } else {
         out1 = data;
     }
-    setOutputValue(0, out0);
-    setOutputValue(1, out1);
+    demux.setOutput(0, out0);
+    demux.setOutput(1, out1);
 }
\ No newline at end of file
@@ -13,9 +13,8 @@ class LogicDemux : public LogicElement
 public:
     explicit LogicDemux();
 
-    /* LogicElement interface */
-protected:
-    void _updateLogic(const std::vector<bool> &inputs) override;
+    //! Kernel of the type, see LogicKernels.
+    static void kernel(LogicElement &elm);
 };
 
 #endif // LOGICDEMUX_H
\ No newline at end of file
@@ -4,7 +4,7 @@
 #include "logicdflipflop.h"
 
 LogicDFlipFlop::LogicDFlipFlop()
-    : LogicElement(4, 2)
+    : LogicElement(LogicType::DFLIPFLOP, 4, 2)
     , lastClk(false)
     , lastValue(true)
 {
@@ -12,25 +12,26 @@ LogicDFlipFlop::LogicDFlipFlop()
     setOutputValue(1, true);
 }
 
-void LogicDFlipFlop::_updateLogic(const std::vector<bool> &inputs)
+void LogicDFlipFlop::kernel(LogicElement &elm)
 {
-    bool q0 = getOutputValue(0);
-    bool q1 = getOutputValue(1);
-    bool D = inputs[0];
-    bool clk = inputs[1];
-    bool prst = inputs[2];
-    bool clr = inputs[3];
-    if (clk && !lastClk) {
-        q0 = lastValue;
-        q1 = !lastValue;
+    auto &ff = static_cast<LogicDFlipFlop &>(elm);
+    bool q0 = ff.outputValue(0);
+    bool q1 = ff.outputValue(1);
+    bool D = ff.inputValue(0);
+    bool clk = ff.inputValue(1);
+    bool prst = ff.inputValue(2);
+    bool clr = ff.inputValue(3);
+    if (clk && !ff.lastClk) {
+        q0 = ff.lastValue;
+        q1 = !ff.lastValue;
     }
     if ((!prst) || (!clr)) {
         q0 = !prst;
         q1 = !clr;
     }
-    setOutputValue(0, q0);
-    setOutputValue(1, q1);
-    lastClk = clk;
-    lastValue = D;
+    ff.setOutput(0, q0);
+    ff.setOutput(1, q1);
+    ff.lastClk = clk;
+    ff.lastValue = D;
     /* Reference: https://en.wikipedia.org/wiki/Flip-flop_(electronics)#T_flip-flop */
 }
\ No newline at end of file
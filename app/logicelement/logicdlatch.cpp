@@ -4,22 +4,23 @@
 #include "logicdlatch.h"
 
 LogicDLatch::LogicDLatch()
-    : LogicElement(2, 2)
+    : LogicElement(LogicType::DLATCH, 2, 2)
 {
     setOutputValue(0, false);
     setOutputValue(1, true);
 }
 
-void LogicDLatch::_updateLogic(const std::vector<bool> &inputs)
+void LogicDLatch::kernel(LogicElement &elm)
 {
-    bool q0 = getOutputValue(0);
-    bool q1 = getOutputValue(1);
-    bool D = inputs[0];
-    bool enable = inputs[1];
+    auto &latch = static_cast<LogicDLatch &>(elm);
+    bool q0 = latch.outputValue(0);
+    bool q1 = latch.outputValue(1);
+    bool D = latch.inputValue(0);
+    bool enable = latch.inputValue(1);
     if (enable) {
         q0 = D;
         q1 = !D;
     }
-    setOutputValue(0, q0);
-    setOutputValue(1, q1);
+    latch.setOutput(0, q0);
+    latch.setOutput(1, q1);
 }
\ No newline at end of file
@@ -13,9 +13,8 @@ class LogicDLatch : public LogicElement
 public:
     explicit LogicDLatch();
 
-    /* LogicElement interface */
-protected:
-    void _updateLogic(const std::vector<bool> &inputs) override;
+    //! Kernel of the type, see LogicKernels.
+    static void kernel(LogicElement &elm);
 };
 
 #endif // LOGICDLATCH_H
\ No newline at end of file
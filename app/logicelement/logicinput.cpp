@@ -4,12 +4,12 @@
 #include "logicinput.h"
 
 LogicInput::LogicInput(bool defaultValue)
-    : LogicElement(0, 1)
+    : LogicElement(LogicType::INPUT, 0, 1)
 {
     setOutputValue(0, defaultValue);
 }
 
-void LogicInput::_updateLogic(const std::vector<bool> &)
+void LogicInput::kernel(LogicElement &)
 {
     // Does nothing on update
 }
\ No newline at end of file
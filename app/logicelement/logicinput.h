@@ -13,9 +13,8 @@ class LogicInput : public LogicElement
 public:
     explicit LogicInput(bool defaultValue = false);
 
-    /* LogicElement interface */
-protected:
-    void _updateLogic(const std::vector<bool> &) override;
+    //! Kernel of the type, see LogicKernels.
+    static void kernel(LogicElement &elm);
 };
 
 #endif // LOGICINPUT_H
\ No newline at end of file
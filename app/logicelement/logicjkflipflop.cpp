@@ -4,7 +4,7 @@
 #include "logicjkflipflop.h"
 
 LogicJKFlipFlop::LogicJKFlipFlop()
-    : LogicElement(5, 2)
+    : LogicElement(LogicType::JKFLIPFLOP, 5, 2)
     , lastClk(false)
     , lastJ(true)
     , lastK(true)
@@ -13,22 +13,23 @@ LogicJKFlipFlop::LogicJKFlipFlop()
     setOutputValue(1, true);
 }
 
-void LogicJKFlipFlop::_updateLogic(const std::vector<bool> &inputs)
+void LogicJKFlipFlop::kernel(LogicElement &elm)
 {
-    bool q0 = getOutputValue(0);
-    bool q1 = getOutputValue(1);
-    bool j = inputs[0];
-    bool clk = inputs[1];
-    bool k = inputs[2];
-    bool prst = inputs[3];
-    bool clr = inputs[4];
-    if (clk && !lastClk) {
-        if (lastJ && lastK) {
+    auto &ff = static_cast<LogicJKFlipFlop &>(elm);
+    bool q0 = ff.outputValue(0);
+    bool q1 = ff.outputValue(1);
+    bool j = ff.inputValue(0);
+    bool clk = ff.inputValue(1);
+    bool k = ff.inputValue(2);
+    bool prst = ff.inputValue(3);
+    bool clr = ff.inputValue(4);
+    if (clk && !ff.lastClk) {
+        if (ff.lastJ && ff.lastK) {
             std::swap(q0, q1);
-        } else if (lastJ) {
+        } else if (ff.lastJ) {
             q0 = true;
             q1 = false;
-        } else if (lastK) {
+        } else if (ff.lastK) {
             q0 = false;
             q1 = true;
         }
@@ -37,10 +38,10 @@ void LogicJKFlipFlop::_updateLogic(const std::vector<bool> &inputs)
         q0 = !prst;
         q1 = !clr;
     }
-    lastClk = clk;
-    lastK = k;
-    lastJ = j;
+    ff.lastClk = clk;
+    ff.lastK = k;
+    ff.lastJ = j;
 
-    setOutputValue(0, q0);
-    setOutputValue(1, q1);
+    ff.setOutput(0, q0);
+    ff.setOutput(1, q1);
 }
\ No newline at end of file
@@ -13,9 +13,8 @@ class LogicJKFlipFlop : public LogicElement
 public:
     explicit LogicJKFlipFlop();
 
-    /* LogicElement interface */
-protected:
-    void _updateLogic(const std::vector<bool> &inputs) override;
+    //! Kernel of the type, see LogicKernels.
+    static void kernel(LogicElement &elm);
 
 private:
     bool lastClk;
@@ -0,0 +1,82 @@
+// Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "logickernels.h"
+
+#include <functional>
+
+#include "logicdemux.h"
+#include "logicdflipflop.h"
+#include "logicdlatch.h"
+#include "logicinput.h"
+#include "logicjkflipflop.h"
+#include "logicmux.h"
+#include "logicnode.h"
+#include "logicnot.h"
+#include "logicoutput.h"
+#include "logicsrflipflop.h"
+#include "logictflipflop.h"
+
+template <typename Op, bool invert, size_t inputs>
+void LogicKernels::gate(LogicElement &elm)
+{
+    bool result = elm.inputValue(0);
+    for (size_t in = 1; in < inputs; ++in) {
+        result = Op()(result, elm.inputValue(in));
+    }
+    elm.setOutput(0, result != invert);
+}
+
+template <typename Op, bool identity, bool invert>
+void LogicKernels::gateAny(LogicElement &elm)
+{
+    bool result = identity;
+    for (size_t in = 0; in < elm.m_inputs.size(); ++in) {
+        result = Op()(result, elm.inputValue(in));
+    }
+    elm.setOutput(0, result != invert);
+}
+
+template <typename Op, bool identity, bool invert>
+LogicKernels::Entry LogicKernels::gateEntry()
+{
+    static_assert(MaxArity - MinArity + 1 == 7, "One kernel per fan-in");
+    return {&gateAny<Op, identity, invert>,
+            {&gate<Op, invert, 2>,
+             &gate<Op, invert, 3>,
+             &gate<Op, invert, 4>,
+             &gate<Op, invert, 5>,
+             &gate<Op, invert, 6>,
+             &gate<Op, invert, 7>,
+             &gate<Op, invert, 8>}};
+}
+
+LogicElement::Kernel LogicKernels::select(LogicType type, size_t inputSize)
+{
+    /* In the order of LogicType. */
+    static const Entry table[] = {
+        {&LogicInput::kernel, {}},
+        {&LogicOutput::kernel, {}},
+        {&LogicNode::kernel, {}},
+        gateEntry<std::bit_and<bool>, true, false>(),
+        gateEntry<std::bit_or<bool>, false, false>(),
+        gateEntry<std::bit_and<bool>, true, true>(),
+        gateEntry<std::bit_or<bool>, false, true>(),
+        gateEntry<std::bit_xor<bool>, false, false>(),
+        gateEntry<std::bit_xor<bool>, false, true>(),
+        {&LogicNot::kernel, {}},
+        {&LogicJKFlipFlop::kernel, {}},
+        {&LogicSRFlipFlop::kernel, {}},
+        {&LogicTFlipFlop::kernel, {}},
+        {&LogicDFlipFlop::kernel, {}},
+        {&LogicDLatch::kernel, {}},
+        {&LogicMux::kernel, {}},
+        {&LogicDemux::kernel, {}},
+    };
+    static_assert(sizeof(table) / sizeof(table[0]) == static_cast<size_t>(LogicType::DEMUX) + 1, "One entry per LogicType");
+    const Entry &entry = table[static_cast<size_t>(type)];
+    if ((inputSize >= MinArity) && (inputSize <= MaxArity) && entry.fixed[inputSize - MinArity]) {
+        return entry.fixed[inputSize - MinArity];
+    }
+    return entry.any;
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef LOGICKERNELS_H
+#define LOGICKERNELS_H
+
+#include "logicelement.h"
+
+/**
+ * @brief The LogicKernels class holds the table the LogicElement kernels are taken from.
+ *
+ * The table is indexed by LogicType. Gates (AND, OR, XOR and their negations) have one kernel per fan-in
+ * from MinArity to MaxArity, with the input loop unrolled at compile time, and a generic kernel for any other
+ * input count. Every other type has the single kernel of its class.
+ */
+class LogicKernels
+{
+public:
+    static constexpr size_t MinArity = 2;
+    static constexpr size_t MaxArity = 8;
+
+    static LogicElement::Kernel select(LogicType type, size_t inputSize);
+
+private:
+    LogicKernels() = default;
+
+    struct Entry {
+        LogicElement::Kernel any;
+        LogicElement::Kernel fixed[MaxArity - MinArity + 1];
+    };
+
+    //! Folds the fixed number of inputs starting from the first, so it needs no identity unlike gateAny().
+    template <typename Op, bool invert, size_t inputs>
+    static void gate(LogicElement &elm);
+    template <typename Op, bool identity, bool invert>
+    static void gateAny(LogicElement &elm);
+    template <typename Op, bool identity, bool invert>
+    static Entry gateEntry();
+};
+
+#endif // LOGICKERNELS_H
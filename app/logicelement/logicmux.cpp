@@ -4,18 +4,19 @@
 #include "logicmux.h"
 
 LogicMux::LogicMux()
-    : LogicElement(3, 1)
+    : LogicElement(LogicType::MUX, 3, 1)
 {
 }
 
-void LogicMux::_updateLogic(const std::vector<bool> &inputs)
+void LogicMux::kernel(LogicElement &elm)
 {
-    bool data1 = inputs[0];
-    bool data2 = inputs[1];
-    bool choice = inputs[2];
+    auto &mux = static_cast<LogicMux &>(elm);
+    bool data1 = mux.inputValue(0);
+    bool data2 = mux.inputValue(1);
+    bool choice = mux.inputValue(2);
     if (!choice) {
-        setOutputValue(data1);
+        mux.setOutput(0, data1);
     } else {
-        setOutputValue(data2);
+        mux.setOutput(0, data2);
     }
 }
\ No newline at end of file
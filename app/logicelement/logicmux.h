@@ -13,9 +13,8 @@ class LogicMux : public LogicElement
 public:
     explicit LogicMux();
 
-    /* LogicElement interface */
-protected:
-    void _updateLogic(const std::vector<bool> &inputs) override;
+    //! Kernel of the type, see LogicKernels.
+    static void kernel(LogicElement &elm);
 };
 
 #endif // LOGICMUX_H
\ No newline at end of file
@@ -12,10 +12,6 @@ class LogicNand : public LogicElement
 {
 public:
     explicit LogicNand(size_t inputSize);
-
-    /* LogicElement interface */
-protected:
-    void _updateLogic(const std::vector<bool> &inputs) override;
 };
 
 #endif // LOGICNAND_H
\ No newline at end of file
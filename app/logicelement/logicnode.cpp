@@ -4,11 +4,12 @@
 #include "logicnode.h"
 
 LogicNode::LogicNode()
-    : LogicElement(1, 1)
+    : LogicElement(LogicType::NODE, 1, 1)
 {
 }
 
-void LogicNode::_updateLogic(const std::vector<bool> &inputs)
+void LogicNode::kernel(LogicElement &elm)
 {
-    setOutputValue(inputs[0]);
+    auto &node = static_cast<LogicNode &>(elm);
+    node.setOutput(0, node.inputValue(0));
 }
\ No newline at end of file
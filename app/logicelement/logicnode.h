@@ -13,9 +13,8 @@ class LogicNode : public LogicElement
 public:
     explicit LogicNode();
 
-    /* LogicElement interface */
-protected:
-    void _updateLogic(const std::vector<bool> &) override;
+    //! Kernel of the type, see LogicKernels.
+    static void kernel(LogicElement &elm);
 };
 
 #endif // LOGICNODE_H
\ No newline at end of file
@@ -4,12 +4,6 @@
 #include "logicnor.h"
 
 LogicNor::LogicNor(size_t inputSize)
-    : LogicElement(inputSize, 1)
+    : LogicElement(LogicType::NOR, inputSize, 1)
 {
-}
-
-void LogicNor::_updateLogic(const std::vector<bool> &inputs)
-{
-    auto result = std::accumulate(inputs.begin(), inputs.end(), false, std::bit_or<bool>());
-    setOutputValue(!result);
 }
\ No newline at end of file
@@ -12,9 +12,5 @@ class LogicNor : public LogicElement
 {
 public:
     explicit LogicNor(size_t inputSize);
-
-    /* LogicElement interface */
-protected:
-    void _updateLogic(const std::vector<bool> &inputs) override;
 };
 #endif // LOGICNOR_H
\ No newline at end of file
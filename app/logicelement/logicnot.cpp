@@ -4,11 +4,12 @@
 #include "logicnot.h"
 
 LogicNot::LogicNot()
-    : LogicElement(1, 1)
+    : LogicElement(LogicType::NOT, 1, 1)
 {
 }
 
-void LogicNot::_updateLogic(const std::vector<bool> &inputs)
+void LogicNot::kernel(LogicElement &elm)
 {
-    setOutputValue(!inputs[0]);
+    auto &notElm = static_cast<LogicNot &>(elm);
+    notElm.setOutput(0, !notElm.inputValue(0));
 }
\ No newline at end of file
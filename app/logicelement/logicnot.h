@@ -13,9 +13,8 @@ class LogicNot : public LogicElement
 public:
     explicit LogicNot();
 
-    /* LogicElement interface */
-protected:
-    void _updateLogic(const std::vector<bool> &inputs) override;
+    //! Kernel of the type, see LogicKernels.
+    static void kernel(LogicElement &elm);
 };
 
 #endif // LOGICNOT_H
\ No newline at end of file
@@ -4,12 +4,6 @@
 #include "logicor.h"
 
 LogicOr::LogicOr(size_t inputSize)
-    : LogicElement(inputSize, 1)
+    : LogicElement(LogicType::OR, inputSize, 1)
 {
-}
-
-void LogicOr::_updateLogic(const std::vector<bool> &inputs)
-{
-    auto result = std::accumulate(inputs.begin(), inputs.end(), false, std::bit_or<bool>());
-    setOutputValue(result);
 }
\ No newline at end of file
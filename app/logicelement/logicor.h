@@ -12,10 +12,6 @@ class LogicOr : public LogicElement
 {
 public:
     explicit LogicOr(size_t inputSize);
-
-    /* LogicElement interface */
-protected:
-    void _updateLogic(const std::vector<bool> &inputs) override;
 };
 
 #endif // LOGICOR_H
\ No newline at end of file
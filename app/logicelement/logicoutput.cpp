@@ -4,13 +4,14 @@
 #include "logicoutput.h"
 
 LogicOutput::LogicOutput(size_t inputSz)
-    : LogicElement(inputSz, inputSz)
+    : LogicElement(LogicType::OUTPUT, inputSz, inputSz)
 {
 }
 
-void LogicOutput::_updateLogic(const std::vector<bool> &inputs)
+void LogicOutput::kernel(LogicElement &elm)
 {
-    for (size_t idx = 0; idx < inputs.size(); ++idx) {
-        setOutputValue(idx, inputs[idx]);
+    auto &output = static_cast<LogicOutput &>(elm);
+    for (size_t idx = 0; idx < output.inputSize(); ++idx) {
+        output.setOutput(idx, output.inputValue(idx));
     }
 }
\ No newline at end of file
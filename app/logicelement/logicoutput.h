@@ -13,9 +13,8 @@ class LogicOutput : public LogicElement
 public:
     explicit LogicOutput(size_t inputSz);
 
-    /* LogicElement interface */
-protected:
-    void _updateLogic(const std::vector<bool> &inputs) override;
+    //! Kernel of the type, see LogicKernels.
+    static void kernel(LogicElement &elm);
 };
 
 #endif // LOGICOUTPUT_H
\ No newline at end of file
@@ -4,23 +4,24 @@
 #include "logicsrflipflop.h"
 
 LogicSRFlipFlop::LogicSRFlipFlop()
-    : LogicElement(5, 2)
+    : LogicElement(LogicType::SRFLIPFLOP, 5, 2)
     , lastClk(false)
 {
     setOutputValue(0, false);
     setOutputValue(1, true);
 }
 
-void LogicSRFlipFlop::_updateLogic(const std::vector<bool> &inputs)
+void LogicSRFlipFlop::kernel(LogicElement &elm)
 {
-    bool q0 = getOutputValue(0);
-    bool q1 = getOutputValue(1);
-    bool s = inputs[0];
-    bool clk = inputs[1];
-    bool r = inputs[2];
-    bool prst = inputs[3];
-    bool clr = inputs[4];
-    if (clk && !lastClk) {
+    auto &ff = static_cast<LogicSRFlipFlop &>(elm);
+    bool q0 = ff.outputValue(0);
+    bool q1 = ff.outputValue(1);
+    bool s = ff.inputValue(0);
+    bool clk = ff.inputValue(1);
+    bool r = ff.inputValue(2);
+    bool prst = ff.inputValue(3);
+    bool clr = ff.inputValue(4);
+    if (clk && !ff.lastClk) {
         if (s && r) {
             q0 = true;
             q1 = true;
@@ -33,9 +34,9 @@ void LogicSRFlipFlop::_updateLogic(const std::vector<bool> &inputs)
         q0 = !prst;
         q1 = !clr;
     }
-    lastClk = clk;
+    ff.lastClk = clk;
 
-    setOutputValue(0, q0);
-    setOutputValue(1, q1);
+    ff.setOutput(0, q0);
+    ff.setOutput(1, q1);
     /* Reference: https://pt.wikipedia.org/wiki/Flip-flop#Flip-flop_SR_Sincrono */
 }
\ No newline at end of file
@@ -4,7 +4,7 @@
 #include "logictflipflop.h"
 
 LogicTFlipFlop::LogicTFlipFlop()
-    : LogicElement(4, 2)
+    : LogicElement(LogicType::TFLIPFLOP, 4, 2)
     , lastClk(false)
     , lastValue(true)
 {
@@ -12,16 +12,17 @@ LogicTFlipFlop::LogicTFlipFlop()
     setOutputValue(1, true);
 }
 
-void LogicTFlipFlop::_updateLogic(const std::vector<bool> &inputs)
+void LogicTFlipFlop::kernel(LogicElement &elm)
 {
-    bool q0 = getOutputValue(0);
-    bool q1 = getOutputValue(1);
-    bool T = inputs[0];
-    bool clk = inputs[1];
-    bool prst = inputs[2];
-    bool clr = inputs[3];
-    if (clk && !lastClk) {
-        if (lastValue) {
+    auto &ff = static_cast<LogicTFlipFlop &>(elm);
+    bool q0 = ff.outputValue(0);
+    bool q1 = ff.outputValue(1);
+    bool T = ff.inputValue(0);
+    bool clk = ff.inputValue(1);
+    bool prst = ff.inputValue(2);
+    bool clr = ff.inputValue(3);
+    if (clk && !ff.lastClk) {
+        if (ff.lastValue) {
             q0 = !q0;
             q1 = !q0;
         }
@@ -30,9 +31,9 @@ void LogicTFlipFlop::_updateLogic(const std::vector<bool> &inputs)
         q0 = !prst;
         q1 = !clr;
     }
-    setOutputValue(0, q0);
-    setOutputValue(1, q1);
-    lastClk = clk;
-    lastValue = T;
+    ff.setOutput(0, q0);
+    ff.setOutput(1, q1);
+    ff.lastClk = clk;
+    ff.lastValue = T;
     /* Reference: https://en.wikipedia.org/wiki/Flip-flop_(electronics)#T_flip-flop */
 }
\ No newline at end of file
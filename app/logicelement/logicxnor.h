@@ -12,10 +12,6 @@ class LogicXnor : public LogicElement
 {
 public:
     explicit LogicXnor(size_t inputSize);
-
-    /* LogicElement interface */
-protected:
-    void _updateLogic(const std::vector<bool> &inputs) override;
 };
 
 #endif // LOGICXNOR_H
\ No newline at end of file
@@ -4,12 +4,6 @@
 #include "logicxor.h"
 
 LogicXor::LogicXor(size_t inputSize)
-    : LogicElement(inputSize, 1)
+    : LogicElement(LogicType::XOR, inputSize, 1)
 {
-}
-
-void LogicXor::_updateLogic(const std::vector<bool> &inputs)
-{
-    auto result = std::accumulate(inputs.begin(), inputs.end(), false, std::bit_xor<bool>());
-    setOutputValue(result);
 }
\ No newline at end of file
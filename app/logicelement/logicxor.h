@@ -12,10 +12,6 @@ class LogicXor : public LogicElement
 {
 public:
     explicit LogicXor(size_t inputSize);
-
-    /* LogicElement interface */
-protected:
-    void _updateLogic(const std::vector<bool> &inputs) override;
 };
 
 #endif // LOGICXOR_H
\ No newline at end of file
@@ -31,10 +31,24 @@ int main(int argc, char *argv[])
                                           QCoreApplication::translate("main", "waveform text file"));
     parser.addOption(waveformFileOption);
 
+    QCommandLineOption nativeOption(QStringList() << "n"
+                                                  << "native",
+                                    QCoreApplication::translate("main", "Compile the circuit to machine code with the system C++ compiler"));
+    parser.addOption(nativeOption);
+
+    QCommandLineOption replayOption(QStringList() << "r"
+                                                  << "replay",
+                                    QCoreApplication::translate("main", "Replay the input recording <replay> at full speed and print the output changes"),
+                                    QCoreApplication::translate("main", "input recording"));
+    parser.addOption(replayOption);
+
     parser.process(a);
 
     QStringList args = parser.positionalArguments();
     MainWindow w(nullptr, (args.size() > 0 ? QString(args[0]) : QString()));
+    if (parser.isSet(nativeOption)) {
+        w.setNativeBackend(true);
+    }
 
     QString arduFile = parser.value(arduinoFileOption);
     if (!arduFile.isEmpty()) {
@@ -52,6 +66,14 @@ int main(int argc, char *argv[])
         }
         return 0;
     }
+    QString replayFile = parser.value(replayOption);
+    if (!replayFile.isEmpty()) {
+        if (args.size() > 0) {
+            w.loadPandaFile(args[0]);
+            return !w.replayInputLog(replayFile);
+        }
+        return 0;
+    }
     w.show();
     if (args.size() > 0) {
         w.loadPandaFile(args[0]);
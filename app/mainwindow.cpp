@@ -3,6 +3,7 @@
 
 #include "mainwindow.h"
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <stdexcept>
@@ -11,6 +12,7 @@
 #include <QDebug>
 #include <QDialog>
 #include <QFileDialog>
+#include <QLabel>
 #include <QMessageBox>
 #include <QPrinter>
 #include <QProcess>
@@ -19,6 +21,7 @@
 #include <QSettings>
 #include <QShortcut>
 #include <QSpacerItem>
+#include <QTextStream>
 #include <QTranslator>
 #include <QUndoStack>
 #include <QUndoView>
@@ -32,10 +35,13 @@
 #include "globalproperties.h"
 #include "graphicsview.h"
 #include "graphicsviewzoom.h"
+#include "inputlog.h"
 #include "label.h"
 #include "listitemwidget.h"
+#include "nativecompiler.h"
 #include "thememanager.h"
 #include "simulationcontroller.h"
+#include "simulationworker.h"
 
 #include "ui_mainwindow.h"
 
@@ -49,6 +55,8 @@ MainWindow::MainWindow(QWidget *parent, const QString &filename)
     , autosaveFilename("")
     , dolphinFilename("none")
     , bd(nullptr)
+    , simulationStats(new QLabel(this))
+    , lastTickCount(0)
     , translator(nullptr)
 {
     COMMENT("WIRED PANDA Version = " << APP_VERSION << " OR " << GlobalProperties::version, 0);
@@ -104,6 +112,32 @@ MainWindow::MainWindow(QWidget *parent, const QString &filename)
     }
     themeGroup->setExclusive(true);
 
+    /* SIMULATION SPEED */
+    auto *speedGroup = new QActionGroup(this);
+    ui->actionReal_Time->setData(1);
+    ui->actionSpeed_10x->setData(10);
+    ui->actionSpeed_100x->setData(100);
+    ui->actionTurbo->setData(SimulationWorker::TurboSpeed);
+    auto const speedActions = ui->menuSimulation_Speed->actions();
+    for (QAction *action : speedActions) {
+        speedGroup->addAction(action);
+    }
+    speedGroup->setExclusive(true);
+    connect(speedGroup, &QActionGroup::triggered, this, &MainWindow::simulationSpeedTriggered);
+
+    /* HISTORY INTERVAL */
+    auto *historyGroup = new QActionGroup(this);
+    ui->actionHistory_Off->setData(0);
+    ui->actionHistory_Every_Tick->setData(1);
+    ui->actionHistory_64_Ticks->setData(64);
+    ui->actionHistory_1024_Ticks->setData(1024);
+    auto const historyActions = ui->menuHistory_Interval->actions();
+    for (QAction *action : historyActions) {
+        historyGroup->addAction(action);
+    }
+    historyGroup->setExclusive(true);
+    connect(historyGroup, &QActionGroup::triggered, this, &MainWindow::historyIntervalTriggered);
+
     connect(ThemeManager::globalMngr, &ThemeManager::themeChanged, this, &MainWindow::updateTheme);
     connect(ThemeManager::globalMngr, &ThemeManager::themeChanged, editor, &Editor::updateTheme);
     ThemeManager::globalMngr->initialize();
@@ -113,6 +147,16 @@ MainWindow::MainWindow(QWidget *parent, const QString &filename)
     } else {
         setFastMode(false);
     }
+    ui->statusBar->addPermanentWidget(simulationStats);
+    setEventDriven(settings.value("eventDriven").toBool());
+    setNativeBackend(settings.value("nativeBackend").toBool());
+    setMergeDuplicateGates(settings.value("mergeDuplicateGates").toBool());
+    setSimulationSpeed(settings.value("simulationSpeed", 1).toInt());
+    setHistoryInterval(settings.value("historyInterval", editor->getSimulationController()->historyInterval()).toInt());
+    simulationStatsClock.start();
+    simulationStatsTimer.setInterval(500);
+    connect(&simulationStatsTimer, &QTimer::timeout, this, &MainWindow::updateSimulationStats);
+    simulationStatsTimer.start();
     editor->setElementEditor(ui->widgetElementEditor);
     ui->searchScrollArea->hide();
 
@@ -175,6 +219,94 @@ void MainWindow::setFastMode(bool fastModeEnabled)
     ui->actionFast_Mode->setChecked(fastModeEnabled);
 }
 
+void MainWindow::setEventDriven(bool eventDriven)
+{
+    editor->getSimulationController()->setEventDriven(eventDriven);
+    ui->actionEvent_Driven_Simulation->setChecked(eventDriven);
+}
+
+void MainWindow::setNativeBackend(bool native)
+{
+    editor->getSimulationController()->setNative(native);
+    ui->actionNative_Backend->setChecked(native);
+}
+
+void MainWindow::setMergeDuplicateGates(bool merge)
+{
+    editor->getSimulationController()->setStructuralHashing(merge);
+    ui->actionMerge_Duplicate_Gates->setChecked(merge);
+}
+
+void MainWindow::setSimulationSpeed(int speed)
+{
+    editor->getSimulationController()->setSpeed(speed);
+    auto const speedActions = ui->menuSimulation_Speed->actions();
+    for (QAction *action : speedActions) {
+        action->setChecked(action->data().toInt() == speed);
+    }
+}
+
+void MainWindow::simulationSpeedTriggered(QAction *action)
+{
+    const int speed = action->data().toInt();
+    setSimulationSpeed(speed);
+    QSettings settings(QSettings::IniFormat, QSettings::UserScope, QApplication::organizationName(), QApplication::applicationName());
+    settings.setValue("simulationSpeed", speed);
+}
+
+void MainWindow::setHistoryInterval(int interval)
+{
+    editor->getSimulationController()->setHistoryInterval(interval);
+    auto const historyActions = ui->menuHistory_Interval->actions();
+    for (QAction *action : historyActions) {
+        action->setChecked(action->data().toInt() == interval);
+    }
+}
+
+void MainWindow::historyIntervalTriggered(QAction *action)
+{
+    const int interval = action->data().toInt();
+    setHistoryInterval(interval);
+    QSettings settings(QSettings::IniFormat, QSettings::UserScope, QApplication::organizationName(), QApplication::applicationName());
+    settings.setValue("historyInterval", interval);
+}
+
+void MainWindow::updateSimulationStats()
+{
+    SimulationController *sc = editor->getSimulationController();
+    QStringList stats;
+    const quint64 ticks = sc->tickCount();
+    const qint64 elapsed = simulationStatsClock.restart();
+    // The counter starts over whenever the circuit is rebuilt, so that sample is skipped.
+    if (sc->isRunning() && (ticks >= lastTickCount) && (elapsed > 0)) {
+        const double ticksPerSecond = 1000.0 * (ticks - lastTickCount) / elapsed;
+        stats << tr("%1 ticks/s").arg(qRound64(ticksPerSecond));
+        stats << tr("%1 repaints/frame").arg(sc->frameRepaintCount());
+        // Clocks count ticks, so they run as many times faster as the simulation does.
+        double frequency = 0.0;
+        const auto elements = editor->getScene()->getElements();
+        for (GraphicElement *elm : elements) {
+            if (elm->elementType() == ElementType::CLOCK) {
+                frequency = std::max(frequency, static_cast<double>(elm->getFrequency()));
+            }
+        }
+        if (frequency > 0.0) {
+            stats << tr("clock %1 Hz").arg(frequency * ticksPerSecond * GLOBALCLK / 1000.0, 0, 'f', 1);
+        }
+    }
+    lastTickCount = ticks;
+    if (sc->isEventDriven()) {
+        const quint64 skipped = sc->skippedEvaluationCount();
+        const quint64 total = skipped + sc->evaluationCount();
+        const double percent = total ? 100.0 * skipped / total : 0.0;
+        stats << tr("Skipped evaluations: %1 (%2%)").arg(skipped).arg(percent, 0, 'f', 1);
+    }
+    if (sc->isStructuralHashing()) {
+        stats << tr("Gates: %1 of %2").arg(sc->gateCount()).arg(sc->sourceGateCount());
+    }
+    simulationStats->setText(stats.join(" | "));
+}
+
 void MainWindow::createUndoView()
 {
     undoView = new QUndoView(editor->getUndoStack());
@@ -661,6 +793,27 @@ bool MainWindow::exportToWaveFormFile(const QString& fname)
     return true;
 }
 
+bool MainWindow::replayInputLog(const QString &fname)
+{
+    QFile fl(fname);
+    InputLog log;
+    if (!fl.open(QFile::ReadOnly)) {
+        std::cerr << ERRORMSG(tr("Could not open input recording: %1.").arg(fname).toStdString()) << std::endl;
+        return false;
+    }
+    const QByteArray data = fl.readAll();
+    if (!log.deserialize(reinterpret_cast<const uint8_t *>(data.constData()), static_cast<size_t>(data.size()))) {
+        std::cerr << ERRORMSG(tr("Invalid input recording: %1.").arg(fname).toStdString()) << std::endl;
+        return false;
+    }
+    QTextStream trace(stdout);
+    if (!editor->getSimulationController()->runReplay(log, trace)) {
+        std::cerr << ERRORMSG(tr("The input recording does not match the circuit.").toStdString()) << std::endl;
+        return false;
+    }
+    return true;
+}
+
 bool MainWindow::on_actionExport_to_Arduino_triggered()
 {
     QString fname = QFileDialog::getSaveFileName(this, tr("Generate Arduino Code"), defaultDirectory.absolutePath(), tr("Arduino file (*.ino)"));
@@ -830,6 +983,72 @@ void MainWindow::on_actionPlay_triggered(bool checked)
     editor->getSimulationController()->updateAll();
 }
 
+void MainWindow::on_actionStep_Back_triggered()
+{
+    ui->actionPlay->setChecked(false);
+    editor->getSimulationController()->stepHistory(-1);
+}
+
+void MainWindow::on_actionStep_Forward_triggered()
+{
+    ui->actionPlay->setChecked(false);
+    editor->getSimulationController()->stepHistory(1);
+}
+
+void MainWindow::on_actionRecord_Inputs_triggered(bool checked)
+{
+    SimulationController *sc = editor->getSimulationController();
+    if (checked) {
+        if (!sc->startRecording()) {
+            ui->actionRecord_Inputs->setChecked(false);
+            QMessageBox::warning(this, tr("Error"), tr("Could not start the simulation to record it."));
+            return;
+        }
+        ui->actionPlay->setChecked(true);
+        return;
+    }
+    const InputLog &log = sc->stopRecording();
+    if (log.isEmpty()) {
+        return;
+    }
+    QString fname = QFileDialog::getSaveFileName(this, tr("Save Input Recording"), defaultDirectory.absolutePath(), tr("Input recordings (*.wprec)"));
+    if (fname.isEmpty()) {
+        return;
+    }
+    if (!fname.endsWith(".wprec")) {
+        fname.append(".wprec");
+    }
+    const std::vector<uint8_t> data = log.serialize();
+    QSaveFile fl(fname);
+    if (!fl.open(QFile::WriteOnly) || (fl.write(reinterpret_cast<const char *>(data.data()), static_cast<qint64>(data.size())) != static_cast<qint64>(data.size())) || !fl.commit()) {
+        QMessageBox::warning(this, tr("Error"), tr("Could not save input recording: %1.").arg(fl.errorString()));
+    }
+}
+
+void MainWindow::on_actionReplay_Inputs_triggered()
+{
+    const QString fname = QFileDialog::getOpenFileName(this, tr("Replay Input Recording"), defaultDirectory.absolutePath(), tr("Input recordings (*.wprec)"));
+    if (fname.isEmpty()) {
+        return;
+    }
+    QFile fl(fname);
+    InputLog log;
+    QByteArray data;
+    if (fl.open(QFile::ReadOnly)) {
+        data = fl.readAll();
+    }
+    if (!log.deserialize(reinterpret_cast<const uint8_t *>(data.constData()), static_cast<size_t>(data.size()))) {
+        QMessageBox::warning(this, tr("Error"), tr("Could not read input recording: %1.").arg(fname));
+        return;
+    }
+    ui->actionRecord_Inputs->setChecked(false);
+    if (!editor->getSimulationController()->startReplay(log)) {
+        QMessageBox::warning(this, tr("Error"), tr("The input recording does not match the circuit."));
+        return;
+    }
+    ui->actionPlay->setChecked(true);
+}
+
 void MainWindow::on_actionRename_triggered()
 {
     editor->getElementEditor()->renameAction();
@@ -1008,6 +1227,30 @@ void MainWindow::on_actionMute_triggered()
     editor->mute(ui->actionMute->isChecked());
 }
 
+void MainWindow::on_actionEvent_Driven_Simulation_triggered(bool checked)
+{
+    setEventDriven(checked);
+    QSettings settings(QSettings::IniFormat, QSettings::UserScope, QApplication::organizationName(), QApplication::applicationName());
+    settings.setValue("eventDriven", checked);
+}
+
+void MainWindow::on_actionNative_Backend_triggered(bool checked)
+{
+    if (checked && NativeCompiler::compilerPath().isEmpty()) {
+        ui->statusBar->showMessage(tr("No C++ compiler found, the circuit will be interpreted."), 4000);
+    }
+    setNativeBackend(checked);
+    QSettings settings(QSettings::IniFormat, QSettings::UserScope, QApplication::organizationName(), QApplication::applicationName());
+    settings.setValue("nativeBackend", checked);
+}
+
+void MainWindow::on_actionMerge_Duplicate_Gates_triggered(bool checked)
+{
+    setMergeDuplicateGates(checked);
+    QSettings settings(QSettings::IniFormat, QSettings::UserScope, QApplication::organizationName(), QApplication::applicationName());
+    settings.setValue("mergeDuplicateGates", checked);
+}
+
 void MainWindow::on_actionLabels_under_icons_triggered(bool checked)
 {
     checked ? ui->mainToolBar->setToolButtonStyle(Qt::ToolButtonTextUnderIcon) : ui->mainToolBar->setToolButtonStyle(Qt::ToolButtonIconOnly);
@@ -7,13 +7,16 @@
 #define MAINWINDOW_H
 
 #include <QDir>
+#include <QElapsedTimer>
 #include <QFileInfo>
 #include <QMainWindow>
 #include <QTemporaryFile>
+#include <QTimer>
 
 #include "recentfilescontroller.h"
 
 class QDialog;
+class QLabel;
 class QUndoView;
 class QSpacerItem;
 class QTranslator;
@@ -57,6 +60,8 @@ public:
     bool exportToArduino(QString fname);
     //! Saves the current Bewaved Dolphin (waveform simulator) file
     bool exportToWaveFormFile(const QString& fname);
+    //! Replays an input recording on the loaded circuit as fast as possible and prints the output changes
+    bool replayInputLog(const QString &fname);
 
     //! Loads a .panda file
     bool loadPandaFile(const QString &fname);
@@ -76,6 +81,20 @@ public:
 
     void setFastMode(bool fastModeEnabled);
 
+    void setEventDriven(bool eventDriven);
+
+    //! Compiles the simulated circuit to machine code, when a C++ compiler is available.
+    void setNativeBackend(bool native);
+
+    //! Evaluates identical gates of the simulated circuit once, see CompiledNetlist::mergedGateCount().
+    void setMergeDuplicateGates(bool merge);
+
+    //! Ticks per GLOBALCLK interval; 0 is turbo, see SimulationController::setSpeed().
+    void setSimulationSpeed(int speed);
+
+    //! Ticks between the states kept for stepping back, 0 for none, see SimulationController::setHistoryInterval().
+    void setHistoryInterval(int interval);
+
     void buildFullScreenDialog();
 
     QString getDolphinFilename();
@@ -124,6 +143,14 @@ private slots:
 
     void on_actionPlay_triggered(bool checked);
 
+    void on_actionStep_Back_triggered();
+
+    void on_actionStep_Forward_triggered();
+
+    void on_actionRecord_Inputs_triggered(bool checked);
+
+    void on_actionReplay_Inputs_triggered();
+
     void on_actionRename_triggered();
 
     void on_actionChange_Trigger_triggered();
@@ -150,6 +177,18 @@ private slots:
 
     void on_actionMute_triggered();
 
+    void on_actionEvent_Driven_Simulation_triggered(bool checked);
+
+    void on_actionNative_Backend_triggered(bool checked);
+
+    void on_actionMerge_Duplicate_Gates_triggered(bool checked);
+
+    void updateSimulationStats();
+
+    void simulationSpeedTriggered(QAction *action);
+
+    void historyIntervalTriggered(QAction *action);
+
     void on_actionLabels_under_icons_triggered(bool checked);
 
     void on_actionSave_Local_Project_triggered();
@@ -165,6 +204,10 @@ private:
     QString autosaveFilename;
     QString dolphinFilename;
     BewavedDolphin *bd;
+    QLabel *simulationStats;
+    QTimer simulationStatsTimer;
+    QElapsedTimer simulationStatsClock;
+    quint64 lastTickCount;
 
     QTemporaryFile autosaveFile;
 
@@ -0,0 +1,358 @@
+// Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "nativecompiler.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QLibrary>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QStringList>
+#include <QTextStream>
+
+#include "common.h"
+
+namespace
+{
+const char *const updateSymbol = "wpanda_update";
+
+//! Modules loaded by this process, by the hash of their source. They stay loaded until the application exits.
+QHash<QByteArray, CompiledNetlist::NativeUpdate> loadedModules;
+QString cacheDirectoryOverride;
+
+QString moduleSuffix()
+{
+#if defined(Q_OS_WIN)
+    return ".dll";
+#elif defined(Q_OS_MACOS)
+    return ".dylib";
+#else
+    return ".so";
+#endif
+}
+
+QString slot(int index)
+{
+    return QString("s[%1]").arg(index);
+}
+
+QString inputList(const int *first, const int *last, const QString &op)
+{
+    QStringList operands;
+    for (const int *in = first; in != last; ++in) {
+        operands.append(slot(*in));
+    }
+    return operands.join(QString(" %1 ").arg(op));
+}
+
+//! A write through SET(), which records in changed whether the byte differed.
+QString assign(const QString &target, const QString &value)
+{
+    return QString("SET(%1, %2);").arg(target, value);
+}
+
+//! Preset and clear are active low and override the clocked value, like in every flip-flop.
+void writeAsync(QTextStream &out, int q0, int q1)
+{
+    out << "        if (!prst || !clr) { " << assign(slot(q0), "!prst") << " " << assign(slot(q1), "!clr") << " }\n";
+}
+}
+
+QString NativeCompiler::generateSource(const CompiledNetlist &netlist)
+{
+    QString source;
+    QTextStream out(&source);
+    out << "// Generated by wiRedPanda from a compiled netlist of " << netlist.gateCount() << " gates.\n";
+    // Every write goes through SET(), so the function can tell whether the tick changed anything.
+    out << "#define SET(target, value) do { const unsigned char set_ = (value); changed |= (target) ^ set_; (target) = set_; } while (0)\n";
+    out << "extern \"C\"\n";
+#ifdef Q_OS_WIN
+    out << "__declspec(dllexport)\n";
+#endif
+    out << "int " << updateSymbol << "(unsigned char *s, unsigned char *st)\n{\n";
+    out << "    unsigned char changed = 0;\n";
+    for (size_t gate = 0; gate < netlist.m_types.size(); ++gate) {
+        const int loop = netlist.m_gateLoop[gate];
+        if ((loop != -1) && (netlist.m_loopFirst[loop] == static_cast<int>(gate))) {
+            // Same passes as CompiledNetlist::settle(), over the consecutive output slots of the loop.
+            const int slotBegin = netlist.m_outputBegin[gate];
+            const int slots = netlist.m_outputEnd[netlist.m_loopLast[loop]] - slotBegin;
+            out << "    for (int pass = 0; pass < " << CompiledNetlist::SettleLimit << "; ++pass) { // Combinational loop\n";
+            out << "    unsigned char previous[" << slots << "];\n";
+            out << "    for (int i = 0; i < " << slots << "; ++i) { previous[i] = s[" << slotBegin << " + i]; }\n";
+        }
+        const int *first = netlist.m_inputSlots.data() + netlist.m_inputBegin[gate];
+        const int *last = netlist.m_inputSlots.data() + netlist.m_inputBegin[gate + 1];
+        const int q0 = netlist.m_outputBegin[gate];
+        const int q1 = q0 + 1;
+        const int k = netlist.m_stateBegin[gate];
+        const QString state0 = QString("st[%1]").arg(k);
+        const QString state1 = QString("st[%1]").arg(k + 1);
+        const QString state2 = QString("st[%1]").arg(k + 2);
+        switch (netlist.m_types[gate]) {
+        case LogicType::AND:
+            out << "    " << assign(slot(q0), inputList(first, last, "&")) << "\n";
+            break;
+        case LogicType::NAND:
+            out << "    " << assign(slot(q0), "!(" + inputList(first, last, "&") + ")") << "\n";
+            break;
+        case LogicType::OR:
+            out << "    " << assign(slot(q0), inputList(first, last, "|")) << "\n";
+            break;
+        case LogicType::NOR:
+            out << "    " << assign(slot(q0), "!(" + inputList(first, last, "|") + ")") << "\n";
+            break;
+        case LogicType::XOR:
+            out << "    " << assign(slot(q0), inputList(first, last, "^")) << "\n";
+            break;
+        case LogicType::XNOR:
+            out << "    " << assign(slot(q0), "!(" + inputList(first, last, "^") + ")") << "\n";
+            break;
+        case LogicType::NOT:
+            out << "    " << assign(slot(q0), "!" + slot(first[0])) << "\n";
+            break;
+        case LogicType::NODE:
+        case LogicType::OUTPUT:
+            for (const int *in = first; in != last; ++in) {
+                out << "    " << assign(slot(q0 + static_cast<int>(in - first)), slot(*in)) << "\n";
+            }
+            break;
+        case LogicType::MUX:
+            out << "    " << assign(slot(q0), slot(first[2]) + " ? " + slot(first[1]) + " : " + slot(first[0])) << "\n";
+            break;
+        case LogicType::DEMUX:
+            out << "    { // Demux\n";
+            out << "        const unsigned char data = " << slot(first[0]) << ", choice = " << slot(first[1]) << ";\n";
+            out << "        " << assign(slot(q0), "choice ? 0 : data") << "\n";
+            out << "        " << assign(slot(q1), "choice ? data : 0") << "\n";
+            out << "    }\n";
+            break;
+        case LogicType::DLATCH:
+            out << "    if (" << slot(first[1]) << ") { // D Latch\n";
+            out << "        const unsigned char data = " << slot(first[0]) << ";\n";
+            out << "        " << assign(slot(q0), "data") << "\n";
+            out << "        " << assign(slot(q1), "!data") << "\n";
+            out << "    }\n";
+            break;
+        case LogicType::DFLIPFLOP:
+            out << "    { // D FlipFlop\n";
+            out << "        const unsigned char data = " << slot(first[0]) << ", clk = " << slot(first[1]) << ", prst = " << slot(first[2]) << ", clr = " << slot(first[3]) << ";\n";
+            out << "        if (clk && !" << state0 << ") { " << assign(slot(q0), state1) << " " << assign(slot(q1), "!" + state1) << " }\n";
+            writeAsync(out, q0, q1);
+            out << "        " << assign(state0, "clk") << "\n";
+            out << "        " << assign(state1, "data") << "\n";
+            out << "    }\n";
+            break;
+        case LogicType::TFLIPFLOP:
+            out << "    { // T FlipFlop\n";
+            out << "        const unsigned char toggle = " << slot(first[0]) << ", clk = " << slot(first[1]) << ", prst = " << slot(first[2]) << ", clr = " << slot(first[3]) << ";\n";
+            out << "        if (clk && !" << state0 << " && " << state1 << ") { " << assign(slot(q0), "!" + slot(q0)) << " " << assign(slot(q1), "!" + slot(q0)) << " }\n";
+            writeAsync(out, q0, q1);
+            out << "        " << assign(state0, "clk") << "\n";
+            out << "        " << assign(state1, "toggle") << "\n";
+            out << "    }\n";
+            break;
+        case LogicType::JKFLIPFLOP:
+            out << "    { // JK FlipFlop\n";
+            out << "        const unsigned char j = " << slot(first[0]) << ", clk = " << slot(first[1]) << ", k = " << slot(first[2]) << ", prst = " << slot(first[3]) << ", clr = " << slot(first[4]) << ";\n";
+            out << "        if (clk && !" << state0 << ") {\n";
+            out << "            if (" << state1 << " && " << state2 << ") { const unsigned char aux = " << slot(q0) << "; " << assign(slot(q0), slot(q1)) << " " << assign(slot(q1), "aux") << " }\n";
+            out << "            else if (" << state1 << ") { " << assign(slot(q0), "1") << " " << assign(slot(q1), "0") << " }\n";
+            out << "            else if (" << state2 << ") { " << assign(slot(q0), "0") << " " << assign(slot(q1), "1") << " }\n";
+            out << "        }\n";
+            writeAsync(out, q0, q1);
+            out << "        " << assign(state0, "clk") << "\n";
+            out << "        " << assign(state1, "j") << "\n";
+            out << "        " << assign(state2, "k") << "\n";
+            out << "    }\n";
+            break;
+        case LogicType::SRFLIPFLOP:
+            out << "    { // SR FlipFlop\n";
+            out << "        const unsigned char set = " << slot(first[0]) << ", clk = " << slot(first[1]) << ", reset = " << slot(first[2]) << ", prst = " << slot(first[3]) << ", clr = " << slot(first[4]) << ";\n";
+            out << "        if (clk && !" << state0 << ") {\n";
+            out << "            if (set && reset) { " << assign(slot(q0), "1") << " " << assign(slot(q1), "1") << " }\n";
+            out << "            else if (set != reset) { " << assign(slot(q0), "set") << " " << assign(slot(q1), "reset") << " }\n";
+            out << "        }\n";
+            writeAsync(out, q0, q1);
+            out << "        " << assign(state0, "clk") << "\n";
+            out << "    }\n";
+            break;
+        case LogicType::INPUT:
+            break;
+        }
+        if ((loop != -1) && (netlist.m_loopLast[loop] == static_cast<int>(gate))) {
+            const int slotBegin = netlist.m_outputBegin[netlist.m_loopFirst[loop]];
+            const int slots = netlist.m_outputEnd[gate] - slotBegin;
+            out << "    int settled = 1;\n";
+            out << "    for (int i = 0; i < " << slots << "; ++i) { settled &= (previous[i] == s[" << slotBegin << " + i]); }\n";
+            out << "    if (settled) { break; }\n";
+            out << "    }\n";
+        }
+    }
+    out << "    return changed;\n";
+    out << "}\n";
+    out.flush();
+    return source;
+}
+
+QString NativeCompiler::compilerPath()
+{
+    const QString cxx = qEnvironmentVariable("CXX");
+    if (!cxx.isEmpty() && !QStandardPaths::findExecutable(cxx).isEmpty()) {
+        return QStandardPaths::findExecutable(cxx);
+    }
+    for (const QString &name : {QString("c++"), QString("g++"), QString("clang++")}) {
+        const QString path = QStandardPaths::findExecutable(name);
+        if (!path.isEmpty()) {
+            return path;
+        }
+    }
+    return QString();
+}
+
+NativeCompiler::NativeCompiler(const CompiledNetlist &netlist)
+    : m_process(nullptr)
+    , m_failed(false)
+{
+    const QString source = generateSource(netlist);
+    m_hash = QCryptographicHash::hash(source.toUtf8(), QCryptographicHash::Sha1).toHex();
+    if (loadedModules.contains(m_hash)) {
+        return;
+    }
+    const QString directory = cacheDirectory();
+    if (!QDir().mkpath(directory)) {
+        m_failed = true;
+        return;
+    }
+    const QDir cacheDir(directory);
+    m_libraryName = cacheDir.absoluteFilePath(QString::fromLatin1(m_hash) + moduleSuffix());
+    if (QFile::exists(m_libraryName)) {
+        return;
+    }
+    const QString compiler = compilerPath();
+    if (compiler.isEmpty()) {
+        COMMENT("No C++ compiler found, staying with the interpreter.", 0);
+        m_failed = true;
+        return;
+    }
+    m_sourceName = cacheDir.absoluteFilePath(QString::fromLatin1(m_hash) + ".cpp");
+    QFile sourceFile(m_sourceName);
+    if (!sourceFile.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        m_failed = true;
+        return;
+    }
+    sourceFile.write(source.toUtf8());
+    sourceFile.close();
+    // Built under a temporary name, so an interrupted build is never taken from the cache.
+    m_process = new QProcess();
+    m_process->setProcessChannelMode(QProcess::MergedChannels);
+    m_process->start(compiler, {"-O1", "-shared", "-fPIC", "-o", m_libraryName + ".part", m_sourceName});
+}
+
+NativeCompiler::~NativeCompiler()
+{
+    if (m_process) {
+        m_process->kill();
+        m_process->waitForFinished(-1);
+        QFile::remove(m_sourceName);
+        QFile::remove(m_libraryName + ".part");
+        delete m_process;
+    }
+}
+
+bool NativeCompiler::isFinished()
+{
+    if (!m_process) {
+        return true;
+    }
+    // A zero timeout only picks up an exit that already happened.
+    if ((m_process->state() != QProcess::NotRunning) && !m_process->waitForFinished(0)) {
+        return false;
+    }
+    finish();
+    return true;
+}
+
+void NativeCompiler::waitForFinished()
+{
+    if (m_process) {
+        m_process->waitForFinished(-1);
+        finish();
+    }
+}
+
+void NativeCompiler::finish()
+{
+    const bool built = (m_process->error() != QProcess::FailedToStart) && (m_process->exitStatus() == QProcess::NormalExit) && (m_process->exitCode() == 0);
+    const QString partialName = m_libraryName + ".part";
+    QFile::remove(m_sourceName);
+    if (!built || !QFile::rename(partialName, m_libraryName)) {
+        COMMENT("Native compilation failed: " << m_process->readAll().toStdString(), 0);
+        QFile::remove(partialName);
+        m_failed = true;
+    }
+    delete m_process;
+    m_process = nullptr;
+}
+
+CompiledNetlist::NativeUpdate NativeCompiler::result()
+{
+    Q_ASSERT(!m_process);
+    if (m_failed) {
+        return nullptr;
+    }
+    if (loadedModules.contains(m_hash)) {
+        return loadedModules.value(m_hash);
+    }
+    QLibrary library(m_libraryName);
+    auto update = reinterpret_cast<CompiledNetlist::NativeUpdate>(library.resolve(updateSymbol));
+    if (!update) {
+        COMMENT("Could not load native module: " << library.errorString().toStdString(), 0);
+        return nullptr;
+    }
+    loadedModules.insert(m_hash, update);
+    // The modification time of a module tells when it was last used.
+    QFile module(m_libraryName);
+    if (module.open(QIODevice::Append)) {
+        module.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    }
+    evictModules();
+    return update;
+}
+
+CompiledNetlist::NativeUpdate NativeCompiler::load(const CompiledNetlist &netlist)
+{
+    NativeCompiler compiler(netlist);
+    compiler.waitForFinished();
+    return compiler.result();
+}
+
+QString NativeCompiler::cacheDirectory()
+{
+    if (!cacheDirectoryOverride.isEmpty()) {
+        return cacheDirectoryOverride;
+    }
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).absoluteFilePath("native");
+}
+
+void NativeCompiler::setCacheDirectory(const QString &directory)
+{
+    cacheDirectoryOverride = directory;
+}
+
+void NativeCompiler::evictModules()
+{
+    // Newest first: everything after the first CacheLimit modules goes, unless this process still uses it.
+    const QString pattern = "*" + moduleSuffix();
+    const QFileInfoList modules = QDir(cacheDirectory()).entryInfoList({pattern}, QDir::Files, QDir::Time);
+    for (int idx = CacheLimit; idx < modules.size(); ++idx) {
+        if (!loadedModules.contains(modules.at(idx).completeBaseName().toLatin1())) {
+            QFile::remove(modules.at(idx).absoluteFilePath());
+        }
+    }
+}
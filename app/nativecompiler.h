@@ -0,0 +1,75 @@
+/*
+ * Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef NATIVECOMPILER_H
+#define NATIVECOMPILER_H
+
+#include <QByteArray>
+#include <QString>
+
+#include "compilednetlist.h"
+
+class QProcess;
+
+/**
+ * @brief The NativeCompiler class turns a CompiledNetlist into a shared library with the same update function.
+ *
+ * The generated C++ has one statement (or block, for memory elements) per gate, in evaluation order, working
+ * directly on the signal and state arrays of the netlist. It is built with the system compiler and cached by
+ * the hash of its source, so reopening a circuit does not compile it again. The cache keeps the CacheLimit
+ * most recently used modules.
+ *
+ * An instance is one build, running in the background while the netlist keeps using the interpreter: the
+ * caller polls isFinished() and then switches to result().
+ */
+class NativeCompiler
+{
+public:
+    //! Modules kept in the cache directory; the least recently used ones are deleted first.
+    static constexpr int CacheLimit = 64;
+
+    //! Starts building the module of netlist, unless it is loaded or cached already.
+    explicit NativeCompiler(const CompiledNetlist &netlist);
+    //! Kills an unfinished build.
+    ~NativeCompiler();
+
+    NativeCompiler(const NativeCompiler &) = delete;
+    NativeCompiler &operator=(const NativeCompiler &) = delete;
+
+    //! True once the module is built, or failed to build. Never blocks.
+    bool isFinished();
+    //! Blocks until isFinished().
+    void waitForFinished();
+    //! Loads the module of a finished build. Returns nullptr when it could not be built.
+    CompiledNetlist::NativeUpdate result();
+
+    //! C++ source of the update function for the given netlist.
+    static QString generateSource(const CompiledNetlist &netlist);
+
+    //! Compiler used to build the modules: $CXX, or the first of c++, g++ and clang++ found. Empty if none.
+    static QString compilerPath();
+
+    //! Builds (or reuses from the cache) and loads the module, blocking until done. Returns nullptr when it can not be built.
+    static CompiledNetlist::NativeUpdate load(const CompiledNetlist &netlist);
+
+    //! Where modules are cached: CacheLocation/native unless set.
+    static QString cacheDirectory();
+    //! Caches modules in directory instead, or in the default one again with an empty string.
+    static void setCacheDirectory(const QString &directory);
+
+private:
+    //! Takes the module of the process that just exited.
+    void finish();
+    //! Deletes the least recently used modules beyond CacheLimit, except the loaded ones.
+    static void evictModules();
+
+    QByteArray m_hash;
+    QString m_libraryName;
+    QString m_sourceName;
+    QProcess *m_process;
+    bool m_failed;
+};
+
+#endif // NATIVECOMPILER_H
@@ -24,6 +24,7 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 
 #include "common.h"
+#include "graphicsviewzoom.h"
 #include "qneconnection.h"
 #include "qneport.h"
 #include "thememanager.h"
@@ -40,10 +41,10 @@ QNEConnection::QNEConnection(QGraphicsItem *parent)
     : QGraphicsPathItem(parent)
     , m_start(nullptr)
     , m_end(nullptr)
+    , m_status(Status::Inactive)
 {
     setFlag(QGraphicsItem::ItemIsSelectable);
     setBrush(Qt::NoBrush);
-    setStatus(Status::Inactive);
     setZValue(-1);
     updateTheme();
 }
@@ -219,8 +220,17 @@ QNEConnection::Status QNEConnection::status() const
 
 void QNEConnection::setStatus(const Status &status)
 {
+    if (status == m_status) {
+        return;
+    }
     m_status = status;
-    switch (status) {
+    updateStatusPen();
+}
+
+void QNEConnection::updateStatusPen()
+{
+    RepaintCounter::countRepaint();
+    switch (m_status) {
     case Status::Inactive: {
         setPen(QPen(m_inactiveClr, 3));
         break;
@@ -239,12 +249,13 @@ void QNEConnection::setStatus(const Status &status)
 void QNEConnection::updateTheme()
 {
     if (ThemeManager::globalMngr) {
-        const ThemeAttrs attrs = ThemeManager::globalMngr->getAttrs();
+        const ThemeAttrs &attrs = ThemeManager::globalMngr->getAttrs();
         m_inactiveClr = attrs.qneConnection_false;
         m_activeClr = attrs.qneConnection_true;
         m_invalidClr = attrs.qneConnection_invalid;
         m_selectedClr = attrs.qneConnection_selected;
     }
+    updateStatusPen();
 }
 
 void QNEConnection::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *)
@@ -255,5 +266,10 @@ void QNEConnection::paint(QPainter *painter, const QStyleOptionGraphicsItem *opt
     } else {
         painter->setPen(pen());
     }
+    if (!GraphicsViewZoom::showsDetails(painter)) {
+        // Zoomed out, the curve is not told apart from a straight line, which is much cheaper to stroke.
+        painter->drawLine(m_startPos, m_endPos);
+        return;
+    }
     painter->drawPath(path());
 }
@@ -71,6 +71,9 @@ public:
 
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
 private:
+    //! Sets the pen of m_status.
+    void updateStatusPen();
+
     QPointF m_startPos;
     QPointF m_endPos;
     QNEOutputPort *m_start;
@@ -24,7 +24,9 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 
 #include "qneport.h"
+#include "common.h"
 #include "graphicelement.h"
+#include "graphicsviewzoom.h"
 #include "qneconnection.h"
 #include "thememanager.h"
 
@@ -45,6 +47,7 @@ QNEPort::QNEPort(QGraphicsItem *parent)
     , m_required(true)
     , m_graphicElement(nullptr)
     , m_value(false)
+    , m_styled(false)
 {
 
     QPainterPath p;
@@ -139,6 +142,14 @@ int QNEPort::type() const
     return Type;
 }
 
+void QNEPort::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    // Zoomed out, a port is smaller than a pixel.
+    if (GraphicsViewZoom::showsDetails(painter)) {
+        QGraphicsPathItem::paint(painter, option, widget);
+    }
+}
+
 quint64 QNEPort::ptr()
 {
     return m_ptr;
@@ -237,6 +248,15 @@ signed char QNEPort::value() const
     return m_value;
 }
 
+void QNEPort::updateStateColor()
+{
+    // A port value change repaints the port alone, which covers only a sliver of the block.
+    if (m_graphicElement && m_graphicElement->scene() && (m_graphicElement->statePort() == this) && !GraphicsViewZoom::showsDetails(m_graphicElement->scene())) {
+        m_graphicElement->update();
+        RepaintCounter::countRepaint();
+    }
+}
+
 GraphicElement *QNEPort::graphicElement() const
 {
     return m_graphicElement;
@@ -277,22 +297,18 @@ QNEInputPort::~QNEInputPort()
 
 void QNEInputPort::setValue(signed char value)
 {
-    m_value = value;
     if (!isValid()) {
-        m_value = -1;
+        value = -1;
     }
-    if (ThemeManager::globalMngr) {
-        const ThemeAttrs &attrs = ThemeManager::globalMngr->getAttrs();
-        if (m_value == -1) {
-            setPen(attrs.qnePort_invalid_pen);
-            setCurrentBrush(attrs.qnePort_invalid_brush);
-        } else if (m_value == 1) {
-            setPen(attrs.qnePort_true_pen);
-            setCurrentBrush(attrs.qnePort_true_brush);
-        } else {
-            setPen(attrs.qnePort_false_pen);
-            setCurrentBrush(attrs.qnePort_false_brush);
-        }
+    // Steady signals come back every frame; restyling them would repaint the port for nothing.
+    if ((value == m_value) && m_styled) {
+        return;
+    }
+    const bool changed = (value != m_value);
+    m_value = value;
+    updateTheme();
+    if (changed) {
+        updateStateColor();
     }
 }
 
@@ -311,6 +327,21 @@ bool QNEInputPort::isValid() const
 
 void QNEInputPort::updateTheme()
 {
+    if (ThemeManager::globalMngr) {
+        const ThemeAttrs &attrs = ThemeManager::globalMngr->getAttrs();
+        if (m_value == -1) {
+            setPen(attrs.qnePort_invalid_pen);
+            setCurrentBrush(attrs.qnePort_invalid_brush);
+        } else if (m_value == 1) {
+            setPen(attrs.qnePort_true_pen);
+            setCurrentBrush(attrs.qnePort_true_brush);
+        } else {
+            setPen(attrs.qnePort_false_pen);
+            setCurrentBrush(attrs.qnePort_false_brush);
+        }
+        m_styled = true;
+        RepaintCounter::countRepaint();
+    }
 }
 
 QNEOutputPort::QNEOutputPort(QGraphicsItem *parent)
@@ -332,8 +363,12 @@ QNEOutputPort::~QNEOutputPort()
 
 void QNEOutputPort::setValue(signed char value)
 {
-    m_value = value;
-    for (QNEConnection *conn : connections()) {
+    // The connections and their ends only restyle when their own state changes.
+    if (value != m_value) {
+        m_value = value;
+        updateStateColor();
+    }
+    for (QNEConnection *conn : qAsConst(m_connections)) {
         if (value == -1) {
             conn->setStatus(QNEConnection::Status::Invalid);
         } else if (value == 0) {
@@ -364,5 +399,6 @@ void QNEOutputPort::updateTheme()
         const ThemeAttrs &attrs = ThemeManager::globalMngr->getAttrs();
         setPen(attrs.qnePort_output_pen);
         setCurrentBrush(attrs.qnePort_output_brush);
+        RepaintCounter::countRepaint();
     }
 }
@@ -60,6 +60,7 @@ public:
     int portFlags() const;
 
     int type() const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
 
     quint64 ptr();
     void setPtr(quint64);
@@ -92,6 +93,8 @@ public:
 
 protected:
     QVariant itemChange(GraphicsItemChange change, const QVariant &value) override;
+    //! Repaints the element when it is drawn as a block in the color of this port's value.
+    void updateStateColor();
     int m_defaultValue;
     int m_index;
     QNEBlock *m_block;
@@ -111,6 +114,8 @@ protected:
 
     /* QGraphicsItem interface */
     signed char m_value;
+    //! The pen and brush show m_value; otherwise the next setValue() restyles the port even if the value is the same.
+    bool m_styled;
 
     virtual void updateTheme() = 0;
 };
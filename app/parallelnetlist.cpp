@@ -0,0 +1,190 @@
+// Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "parallelnetlist.h"
+
+#include "compilednetlist.h"
+
+namespace
+{
+constexpr ParallelNetlist::Word broadcast(bool value)
+{
+    return value ? ~ParallelNetlist::Word(0) : ParallelNetlist::Word(0);
+}
+
+//! Per lane "mask ? a : b".
+constexpr ParallelNetlist::Word select(ParallelNetlist::Word mask, ParallelNetlist::Word a, ParallelNetlist::Word b)
+{
+    return (mask & a) | (~mask & b);
+}
+}
+
+ParallelNetlist::ParallelNetlist(const CompiledNetlist &netlist)
+    : m_netlist(netlist)
+{
+    m_signals.reserve(netlist.m_signals.size());
+    for (uint8_t value : netlist.m_signals) {
+        m_signals.push_back(broadcast(value));
+    }
+    m_state.reserve(netlist.m_state.size());
+    for (uint8_t value : netlist.m_state) {
+        m_state.push_back(broadcast(value));
+    }
+}
+
+void ParallelNetlist::update()
+{
+    const int *inputs = m_netlist.m_inputSlots.data();
+    const std::vector<int> &inputBegin = m_netlist.m_inputBegin;
+    Word *signals = m_signals.data();
+    Word *state = m_state.data();
+    const size_t gates = m_netlist.m_types.size();
+    for (size_t gate = 0; gate < gates; ++gate) {
+        evaluate(m_netlist.m_types[gate],
+                 signals,
+                 inputs + inputBegin[gate],
+                 inputs + inputBegin[gate + 1],
+                 signals + m_netlist.m_outputBegin[gate],
+                 state + m_netlist.m_stateBegin[gate]);
+    }
+}
+
+ParallelNetlist::Word ParallelNetlist::lanes(int slot) const
+{
+    return m_signals[slot];
+}
+
+void ParallelNetlist::setLanes(int slot, Word lanes)
+{
+    m_signals[slot] = lanes;
+}
+
+void ParallelNetlist::setValue(int slot, bool value)
+{
+    m_signals[slot] = broadcast(value);
+}
+
+void ParallelNetlist::evaluate(LogicType type, const Word *signals, const int *first, const int *last, Word *out, Word *state)
+{
+    // Same behavior as CompiledNetlist::evaluate(), with every branch turned into a per lane select.
+    switch (type) {
+    case LogicType::AND:
+    case LogicType::NAND: {
+        Word result = ~Word(0);
+        for (const int *in = first; in != last; ++in) {
+            result &= signals[*in];
+        }
+        out[0] = (type == LogicType::AND) ? result : ~result;
+        break;
+    }
+    case LogicType::OR:
+    case LogicType::NOR: {
+        Word result = 0;
+        for (const int *in = first; in != last; ++in) {
+            result |= signals[*in];
+        }
+        out[0] = (type == LogicType::OR) ? result : ~result;
+        break;
+    }
+    case LogicType::XOR:
+    case LogicType::XNOR: {
+        Word result = 0;
+        for (const int *in = first; in != last; ++in) {
+            result ^= signals[*in];
+        }
+        out[0] = (type == LogicType::XOR) ? result : ~result;
+        break;
+    }
+    case LogicType::NOT:
+        out[0] = ~signals[first[0]];
+        break;
+    case LogicType::NODE:
+    case LogicType::OUTPUT:
+        for (const int *in = first; in != last; ++in) {
+            *out++ = signals[*in];
+        }
+        break;
+    case LogicType::MUX:
+        out[0] = select(signals[first[2]], signals[first[1]], signals[first[0]]);
+        break;
+    case LogicType::DEMUX: {
+        const Word data = signals[first[0]];
+        const Word choice = signals[first[1]];
+        out[0] = ~choice & data;
+        out[1] = choice & data;
+        break;
+    }
+    case LogicType::DLATCH: {
+        const Word data = signals[first[0]];
+        const Word enable = signals[first[1]];
+        out[0] = select(enable, data, out[0]);
+        out[1] = select(enable, ~data, out[1]);
+        break;
+    }
+    case LogicType::DFLIPFLOP: {
+        const Word data = signals[first[0]];
+        const Word clk = signals[first[1]];
+        const Word prst = signals[first[2]];
+        const Word clr = signals[first[3]];
+        const Word rising = clk & ~state[0];
+        const Word async = ~prst | ~clr;
+        out[0] = select(async, ~prst, select(rising, state[1], out[0]));
+        out[1] = select(async, ~clr, select(rising, ~state[1], out[1]));
+        state[0] = clk;
+        state[1] = data;
+        break;
+    }
+    case LogicType::TFLIPFLOP: {
+        const Word t = signals[first[0]];
+        const Word clk = signals[first[1]];
+        const Word prst = signals[first[2]];
+        const Word clr = signals[first[3]];
+        const Word toggle = clk & ~state[0] & state[1];
+        const Word async = ~prst | ~clr;
+        const Word q0 = out[0] ^ toggle;
+        out[0] = select(async, ~prst, q0);
+        out[1] = select(async, ~clr, select(toggle, ~q0, out[1]));
+        state[0] = clk;
+        state[1] = t;
+        break;
+    }
+    case LogicType::JKFLIPFLOP: {
+        const Word nextJ = signals[first[0]];
+        const Word clk = signals[first[1]];
+        const Word nextK = signals[first[2]];
+        const Word prst = signals[first[3]];
+        const Word clr = signals[first[4]];
+        const Word rising = clk & ~state[0];
+        const Word j = state[1];
+        const Word k = state[2];
+        const Word async = ~prst | ~clr;
+        // J and K: swap. Only J: set. Only K: reset. Neither: hold.
+        const Word q0 = select(j & k, out[1], select(j, ~Word(0), select(k, 0, out[0])));
+        const Word q1 = select(j & k, out[0], select(j, 0, select(k, ~Word(0), out[1])));
+        out[0] = select(async, ~prst, select(rising, q0, out[0]));
+        out[1] = select(async, ~clr, select(rising, q1, out[1]));
+        state[0] = clk;
+        state[1] = nextJ;
+        state[2] = nextK;
+        break;
+    }
+    case LogicType::SRFLIPFLOP: {
+        const Word s = signals[first[0]];
+        const Word clk = signals[first[1]];
+        const Word r = signals[first[2]];
+        const Word prst = signals[first[3]];
+        const Word clr = signals[first[4]];
+        const Word rising = clk & ~state[0];
+        const Word async = ~prst | ~clr;
+        // S and R: both outputs high. Only one of them: follow S and R. Neither: hold.
+        const Word q0 = select(s & r, ~Word(0), select(s ^ r, s, out[0]));
+        const Word q1 = select(s & r, ~Word(0), select(s ^ r, r, out[1]));
+        out[0] = select(async, ~prst, select(rising, q0, out[0]));
+        out[1] = select(async, ~clr, select(rising, q1, out[1]));
+        state[0] = clk;
+        break;
+    }
+    case LogicType::INPUT:
+        break;
+    }
+}
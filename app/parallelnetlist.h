@@ -0,0 +1,47 @@
+/*
+ * Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef PARALLELNETLIST_H
+#define PARALLELNETLIST_H
+
+#include <cstdint>
+#include <vector>
+
+#include "logicelement.h"
+
+class CompiledNetlist;
+
+/**
+ * @brief The ParallelNetlist class simulates 64 independent copies of a CompiledNetlist at once.
+ *
+ * Every signal slot holds a 64 bit word, and bit N of every word belongs to lane N. A single sweep over the
+ * gates therefore evaluates 64 input vectors, which is what truth tables and waveform stimulus batches need.
+ * The lanes start from the current values and state of the compiled netlist they were built from.
+ */
+class ParallelNetlist
+{
+public:
+    typedef uint64_t Word;
+    static constexpr int Lanes = 64;
+
+    explicit ParallelNetlist(const CompiledNetlist &netlist);
+
+    //! Evaluates every gate once, in priority order, on all lanes.
+    void update();
+
+    Word lanes(int slot) const;
+    void setLanes(int slot, Word lanes);
+    //! Sets the same value on every lane.
+    void setValue(int slot, bool value);
+
+private:
+    static void evaluate(LogicType type, const Word *signals, const int *first, const int *last, Word *out, Word *state);
+
+    const CompiledNetlist &m_netlist;
+    std::vector<Word> m_signals;
+    std::vector<Word> m_state;
+};
+
+#endif // PARALLELNETLIST_H
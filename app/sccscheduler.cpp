@@ -0,0 +1,196 @@
+// Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "sccscheduler.h"
+
+#include <algorithm>
+#include <numeric>
+
+SccScheduler::SccScheduler(int nodeCount)
+    : m_nodeCount(nodeCount)
+    , m_base(nodeCount, 1)
+    , m_cutsLoops(nodeCount, false)
+    , m_counter(0)
+    , m_loopCount(0)
+{
+}
+
+void SccScheduler::addEdge(int from, int to)
+{
+    m_edges.emplace_back(from, to);
+}
+
+void SccScheduler::raiseBase(int node, int priority)
+{
+    m_base[node] = std::max(m_base[node], priority);
+}
+
+void SccScheduler::setCutsLoops(int node, bool cutsLoops)
+{
+    m_cutsLoops[node] = cutsLoops;
+}
+
+void SccScheduler::run()
+{
+    m_begin.assign(m_nodeCount + 1, 0);
+    for (const auto &edge : m_edges) {
+        ++m_begin[edge.first + 1];
+    }
+    for (int node = 0; node < m_nodeCount; ++node) {
+        m_begin[node + 1] += m_begin[node];
+    }
+    m_targets.resize(m_edges.size());
+    std::vector<int> fill(m_begin.cbegin(), m_begin.cend() - 1);
+    for (const auto &edge : m_edges) {
+        m_targets[fill[edge.first]++] = edge.second;
+    }
+    m_index.assign(m_nodeCount, -1);
+    m_low.assign(m_nodeCount, 0);
+    m_scope.assign(m_nodeCount, 0);
+    m_component.assign(m_nodeCount, -1);
+    m_onStack.assign(m_nodeCount, false);
+    m_stack.clear();
+    m_counter = 0;
+    m_priority.assign(m_nodeCount, 0);
+    m_loop.assign(m_nodeCount, -1);
+    m_loopCount = 0;
+
+    std::vector<int> roots(m_nodeCount);
+    std::iota(roots.begin(), roots.end(), 0);
+    std::vector<int> order;
+    std::vector<int> begin;
+    findComponents(roots, 0, false, order, begin);
+    begin.push_back(static_cast<int>(order.size()));
+    for (size_t comp = 0; comp + 1 < begin.size(); ++comp) {
+        const int scope = static_cast<int>(comp) + 1;
+        for (int idx = begin[comp]; idx < begin[comp + 1]; ++idx) {
+            m_scope[order[idx]] = scope;
+        }
+        // Components are found successors first, so everything this one feeds already has its priority.
+        bool cyclic = (begin[comp + 1] - begin[comp]) > 1;
+        int base = 1;
+        for (int idx = begin[comp]; idx < begin[comp + 1]; ++idx) {
+            const int node = order[idx];
+            base = std::max(base, m_base[node]);
+            for (int edge = m_begin[node]; edge < m_begin[node + 1]; ++edge) {
+                const int target = m_targets[edge];
+                if (m_scope[target] == scope) {
+                    cyclic |= (target == node);
+                } else {
+                    base = std::max(base, m_priority[target] + 1);
+                }
+            }
+        }
+        if (!cyclic) {
+            m_priority[order[begin[comp]]] = base;
+            continue;
+        }
+        scheduleLoops(std::vector<int>(order.cbegin() + begin[comp], order.cbegin() + begin[comp + 1]), scope, base);
+    }
+}
+
+void SccScheduler::scheduleLoops(const std::vector<int> &members, int scope, int base)
+{
+    // Searched again without the edges into flip-flops: a flip-flop in a cycle simply reads the previous tick.
+    for (int node : members) {
+        m_index[node] = -1;
+        m_component[node] = -1;
+    }
+    std::vector<int> order;
+    std::vector<int> begin;
+    findComponents(members, scope, true, order, begin);
+    begin.push_back(static_cast<int>(order.size()));
+    for (size_t sub = 0; sub + 1 < begin.size(); ++sub) {
+        for (int idx = begin[sub]; idx < begin[sub + 1]; ++idx) {
+            m_component[order[idx]] = static_cast<int>(sub);
+        }
+        bool loop = (begin[sub + 1] - begin[sub]) > 1;
+        int priority = base;
+        for (int idx = begin[sub]; idx < begin[sub + 1]; ++idx) {
+            const int node = order[idx];
+            for (int edge = m_begin[node]; edge < m_begin[node + 1]; ++edge) {
+                const int target = m_targets[edge];
+                if ((m_scope[target] != scope) || m_cutsLoops[target]) {
+                    continue;
+                }
+                if (m_component[target] == static_cast<int>(sub)) {
+                    loop |= (target == node);
+                } else {
+                    priority = std::max(priority, m_priority[target] + 1);
+                }
+            }
+        }
+        for (int idx = begin[sub]; idx < begin[sub + 1]; ++idx) {
+            m_priority[order[idx]] = priority;
+            if (loop) {
+                m_loop[order[idx]] = m_loopCount;
+            }
+        }
+        if (loop) {
+            ++m_loopCount;
+        }
+    }
+}
+
+void SccScheduler::findComponents(const std::vector<int> &roots, int scope, bool cutLoops, std::vector<int> &order, std::vector<int> &begin)
+{
+    // Tarjan's algorithm with an explicit call stack of (node, next edge), so long chains cannot overflow.
+    std::vector<std::pair<int, int>> calls;
+    for (int root : roots) {
+        if (m_index[root] != -1) {
+            continue;
+        }
+        m_index[root] = m_low[root] = m_counter++;
+        m_stack.push_back(root);
+        m_onStack[root] = true;
+        calls.emplace_back(root, m_begin[root]);
+        while (!calls.empty()) {
+            const int node = calls.back().first;
+            if (calls.back().second < m_begin[node + 1]) {
+                const int next = m_targets[calls.back().second++];
+                if ((m_scope[next] != scope) || (cutLoops && m_cutsLoops[next])) {
+                    continue;
+                }
+                if (m_index[next] == -1) {
+                    m_index[next] = m_low[next] = m_counter++;
+                    m_stack.push_back(next);
+                    m_onStack[next] = true;
+                    calls.emplace_back(next, m_begin[next]);
+                } else if (m_onStack[next]) {
+                    m_low[node] = std::min(m_low[node], m_index[next]);
+                }
+                continue;
+            }
+            calls.pop_back();
+            if (!calls.empty()) {
+                const int parent = calls.back().first;
+                m_low[parent] = std::min(m_low[parent], m_low[node]);
+            }
+            if (m_low[node] == m_index[node]) {
+                begin.push_back(static_cast<int>(order.size()));
+                int member;
+                do {
+                    member = m_stack.back();
+                    m_stack.pop_back();
+                    m_onStack[member] = false;
+                    order.push_back(member);
+                } while (member != node);
+            }
+        }
+    }
+}
+
+int SccScheduler::priority(int node) const
+{
+    return m_priority[node];
+}
+
+int SccScheduler::loop(int node) const
+{
+    return m_loop[node];
+}
+
+int SccScheduler::loopCount() const
+{
+    return m_loopCount;
+}
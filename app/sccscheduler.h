@@ -0,0 +1,70 @@
+/*
+ * Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef SCCSCHEDULER_H
+#define SCCSCHEDULER_H
+
+#include <utility>
+#include <vector>
+
+/**
+ * @brief The SccScheduler class computes evaluation priorities of a directed graph without recursion.
+ *
+ * Nodes are indices and edges go from a node to the nodes reading it. The strongly connected components are
+ * found with an iterative Tarjan search, which reports them successors first, so every component is levelized
+ * in the same pass: it goes one priority above everything it feeds. Nodes of an acyclic component keep the
+ * priority they would get from a plain topological levelization, in O(V + E).
+ *
+ * Inside a cyclic component, edges into the nodes that cut loops (flip-flops, which only sample their inputs)
+ * are ignored and the rest is levelized again. What is still cyclic after that is a combinational loop: all its
+ * nodes share one priority and one loop index, and are meant to be evaluated together until they settle.
+ */
+class SccScheduler
+{
+public:
+    explicit SccScheduler(int nodeCount);
+
+    void addEdge(int from, int to);
+    //! Lowest priority of a node, e.g. one above the successors that are not part of the graph.
+    void raiseBase(int node, int priority);
+    //! Marks a node whose input edges are not followed when looking for combinational loops.
+    void setCutsLoops(int node, bool cutsLoops);
+
+    void run();
+
+    //! Priority of a node: higher priorities are evaluated first, and sinks get 1.
+    int priority(int node) const;
+    //! Combinational loop of a node, or -1 when it is not part of one.
+    int loop(int node) const;
+    int loopCount() const;
+
+private:
+    void findComponents(const std::vector<int> &roots, int scope, bool cutLoops, std::vector<int> &order, std::vector<int> &begin);
+    void scheduleLoops(const std::vector<int> &members, int scope, int base);
+
+    int m_nodeCount;
+    std::vector<std::pair<int, int>> m_edges;
+    std::vector<int> m_base;
+    std::vector<bool> m_cutsLoops;
+
+    /* Successors of every node, indexed by m_begin. */
+    std::vector<int> m_begin;
+    std::vector<int> m_targets;
+
+    /* Tarjan search state; m_scope restricts a search to the members of one component. */
+    std::vector<int> m_index;
+    std::vector<int> m_low;
+    std::vector<int> m_scope;
+    std::vector<int> m_component;
+    std::vector<int> m_stack;
+    std::vector<bool> m_onStack;
+    int m_counter;
+
+    std::vector<int> m_priority;
+    std::vector<int> m_loop;
+    int m_loopCount;
+};
+
+#endif // SCCSCHEDULER_H
@@ -135,24 +135,26 @@ bool SimpleWaveform::saveToTxt(QTextStream &outStream, Editor *editor)
     }
     // Creating results vector containing the output resulting values.
     QVector<QVector<uchar>> results(outputCount, QVector<uchar>(num_iter));
-    for (int itr = 0; itr < num_iter; ++itr) {
-        // For each iteration, set a distinct value for the inputs. The set value corresponds to the bits from the number of the current iteration.
-        std::bitset<std::numeric_limits<unsigned int>::digits> bs(itr);
-        for (int in = 0; in < inputs.size(); ++in) {
-            uchar val = bs[in];
-            dynamic_cast<Input *>(inputs[in])->setOn(val);
-        }
-        // Updating the values of the circuit logic based on current input values.
-        sc->update();
-        sc->updateAll();
-        // Setting the computed output values to the waveform results vector.
-        int counter = 0;
-        for (int out = 0; out < outputs.size(); ++out) {
-            int inSz = outputs[out]->inputSize();
-            for (int port = inSz - 1; port >= 0; --port) {
-                uchar val = outputs[out]->input(port)->value();
-                results[counter][itr] = val;
-                counter++;
+    if (!sc->simulateCombinational(inputs, ElementMapping::outputPorts(outputs), ElementMapping::truthTable(inputs.size(), num_iter), results)) {
+        for (int itr = 0; itr < num_iter; ++itr) {
+            // For each iteration, set a distinct value for the inputs. The set value corresponds to the bits from the number of the current iteration.
+            std::bitset<std::numeric_limits<unsigned int>::digits> bs(itr);
+            for (int in = 0; in < inputs.size(); ++in) {
+                uchar val = bs[in];
+                dynamic_cast<Input *>(inputs[in])->setOn(val);
+            }
+            // Updating the values of the circuit logic based on current input values.
+            sc->update();
+            sc->updateAll();
+            // Setting the computed output values to the waveform results vector.
+            int counter = 0;
+            for (int out = 0; out < outputs.size(); ++out) {
+                int inSz = outputs[out]->inputSize();
+                for (int port = inSz - 1; port >= 0; --port) {
+                    uchar val = outputs[out]->input(port)->value();
+                    results[counter][itr] = val;
+                    counter++;
+                }
             }
         }
     }
@@ -290,6 +292,8 @@ void SimpleWaveform::showWaveform()
     COMMENT("Num iter = " << num_iter, 0);
     /*  gap += outputs.size( ) % 2; */
     COMMENT("Running simulation.", 0);
+    QVector<QVector<uchar>> results;
+    const bool parallel = sc->simulateCombinational(inputs, ElementMapping::outputPorts(outputs), ElementMapping::truthTable(inputs.size(), num_iter), results);
     for (int itr = 0; itr < num_iter; ++itr) {
         COMMENT("For each iteration, set a distinct value for the inputs. The value is the bit values corresponding to the number of the current iteration.",
                 3);
@@ -297,20 +301,24 @@ void SimpleWaveform::showWaveform()
         COMMENT("itr:" << itr, 3);
         for (int in = 0; in < inputs.size(); ++in) {
             float val = bs[in];
-            dynamic_cast<Input *>(inputs[in])->setOn(not qFuzzyIsNull(val));
+            if (!parallel) {
+                dynamic_cast<Input *>(inputs[in])->setOn(not qFuzzyIsNull(val));
+            }
             float offset = (in_series.size() - in - 1 + out_series.size()) * 2 + gap + 0.5;
             in_series[in]->append(itr, static_cast<qreal>(offset + val));
             in_series[in]->append(itr + 1, static_cast<qreal>(offset + val));
         }
-        COMMENT("Updating the values of the circuit logic based on current input values.", 3);
-        sc->update();
-        sc->updateAll();
+        if (!parallel) {
+            COMMENT("Updating the values of the circuit logic based on current input values.", 3);
+            sc->update();
+            sc->updateAll();
+        }
         COMMENT("Setting the computed output values to the waveform results.", 3);
         int counter = 0;
         for (int out = 0; out < outputs.size(); ++out) {
             int inSz = outputs[out]->inputSize();
             for (int port = inSz - 1; port >= 0; --port) {
-                float val = outputs[out]->input(port)->value() > 0;
+                float val = parallel ? results[counter][itr] : (outputs[out]->input(port)->value() > 0);
                 float offset = (out_series.size() - counter - 1) * 2 + 0.5;
                 out_series[counter]->append(itr, static_cast<qreal>(offset + val));
                 out_series[counter]->append(itr + 1, static_cast<qreal>(offset + val));
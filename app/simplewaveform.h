@@ -13,6 +13,8 @@
 #include <QDialog>
 #include <QTextStream>
 
+class QNEInputPort;
+
 namespace Ui
 {
 class SimpleWaveform;
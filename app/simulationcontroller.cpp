@@ -5,22 +5,45 @@
 
 #include "common.h"
 #include "element/clock.h"
+#include "elementfactory.h"
 #include "elementmapping.h"
 #include "globalproperties.h"
 #include "graphicelement.h"
 #include "ic.h"
 #include "icmapping.h"
 #include "nodes/qneconnection.h"
+#include "nodes/qneport.h"
 #include "scene.h"
+#include "simulationworker.h"
 #include "simulationcontroller.h"
+#include "workerpool.h"
+
+#include <algorithm>
 
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QGraphicsView>
+#include <QTextStream>
+#include <QThread>
 
 SimulationController::SimulationController(Scene *scn)
     : QObject(dynamic_cast<QObject *>(scn))
-    , m_shouldRestart(false)
+    , m_patchPending(false)
+    , m_threaded(true)
+    , m_workerRunning(false)
+    , m_speed(1)
+    , m_historyInterval(ElementMapping::DefaultHistoryInterval)
+    , m_eventDriven(false)
+    , m_native(false)
+    , m_structuralHashing(false)
+    , m_resume(false)
+    , m_recordPending(false)
+    , m_replayPending(false)
     , m_elMapping(nullptr)
+    , m_pool(nullptr)
+    , m_elementsBound(false)
+    , m_slotsBound(false)
+    , m_frameRepaints(0)
     , m_scene(scn)
     , m_simulationTimer(this)
 {
@@ -28,17 +51,22 @@ SimulationController::SimulationController(Scene *scn)
     m_viewTimer.setInterval(int(1000 / 30));
     m_viewTimer.start();
     connect(&m_viewTimer, &QTimer::timeout, this, &SimulationController::updateView);
-    connect(&m_simulationTimer, &QTimer::timeout, this, &SimulationController::update);
+    connect(&m_simulationTimer, &QTimer::timeout, this, &SimulationController::timerTick);
 }
 
 SimulationController::~SimulationController()
 {
     clear();
+    delete m_pool;
 }
 
 void SimulationController::updateScene(const QRectF &rect)
 {
     if (canRun()) {
+        observeShown(rect);
+        m_elMapping->syncWorker();
+        // What is shown from now on is the reference for the next changed slots.
+        m_elMapping->takeChangedSlots(m_changedSlots);
         const QList<QGraphicsItem *> &items = m_scene->items(rect);
         for (QGraphicsItem *item : items) {
             auto *conn = qgraphicsitem_cast<QNEConnection *>(item);
@@ -57,8 +85,150 @@ void SimulationController::updateScene(const QRectF &rect)
 
 void SimulationController::updateView()
 {
-    auto const scene_views = m_scene->views();
-    updateScene(scene_views.first()->sceneRect());
+    const quint64 repaints = repaintCount();
+    if (m_patchPending || !canRun()) {
+        auto const scene_views = m_scene->views();
+        if (!scene_views.isEmpty()) {
+            updateScene(scene_views.first()->sceneRect());
+        }
+    } else {
+        auto const scene_views = m_scene->views();
+        if (!scene_views.isEmpty()) {
+            const QGraphicsView *view = scene_views.first();
+            const QRectF shown = view->mapToScene(view->viewport()->rect()).boundingRect();
+            // Scrolling, zooming or a new netlist may show the ports of a pruned element.
+            if ((shown != m_shownRect) || !m_slotsBound) {
+                observeShown(shown);
+            }
+        }
+        m_elMapping->syncWorker();
+        const bool changedOnly = m_elMapping->takeChangedSlots(m_changedSlots) && m_slotsBound;
+        const uint8_t *values = m_elMapping->signalData();
+        if (changedOnly) {
+            // A settled circuit costs a comparison of the signals; only the ports of changed ones are visited.
+            for (int slot : qAsConst(m_changedSlots)) {
+                if (slot < m_slotBindings.size()) {
+                    for (int binding : qAsConst(m_slotBindings.at(slot))) {
+                        showBinding(m_bindings.at(binding), values);
+                    }
+                }
+            }
+        } else {
+            // A new netlist: its slots are bound and everything is shown.
+            bindPorts();
+            for (const PortBinding &binding : qAsConst(m_bindings)) {
+                showBinding(binding, values);
+            }
+        }
+    }
+    m_frameRepaints = static_cast<int>(repaintCount() - repaints);
+}
+
+void SimulationController::bindElement(GraphicElement *elm)
+{
+    const auto elm_outputs = elm->outputs();
+    for (QNEOutputPort *port : elm_outputs) {
+        int portIndex = 0;
+        LogicElement *logElm = logicElement(port, portIndex);
+        if (logElm) {
+            m_bindings.append({port, logElm, portIndex, false, nullptr, -1});
+        }
+    }
+    if (elm->elementGroup() == ElementGroup::OUTPUT) {
+        LogicElement *logElm = m_elMapping->getLogicElement(elm);
+        const auto elm_inputs = elm->inputs();
+        for (QNEInputPort *port : elm_inputs) {
+            if (logElm) {
+                m_bindings.append({port, logElm, port->index(), true, elm, -1});
+            }
+        }
+    }
+}
+
+void SimulationController::bindPorts()
+{
+    if (!m_elementsBound) {
+        m_bindings.clear();
+        const auto elements = m_scene->getElements();
+        for (GraphicElement *elm : elements) {
+            bindElement(elm);
+        }
+        m_elementsBound = true;
+    } else {
+        for (GraphicElement *elm : qAsConst(m_unboundElements)) {
+            bindElement(elm);
+        }
+    }
+    m_unboundElements.clear();
+    m_slotBindings.clear();
+    for (int idx = 0; idx < m_bindings.size(); ++idx) {
+        PortBinding &binding = m_bindings[idx];
+        binding.slot = -1;
+        if (binding.logElm->isValid()) {
+            binding.slot = binding.input ? m_elMapping->inputSlot(binding.logElm, binding.portIndex) : m_elMapping->outputSlot(binding.logElm, binding.portIndex);
+        }
+        if (binding.slot == -1) {
+            continue;
+        }
+        if (binding.slot >= m_slotBindings.size()) {
+            m_slotBindings.resize(binding.slot + 1);
+        }
+        m_slotBindings[binding.slot].append(idx);
+    }
+    m_slotsBound = true;
+}
+
+void SimulationController::unbindPorts()
+{
+    m_bindings.clear();
+    m_unboundElements.clear();
+    m_slotBindings.clear();
+    m_elementsBound = false;
+    m_slotsBound = false;
+    m_shownObserved.clear();
+    m_shownRect = QRectF();
+}
+
+void SimulationController::observeShown(const QRectF &rect)
+{
+    m_shownRect = rect;
+    QSet<LogicElement *> shown;
+    QVector<LogicElement *> observed;
+    const QList<QGraphicsItem *> &items = m_scene->items(rect);
+    for (QGraphicsItem *item : items) {
+        auto *elm = qgraphicsitem_cast<GraphicElement *>(item);
+        if (!elm) {
+            continue;
+        }
+        const auto elm_outputs = elm->outputs();
+        for (QNEOutputPort *port : elm_outputs) {
+            int portIndex = 0;
+            LogicElement *logElm = logicElement(port, portIndex);
+            if (!logElm) {
+                continue;
+            }
+            if (m_shownObserved.contains(logElm) || m_elMapping->isPruned(logElm)) {
+                shown.insert(logElm);
+                observed.append(logElm);
+            }
+        }
+    }
+    for (LogicElement *logElm : qAsConst(m_shownObserved)) {
+        if (!shown.contains(logElm)) {
+            m_elMapping->unobserve(logElm);
+        }
+    }
+    m_shownObserved = shown;
+    // Only a pruned element costs a rebuild; the ones observed already are kept as they are.
+    m_elMapping->observe(observed);
+}
+
+void SimulationController::showBinding(const PortBinding &binding, const uint8_t *values)
+{
+    binding.port->setValue((binding.slot == -1) ? -1 : static_cast<signed char>(values[binding.slot]));
+    if (binding.display) {
+        binding.display->refresh();
+    }
 }
 
 void SimulationController::updateAll()
@@ -76,31 +246,322 @@ bool SimulationController::canRun()
 
 bool SimulationController::isRunning()
 {
-    return m_simulationTimer.isActive();
+    return m_simulationTimer.isActive() || m_workerRunning;
 }
 
-void SimulationController::update()
+bool SimulationController::isThreaded() const
 {
-    if (m_shouldRestart) {
-        m_shouldRestart = false;
-        clear();
+    return m_threaded;
+}
+
+void SimulationController::setThreaded(bool threaded)
+{
+    m_threaded = threaded;
+}
+
+int SimulationController::speed() const
+{
+    return m_speed;
+}
+
+void SimulationController::setSpeed(int speed)
+{
+    m_speed = speed;
+    if (m_elMapping) {
+        m_elMapping->setSpeed(speed);
+    }
+}
+
+int SimulationController::historyInterval() const
+{
+    return m_historyInterval;
+}
+
+void SimulationController::setHistoryInterval(int interval)
+{
+    m_historyInterval = qMax(interval, 0);
+    if (m_elMapping) {
+        m_elMapping->setHistoryInterval(m_historyInterval);
     }
+}
+
+quint64 SimulationController::tickCount() const
+{
+    return m_elMapping ? m_elMapping->tickCount() : 0;
+}
+
+bool SimulationController::isEventDriven() const
+{
+    return m_eventDriven;
+}
+
+void SimulationController::setEventDriven(bool eventDriven)
+{
+    m_eventDriven = eventDriven;
+    if (m_elMapping) {
+        m_elMapping->setEventDriven(eventDriven);
+    }
+}
+
+bool SimulationController::isNative() const
+{
+    return m_native;
+}
+
+void SimulationController::setNative(bool native)
+{
+    m_native = native;
+    if (m_elMapping) {
+        m_elMapping->setNative(native);
+    }
+}
+
+bool SimulationController::isStructuralHashing() const
+{
+    return m_structuralHashing;
+}
+
+void SimulationController::setStructuralHashing(bool hashing)
+{
+    m_structuralHashing = hashing;
+    if (m_elMapping) {
+        m_elMapping->setStructuralHashing(hashing);
+    }
+}
+
+int SimulationController::sourceGateCount() const
+{
+    return m_elMapping ? m_elMapping->sourceGateCount() : 0;
+}
+
+int SimulationController::gateCount() const
+{
+    return m_elMapping ? m_elMapping->gateCount() : 0;
+}
+
+int SimulationController::frameRepaintCount() const
+{
+    return m_frameRepaints;
+}
+
+quint64 SimulationController::repaintCount()
+{
+    return RepaintCounter::repaints;
+}
+
+quint64 SimulationController::evaluationCount() const
+{
+    return m_elMapping ? m_elMapping->evaluationCount() : 0;
+}
+
+quint64 SimulationController::skippedEvaluationCount() const
+{
+    return m_elMapping ? m_elMapping->skippedEvaluationCount() : 0;
+}
+
+bool SimulationController::simulateCombinational(const QVector<GraphicElement *> &inputs, const QVector<QNEInputPort *> &outputPorts, const QVector<QVector<uchar>> &stimulus, QVector<QVector<uchar>> &results) const
+{
+    if (!m_elMapping) {
+        return false;
+    }
+    return m_elMapping->simulateCombinational(inputs, outputPorts, stimulus, results);
+}
+
+bool SimulationController::simulateTimed(const QVector<GraphicElement *> &inputs, const QVector<QNEInputPort *> &outputPorts, const QVector<QVector<uchar>> &stimulus, const QVector<int> &delays, QVector<QVector<uchar>> &results) const
+{
+    if (!m_elMapping) {
+        return false;
+    }
+    return m_elMapping->simulateTimed(inputs, outputPorts, stimulus, delays, results);
+}
+
+bool SimulationController::stepHistory(int steps)
+{
+    stop();
+    if (!m_elMapping || !m_elMapping->stepHistory(steps)) {
+        return false;
+    }
+    m_resume = true;
+    updateAll();
+    return true;
+}
+
+bool SimulationController::startRecording()
+{
+    stop();
+    clear();
+    m_recordPending = true;
+    start();
+    return m_elMapping && m_elMapping->isRecording();
+}
+
+const InputLog &SimulationController::stopRecording()
+{
+    if (m_elMapping && m_elMapping->isRecording()) {
+        m_inputLog = m_elMapping->stopRecording();
+        if (m_workerRunning) {
+            m_elMapping->startWorker(GLOBALCLK);
+        }
+    }
+    return m_inputLog;
+}
+
+bool SimulationController::isRecording() const
+{
+    return m_elMapping && m_elMapping->isRecording();
+}
+
+bool SimulationController::startReplay(const InputLog &log)
+{
+    stop();
+    clear();
+    m_replayLog = log;
+    m_replayPending = true;
+    start();
+    return m_elMapping && m_elMapping->isReplaying();
+}
+
+bool SimulationController::runReplay(const InputLog &log, QTextStream &trace)
+{
+    stop();
+    clear();
+    m_replayLog = log;
+    m_replayPending = true;
+    Clock::reset = true;
+    reSortElms();
+    if (!canRun() || !m_elMapping->isReplaying()) {
+        return false;
+    }
+    QVector<LogicElement *> logElms;
+    QVector<int> ports;
+    QStringList labels;
+    const auto elements = m_scene->getElements();
+    for (GraphicElement *elm : elements) {
+        if (elm->elementGroup() != ElementGroup::OUTPUT) {
+            continue;
+        }
+        QString label = elm->getLabel();
+        if (label.isEmpty()) {
+            label = ElementFactory::translatedName(elm->elementType());
+        }
+        for (int port = 0; port < elm->inputSize(); ++port) {
+            logElms.append(m_elMapping->getLogicElement(elm));
+            ports.append(port);
+            labels.append((elm->inputSize() > 1) ? QString("%1_%2").arg(label).arg(port) : label);
+        }
+    }
+    QVector<int> values(ports.size(), -2);
+    auto traceOutputs = [&]() {
+        for (int out = 0; out < ports.size(); ++out) {
+            const int value = (logElms.at(out) && logElms.at(out)->isValid()) ? m_elMapping->getInputValue(logElms.at(out), ports.at(out)) : -1;
+            if (value != values.at(out)) {
+                values[out] = value;
+                trace << m_elMapping->tickCount() << " " << labels.at(out) << " " << value << "\n";
+            }
+        }
+    };
+    traceOutputs();
+    while (m_elMapping->tickCount() < m_elMapping->replayEndTick()) {
+        m_elMapping->update();
+        traceOutputs();
+    }
+    trace.flush();
+    return true;
+}
+
+void SimulationController::patchItems(const QList<QGraphicsItem *> &removed, const QList<QGraphicsItem *> &added)
+{
+    if (!canRun()) {
+        // Nothing to patch: the next reSortElms() builds the simulation layer from scratch.
+        unbindPorts();
+        return;
+    }
+    QVector<GraphicElement *> removedElms;
+    QVector<GraphicElement *> rewiredElms;
+    // A wire only changes the inputs of the element at its end.
+    for (QGraphicsItem *item : removed) {
+        if (auto *elm = qgraphicsitem_cast<GraphicElement *>(item)) {
+            removedElms.append(elm);
+        } else if (auto *conn = qgraphicsitem_cast<QNEConnection *>(item)) {
+            if (conn->end() && conn->end()->graphicElement()) {
+                rewiredElms.append(conn->end()->graphicElement());
+            }
+        }
+    }
+    for (QGraphicsItem *item : added) {
+        if (auto *elm = qgraphicsitem_cast<GraphicElement *>(item)) {
+            rewiredElms.append(elm);
+            m_unboundElements.append(elm);
+        } else if (auto *conn = qgraphicsitem_cast<QNEConnection *>(item)) {
+            if (conn->end() && conn->end()->graphicElement()) {
+                rewiredElms.append(conn->end()->graphicElement());
+            }
+        }
+    }
+    // Bindings follow the patch: those of removed elements go now, added elements are bound after it.
+    m_bindings.erase(std::remove_if(m_bindings.begin(), m_bindings.end(), [&removedElms](const PortBinding &binding) {
+        return removedElms.contains(binding.port->graphicElement());
+    }), m_bindings.end());
+    m_slotBindings.clear();
+    m_slotsBound = false;
+    // Removed elements also leave the rewired ones, so they go last.
+    m_elMapping->markRewired(rewiredElms);
+    m_elMapping->removeElements(removedElms);
+    m_patchPending = true;
+}
+
+void SimulationController::update()
+{
     if (m_elMapping) {
         m_elMapping->update();
     }
 }
 
+void SimulationController::timerTick()
+{
+    if (m_speed != SimulationWorker::TurboSpeed) {
+        for (int step = 0; step < m_speed; ++step) {
+            update();
+        }
+        return;
+    }
+    QElapsedTimer budget;
+    budget.start();
+    do {
+        update();
+    } while (canRun() && (budget.elapsed() < GLOBALCLK / 2));
+}
+
 void SimulationController::stop()
 {
     m_simulationTimer.stop();
+    m_workerRunning = false;
+    if (m_elMapping) {
+        m_elMapping->stopWorker();
+    }
 }
 
 void SimulationController::start()
 {
     COMMENT("Start simulation controller.", 0);
+    if (m_resume && !m_patchPending && m_elMapping) {
+        m_resume = false;
+        m_workerRunning = m_threaded;
+        if (m_threaded) {
+            m_elMapping->startWorker(GLOBALCLK);
+        } else {
+            m_simulationTimer.start();
+        }
+        COMMENT("Simulation resumed.", 0);
+        return;
+    }
+    m_resume = false;
     Clock::reset = true;
+    m_workerRunning = m_threaded;
     reSortElms();
-    m_simulationTimer.start();
+    if (!m_threaded) {
+        m_simulationTimer.start();
+    }
     COMMENT("Simulation started.", 0);
 }
 
@@ -109,20 +570,48 @@ void SimulationController::reSortElms()
     COMMENT("GENERATING SIMULATION LAYER", 0);
     QVector<GraphicElement *> elements = m_scene->getElements();
     COMMENT("Elements read:" << elements.size(), 0);
+    if (m_patchPending) {
+        m_patchPending = false;
+        if (m_elMapping && m_elMapping->patch(elements)) {
+            COMMENT("Patched simulation layer.", 0);
+            update();
+            return;
+        }
+    }
     if (elements.size() == 0) {
         return;
     }
     COMMENT("After return.", 0);
+    unbindPorts();
     if (m_elMapping) {
         delete m_elMapping;
     }
     COMMENT("Elements deleted.", 0);
     m_elMapping = new ElementMapping(m_scene->getElements(), GlobalProperties::currentFile);
+    m_elMapping->setEventDriven(m_eventDriven);
+    m_elMapping->setNative(m_native);
+    m_elMapping->setStructuralHashing(m_structuralHashing);
+    m_elMapping->setSpeed(m_speed);
+    m_elMapping->setHistoryInterval(m_historyInterval);
+    if (!m_pool) {
+        m_pool = new WorkerPool(QThread::idealThreadCount());
+    }
+    m_elMapping->setWorkerPool(m_pool);
     if (m_elMapping->canInitialize()) {
         COMMENT("Can initialize.", 0);
         m_elMapping->initialize();
         m_elMapping->sort();
+        if (m_recordPending) {
+            m_elMapping->startRecording();
+        } else if (m_replayPending) {
+            m_elMapping->startReplay(m_replayLog);
+        }
+        m_recordPending = false;
+        m_replayPending = false;
         update();
+        if (m_workerRunning) {
+            m_elMapping->startWorker(GLOBALCLK);
+        }
     } else {
         qDebug() << "Cannot initialize simulation!";
         COMMENT("Can not initialize.", 0);
@@ -132,29 +621,39 @@ void SimulationController::reSortElms()
 
 void SimulationController::clear()
 {
+    if (m_elMapping && m_elMapping->isRecording()) {
+        m_inputLog = m_elMapping->stopRecording();
+    }
+    m_patchPending = false;
+    m_resume = false;
+    unbindPorts();
     if (m_elMapping) {
         delete m_elMapping;
     }
     m_elMapping = nullptr;
 }
 
+LogicElement *SimulationController::logicElement(QNEOutputPort *port, int &portIndex) const
+{
+    GraphicElement *elm = port->graphicElement();
+    Q_ASSERT(elm);
+    portIndex = 0;
+    if (elm->elementType() == ElementType::IC) {
+        IC *ic = dynamic_cast<IC *>(elm);
+        return m_elMapping->getICMapping(ic)->getOutput(port->index());
+    }
+    portIndex = port->index();
+    return m_elMapping->getLogicElement(elm);
+}
+
 void SimulationController::updatePort(QNEOutputPort *port)
 {
     if (port) {
-        GraphicElement *elm = port->graphicElement();
-        Q_ASSERT(elm);
-        LogicElement *logElm = nullptr;
         int portIndex = 0;
-        if (elm->elementType() == ElementType::IC) {
-            IC *ic = dynamic_cast<IC *>(elm);
-            logElm = m_elMapping->getICMapping(ic)->getOutput(port->index());
-        } else {
-            logElm = m_elMapping->getLogicElement(elm);
-            portIndex = port->index();
-        }
+        LogicElement *logElm = logicElement(port, portIndex);
         Q_ASSERT(logElm);
         if (logElm->isValid()) {
-            port->setValue(logElm->getOutputValue(portIndex));
+            port->setValue(m_elMapping->getOutputValue(logElm, portIndex));
         } else {
             port->setValue(-1);
         }
@@ -170,7 +669,7 @@ void SimulationController::updatePort(QNEInputPort *port)
     Q_ASSERT(logElm);
     int portIndex = port->index();
     if (logElm->isValid()) {
-        port->setValue(logElm->getInputValue(portIndex));
+        port->setValue(m_elMapping->getInputValue(logElm, portIndex));
     } else {
         port->setValue(-1);
     }
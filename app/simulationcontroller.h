@@ -6,25 +6,32 @@
 #ifndef SIMULATIONCONTROLLER_H
 #define SIMULATIONCONTROLLER_H
 
+#include <cstdint>
+
 #include <QObject>
+#include <QRectF>
+#include <QSet>
 #include <QTimer>
 
+#include "inputlog.h"
+
 class Clock;
 class ElementMapping;
 class GraphicElement;
+class LogicElement;
+class QGraphicsItem;
 class QNEConnection;
 class QNEInputPort;
 class QNEOutputPort;
+class QNEPort;
+class QTextStream;
 class Scene;
+class WorkerPool;
 
 class SimulationController : public QObject
 {
     Q_OBJECT
 public:
-    // If m_shouldRestart == true, then the simulation controller will be cleared the next time that
-    // it is updated.
-    void setRestart() { m_shouldRestart = true; }
-
     explicit SimulationController(Scene *scn);
     ~SimulationController() override;
 
@@ -32,6 +39,72 @@ public:
     static QVector<GraphicElement *> sortElements(QVector<GraphicElement *> elms);
 
     bool isRunning();
+
+    //! Runs the ticks on a SimulationWorker thread (the default) instead of a GUI timer. Applies on the next start().
+    bool isThreaded() const;
+    void setThreaded(bool threaded);
+
+    /**
+     * @brief Ticks run per GLOBALCLK interval: 1 is real time, 0 (turbo) runs as many as fit in the interval.
+     * On the GUI timer, turbo only takes half of each interval, so the editor stays responsive.
+     */
+    int speed() const;
+    void setSpeed(int speed);
+    //! Ticks run since the simulation layer was built.
+    quint64 tickCount() const;
+    //! Ticks between two states kept for stepHistory(), 0 for none, see ElementMapping::setHistoryInterval().
+    int historyInterval() const;
+    void setHistoryInterval(int interval);
+
+    bool isEventDriven() const;
+    void setEventDriven(bool eventDriven);
+    //! Native backend requested; it silently stays on the interpreter without a C++ compiler.
+    bool isNative() const;
+    void setNative(bool native);
+    //! Merging of duplicated gates, see ElementMapping::setStructuralHashing().
+    bool isStructuralHashing() const;
+    void setStructuralHashing(bool hashing);
+    //! Gates of the circuit, and gates left to evaluate once the netlist is optimized.
+    int sourceGateCount() const;
+    int gateCount() const;
+    //! Repaints requested by the last updateView(), see repaintCount(). None once the circuit settles.
+    int frameRepaintCount() const;
+    //! Repaints requested since the program started, see RepaintCounter.
+    static quint64 repaintCount();
+    quint64 evaluationCount() const;
+    quint64 skippedEvaluationCount() const;
+
+    /**
+     * @brief Lets the next reSortElms() patch the simulation layer instead of rebuilding it, see ElementMapping::patch().
+     * @param removed Items about to be deleted; they must be reported before they are.
+     * @param added Items just added to the scene.
+     */
+    void patchItems(const QList<QGraphicsItem *> &removed, const QList<QGraphicsItem *> &added);
+
+    //! Bit-parallel batch simulation for combinational circuits, see ElementMapping::simulateCombinational().
+    bool simulateCombinational(const QVector<GraphicElement *> &inputs, const QVector<QNEInputPort *> &outputPorts, const QVector<QVector<uchar>> &stimulus, QVector<QVector<uchar>> &results) const;
+    //! Waveform with propagation delays, see ElementMapping::simulateTimed().
+    bool simulateTimed(const QVector<GraphicElement *> &inputs, const QVector<QNEInputPort *> &outputPorts, const QVector<QVector<uchar>> &stimulus, const QVector<int> &delays, QVector<QVector<uchar>> &results) const;
+
+    /**
+     * @brief Pauses the simulation and moves through the recorded states, see ElementMapping::stepHistory().
+     * The next start() resumes from the restored state instead of rebuilding the simulation layer.
+     */
+    bool stepHistory(int steps);
+
+    //! Restarts the simulation from scratch and records its input changes, see ElementMapping::startRecording().
+    bool startRecording();
+    //! Ends the recording and returns it; it stays available until the next one. The simulation keeps running.
+    const InputLog &stopRecording();
+    bool isRecording() const;
+    //! Restarts the simulation from scratch with its inputs driven by log.
+    bool startReplay(const InputLog &log);
+    /**
+     * @brief Replays log up to its last tick as fast as possible, without the GUI, writing every change of the
+     * output element ports to trace as "tick label value". Returns false when the log does not fit the circuit.
+     */
+    bool runReplay(const InputLog &log, QTextStream &trace);
+
 signals:
 
 public slots:
@@ -44,13 +117,71 @@ public slots:
     bool canRun();
     void reSortElms();
 
+private slots:
+    void timerTick();
+
 private:
     void updatePort(QNEOutputPort *port);
     void updatePort(QNEInputPort *port);
     void updateConnection(QNEConnection *conn);
+    //! Logic element and port shown by an output port, nullptr when there is none.
+    LogicElement *logicElement(QNEOutputPort *port, int &portIndex) const;
+
+    //! A port shown by the view: an output port, or an input of an output element, and the slot it shows.
+    struct PortBinding {
+        QNEPort *port;
+        LogicElement *logElm;
+        int portIndex;
+        bool input;
+        //! Output element refreshed after its input, nullptr for output ports.
+        GraphicElement *display;
+        //! -1 for an invalid element.
+        int slot;
+    };
+
+    //! Binds the ports of elm to their logic element.
+    void bindElement(GraphicElement *elm);
+    //! Binds the elements not bound yet, then every port to its slot in the current netlist.
+    void bindPorts();
+    void unbindPorts();
+    void showBinding(const PortBinding &binding, const uint8_t *values);
+    /**
+     * @brief Keeps evaluated the elements whose output ports are inside rect, although no wire reads them, and
+     * lets the ones observed for an earlier rect be pruned again. See ElementMapping::observe().
+     */
+    void observeShown(const QRectF &rect);
 
-    bool m_shouldRestart;
+    bool m_patchPending;
+    bool m_threaded;
+    bool m_workerRunning;
+    int m_speed;
+    int m_historyInterval;
+    bool m_eventDriven;
+    bool m_native;
+    bool m_structuralHashing;
+    //! The simulation layer holds a rewound state that start() continues from.
+    bool m_resume;
+    //! Makes the next full rebuild start recording, or replaying m_replayLog.
+    bool m_recordPending;
+    bool m_replayPending;
+    InputLog m_inputLog;
+    InputLog m_replayLog;
     ElementMapping *m_elMapping;
+    //! Threads of the levelized sweep, kept across the rebuilds of the simulation layer.
+    WorkerPool *m_pool;
+    /* View refresh: the ports of the scene elements once m_elementsBound, then the bindings showing every slot
+     * once m_slotsBound, and the slots changed since the last frame. Patches keep the bindings of the other
+     * elements and only bind the new ones. */
+    QVector<PortBinding> m_bindings;
+    QVector<GraphicElement *> m_unboundElements;
+    bool m_elementsBound;
+    QVector<QVector<int>> m_slotBindings;
+    bool m_slotsBound;
+    QVector<int> m_changedSlots;
+    //! Elements observed by observeShown(), and the scene rect they were observed for.
+    QSet<LogicElement *> m_shownObserved;
+    QRectF m_shownRect;
+    int m_frameRepaints;
     Scene *m_scene;
     QTimer m_simulationTimer;
     QTimer m_viewTimer;
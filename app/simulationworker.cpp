@@ -0,0 +1,277 @@
+// Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "simulationworker.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "compilednetlist.h"
+#include "statehistory.h"
+
+SimulationWorker::SimulationWorker(CompiledNetlist &netlist, const QVector<ClockState> &clocks, bool resetClocks, int tickInterval, int speed,
+                                   StateHistory *history, quint64 firstTick, int historyInterval,
+                                   InputLog *inputRecord, const InputLog *inputReplay, const QVector<int> &inputSlots)
+    : m_netlist(netlist)
+    , m_clocks(clocks)
+    , m_resetClocks(resetClocks)
+    , m_nextEdge(clocks.size(), 0)
+    , m_now(0)
+    , m_tickInterval(tickInterval)
+    , m_speed(speed)
+    , m_inputRecord(inputRecord)
+    , m_inputReplay(inputReplay, firstTick + 1)
+    , m_inputSlots(inputSlots)
+    , m_slotInputs(inputRecord ? netlist.signalCount() : 0, -1)
+    , m_history(history)
+    , m_firstTick(firstTick)
+    , m_historyInterval(std::max(historyInterval, 1))
+    , m_lastRecord(0)
+    , m_recorded(false)
+    , m_middle(1)
+    , m_back(2)
+    , m_front(0)
+    , m_ticks(0)
+    , m_evaluations(netlist.evaluationCount())
+    , m_skippedEvaluations(netlist.skippedEvaluationCount())
+    , m_quit(false)
+{
+    for (int input = 0; m_inputRecord && (input < m_inputSlots.size()); ++input) {
+        m_slotInputs[m_inputSlots.at(input)] = input;
+    }
+    for (int idx = 0; idx < m_clocks.size(); ++idx) {
+        ClockState &clock = m_clocks[idx];
+        clock.interval = std::max(clock.interval, 1);
+        m_netlist.setValue(clock.slot, clock.on);
+        // Clock::updateClock() toggles when the incremented elapsed count is a multiple of the interval.
+        if (!m_resetClocks && !clock.disabled) {
+            m_nextEdge[idx] = static_cast<quint64>(clock.interval - (clock.elapsed % clock.interval));
+            m_wheel.schedule(idx, m_nextEdge[idx]);
+        }
+    }
+    // Every buffer starts with the current state, so the GUI has a valid snapshot right away.
+    for (std::vector<uint8_t> &buffer : m_buffers) {
+        takeSnapshot(buffer);
+    }
+    m_thread = std::thread(&SimulationWorker::run, this);
+}
+
+SimulationWorker::~SimulationWorker()
+{
+    stop();
+}
+
+bool SimulationWorker::setInput(int slot, bool value)
+{
+    return m_inputs.push({slot, value});
+}
+
+const uint8_t *SimulationWorker::acquireSnapshot()
+{
+    if (m_middle.load(std::memory_order_relaxed) & FreshSnapshot) {
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & SnapshotIndex;
+    }
+    return snapshot();
+}
+
+const uint8_t *SimulationWorker::snapshot() const
+{
+    return m_buffers[m_front].data();
+}
+
+void SimulationWorker::setSpeed(int speed)
+{
+    m_speed.store(speed, std::memory_order_relaxed);
+}
+
+quint64 SimulationWorker::tickCount() const
+{
+    return m_ticks.load(std::memory_order_relaxed);
+}
+
+quint64 SimulationWorker::evaluationCount() const
+{
+    return m_evaluations.load(std::memory_order_relaxed);
+}
+
+quint64 SimulationWorker::skippedEvaluationCount() const
+{
+    return m_skippedEvaluations.load(std::memory_order_relaxed);
+}
+
+void SimulationWorker::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_one();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void SimulationWorker::run()
+{
+    using SteadyClock = std::chrono::steady_clock;
+    auto deadline = SteadyClock::now();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_quit) {
+        lock.unlock();
+        const int speed = m_speed.load(std::memory_order_relaxed);
+        const auto interval = std::chrono::milliseconds(m_tickInterval);
+        if (speed == TurboSpeed) {
+            // Ticks are cheap next to the clock reads, so the budget is checked every few of them.
+            const auto budget = SteadyClock::now() + interval;
+            do {
+                for (int batch = 0; batch < 16; ++batch) {
+                    step(m_now + TurboSpan);
+                }
+            } while (SteadyClock::now() < budget);
+        } else {
+            const quint64 end = m_now + static_cast<quint64>(speed);
+            while (m_now < end) {
+                step(end);
+            }
+        }
+        publish();
+        lock.lock();
+        // A late tick moves the schedule instead of being caught up in a burst, like the GUI timer did.
+        deadline = std::max(deadline + interval, SteadyClock::now());
+        if (speed != TurboSpeed) {
+            m_wake.wait_until(lock, deadline, [this] { return m_quit; });
+        }
+    }
+}
+
+void SimulationWorker::step(quint64 end)
+{
+    InputChange change;
+    while (m_inputs.pop(change)) {
+        // The change takes effect on the next tick, which is where a replay applies it again.
+        if (m_inputRecord && (m_slotInputs[change.slot] != -1) && (m_netlist.value(change.slot) != change.value)) {
+            m_inputRecord->append(m_firstTick + m_now + 1, m_slotInputs[change.slot], change.value);
+        }
+        m_netlist.setValue(change.slot, change.value);
+    }
+    replay(m_now + 1);
+    if (m_netlist.isQuiescent() && !m_resetClocks) {
+        // Nothing changes before the next clock edge or replayed input: skip the ticks up to it.
+        quint64 next = m_wheel.nextTime();
+        if (m_inputReplay.tick() != InputLog::Reader::End) {
+            next = std::min(next, m_inputReplay.tick() - m_firstTick);
+        }
+        if (next > end) {
+            m_now = end;
+            m_ticks.store(m_now, std::memory_order_relaxed);
+            return;
+        }
+        m_now = next - 1;
+        replay(next);
+    }
+    tick();
+}
+
+void SimulationWorker::tick()
+{
+    ++m_now;
+    if (m_resetClocks) {
+        m_wheel.clear(m_now);
+        for (int idx = 0; idx < m_clocks.size(); ++idx) {
+            m_clocks[idx].on = true;
+            m_clocks[idx].elapsed = 0;
+            m_netlist.setValue(m_clocks.at(idx).slot, true);
+            if (!m_clocks.at(idx).disabled) {
+                m_nextEdge[idx] = m_now + static_cast<quint64>(m_clocks.at(idx).interval);
+                m_wheel.schedule(idx, m_nextEdge[idx]);
+            }
+        }
+        m_resetClocks = false;
+    } else {
+        // Every clock with an edge now toggles before the sweep, however many there are.
+        m_dueClocks.clear();
+        m_wheel.advance(m_now, m_dueClocks);
+        for (int idx : m_dueClocks) {
+            ClockState &clock = m_clocks[idx];
+            clock.on = !clock.on;
+            m_netlist.setValue(clock.slot, clock.on);
+            m_nextEdge[idx] = m_now + static_cast<quint64>(clock.interval);
+            m_wheel.schedule(idx, m_nextEdge[idx]);
+        }
+    }
+    m_netlist.updateIfActive();
+    if (m_history) {
+        record();
+    }
+    m_ticks.store(m_now, std::memory_order_relaxed);
+    m_evaluations.store(m_netlist.evaluationCount(), std::memory_order_relaxed);
+    m_skippedEvaluations.store(m_netlist.skippedEvaluationCount(), std::memory_order_relaxed);
+}
+
+void SimulationWorker::record()
+{
+    const quint64 tick = m_firstTick + m_now;
+    if (m_recorded && (tick < m_lastRecord + static_cast<quint64>(m_historyInterval))) {
+        return;
+    }
+    m_stateVector.clear();
+    m_netlist.saveState(m_stateVector);
+    for (int idx = 0; idx < m_clocks.size(); ++idx) {
+        saveClock(m_stateVector, m_clocks.at(idx).on, clockPhase(idx));
+    }
+    m_history->record(tick, m_stateVector);
+    m_lastRecord = tick;
+    m_recorded = true;
+}
+
+int SimulationWorker::clockPhase(int idx) const
+{
+    const ClockState &clock = m_clocks.at(idx);
+    if (clock.disabled || m_resetClocks) {
+        return clock.elapsed % clock.interval;
+    }
+    // The elapsed count is only kept modulo the interval: what is left until the next edge.
+    return clock.interval - static_cast<int>(m_nextEdge[idx] - m_now);
+}
+
+void SimulationWorker::replay(quint64 tick)
+{
+    while (m_inputReplay.tick() <= m_firstTick + tick) {
+        const InputLog::Event &event = m_inputReplay.event();
+        m_netlist.setValue(m_inputSlots.at(event.input), event.value);
+        m_inputReplay.advance();
+    }
+}
+
+void SimulationWorker::saveClock(std::vector<uint8_t> &out, bool on, int phase)
+{
+    out.push_back(on);
+    for (int byte = 0; byte < 4; ++byte) {
+        out.push_back(static_cast<uint8_t>(static_cast<quint32>(phase) >> (8 * byte)));
+    }
+}
+
+void SimulationWorker::restoreClock(const uint8_t *in, bool &on, int &phase)
+{
+    on = in[0];
+    quint32 value = 0;
+    for (int byte = 0; byte < 4; ++byte) {
+        value |= static_cast<quint32>(in[1 + byte]) << (8 * byte);
+    }
+    phase = static_cast<int>(value);
+}
+
+void SimulationWorker::takeSnapshot(std::vector<uint8_t> &buffer)
+{
+    // Same size every time, so the buffer keeps its storage.
+    buffer.assign(m_netlist.signalData(), m_netlist.signalData() + m_netlist.signalCount());
+    for (int idx = 0; idx < m_clocks.size(); ++idx) {
+        saveClock(buffer, m_clocks.at(idx).on, clockPhase(idx));
+    }
+}
+
+void SimulationWorker::publish()
+{
+    takeSnapshot(m_buffers[m_back]);
+    m_back = m_middle.exchange(m_back | FreshSnapshot, std::memory_order_acq_rel) & SnapshotIndex;
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef SIMULATIONWORKER_H
+#define SIMULATIONWORKER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <QVector>
+
+#include "inputlog.h"
+#include "spscqueue.h"
+#include "timingwheel.h"
+
+class CompiledNetlist;
+class StateHistory;
+
+/**
+ * @brief The SimulationWorker class ticks a CompiledNetlist on its own thread.
+ *
+ * The worker owns the netlist while it runs: clocks are advanced inside the worker, input changes arrive
+ * through a lock-free queue and, after every tick, the signals are published as a snapshot. Snapshots are
+ * triple buffered, so the GUI takes the latest one with a single atomic exchange and never waits for a tick.
+ *
+ * Clock edges are scheduled on a TimingWheel. Once the netlist is quiescent and no input arrived, nothing can
+ * happen before the next edge, so simulated time jumps straight to it instead of sweeping every tick in between.
+ * A replayed InputLog bounds the jump the same way.
+ */
+class SimulationWorker
+{
+public:
+    //! The tick-based schedule of a Clock element, see Clock::updateClock().
+    struct ClockState {
+        int slot;
+        int interval;
+        int elapsed;
+        bool on;
+        bool disabled;
+    };
+
+    /**
+     * @brief Starts ticking every tickInterval milliseconds. With resetClocks, the first tick resets every clock.
+     * With a history, the state is recorded every historyInterval ticks, numbered from firstTick; the history
+     * belongs to the worker until stop().
+     * Input changes are appended to inputRecord, and the events of inputReplay are applied on their tick;
+     * inputSlots gives the slot of every input of the logs.
+     */
+    SimulationWorker(CompiledNetlist &netlist, const QVector<ClockState> &clocks, bool resetClocks, int tickInterval, int speed = 1,
+                     StateHistory *history = nullptr, quint64 firstTick = 0, int historyInterval = 1,
+                     InputLog *inputRecord = nullptr, const InputLog *inputReplay = nullptr, const QVector<int> &inputSlots = QVector<int>());
+    ~SimulationWorker();
+
+    SimulationWorker(const SimulationWorker &) = delete;
+    SimulationWorker &operator=(const SimulationWorker &) = delete;
+
+    /* GUI side. */
+
+    //! Queues a new value for an input slot. Returns false when the queue is full; try again later.
+    bool setInput(int slot, bool value);
+    /**
+     * @brief Takes the most recent snapshot published by the worker, if there is a new one, and returns it.
+     * The signals come first, then every clock as saveClock() writes it, in the order they were given.
+     */
+    const uint8_t *acquireSnapshot();
+    //! The snapshot taken by the last acquireSnapshot(). It stays valid until the next one.
+    const uint8_t *snapshot() const;
+
+    /**
+     * @brief Ticks run per tick interval: 1 is real time. With TurboSpeed, the worker ticks for the whole
+     * interval without sleeping and publishes one snapshot at its end.
+     */
+    void setSpeed(int speed);
+    static constexpr int TurboSpeed = 0;
+    //! Most ticks a quiescent netlist skips at once in turbo mode, when no clock edge is due before.
+    static constexpr quint64 TurboSpan = 1 << 16;
+
+    quint64 tickCount() const;
+    quint64 evaluationCount() const;
+    quint64 skippedEvaluationCount() const;
+
+    //! Stops and joins the thread. Afterwards the netlist belongs to the caller again.
+    void stop();
+
+    //! Bytes of a clock in a recorded state, after CompiledNetlist::saveState(): its value, then its phase.
+    static constexpr int ClockStateSize = 5;
+    static void saveClock(std::vector<uint8_t> &out, bool on, int phase);
+    static void restoreClock(const uint8_t *in, bool &on, int &phase);
+
+private:
+    struct InputChange {
+        int slot;
+        bool value;
+    };
+
+    static constexpr int FreshSnapshot = 4;
+    static constexpr int SnapshotIndex = 3;
+
+    void run();
+    //! Runs the next tick that can change anything, or moves to end when there is none up to it.
+    void step(quint64 end);
+    void tick();
+    void record();
+    //! Elapsed count of a clock modulo its interval, as Clock::elapsed() would have it after this tick.
+    int clockPhase(int idx) const;
+    //! Applies the replayed input changes due up to tick.
+    void replay(quint64 tick);
+    void publish();
+    //! Fills a snapshot buffer: the signals, then the clocks.
+    void takeSnapshot(std::vector<uint8_t> &buffer);
+
+    CompiledNetlist &m_netlist;
+    QVector<ClockState> m_clocks;
+    bool m_resetClocks;
+    TimingWheel m_wheel;
+    std::vector<int> m_dueClocks;
+    //! Next edge of every clock, which gives its phase.
+    std::vector<quint64> m_nextEdge;
+    quint64 m_now;
+    int m_tickInterval;
+    std::atomic<int> m_speed;
+
+    SpscQueue<InputChange, 1024> m_inputs;
+
+    InputLog *m_inputRecord;
+    InputLog::Reader m_inputReplay;
+    QVector<int> m_inputSlots;
+    //! Input number of every slot, -1 for the other slots.
+    std::vector<int> m_slotInputs;
+
+    StateHistory *m_history;
+    quint64 m_firstTick;
+    int m_historyInterval;
+    quint64 m_lastRecord;
+    bool m_recorded;
+    std::vector<uint8_t> m_stateVector;
+
+    /* Triple buffer: the worker writes m_back, the GUI reads m_front and they trade through m_middle. */
+    std::vector<uint8_t> m_buffers[3];
+    std::atomic<int> m_middle;
+    int m_back;
+    int m_front;
+
+    std::atomic<quint64> m_ticks;
+    std::atomic<quint64> m_evaluations;
+    std::atomic<quint64> m_skippedEvaluations;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_quit;
+    std::thread m_thread;
+};
+
+#endif // SIMULATIONWORKER_H
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @brief The SpscQueue class is a bounded, lock-free queue for exactly one producer thread and one consumer thread.
+ *
+ * Each side owns one index and only reads the other one, so push() and pop() never wait. Capacity must be a
+ * power of two; one slot is left empty to tell a full ring from an empty one.
+ */
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+    static_assert((Capacity >= 2) && ((Capacity & (Capacity - 1)) == 0), "Capacity must be a power of two");
+
+public:
+    SpscQueue()
+        : m_head(0)
+        , m_tail(0)
+    {
+    }
+
+    //! Producer side. Returns false, leaving the queue untouched, when it is full.
+    bool push(const T &value)
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        const size_t next = (tail + 1) & (Capacity - 1);
+        if (next == m_head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        m_items[tail] = value;
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    //! Consumer side. Returns false when the queue is empty.
+    bool pop(T &value)
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = m_items[head];
+        m_head.store((head + 1) & (Capacity - 1), std::memory_order_release);
+        return true;
+    }
+
+private:
+    T m_items[Capacity];
+    /* On separate cache lines, so the two threads do not invalidate each other on every operation. */
+    alignas(64) std::atomic<size_t> m_head;
+    alignas(64) std::atomic<size_t> m_tail;
+};
+
+#endif // SPSCQUEUE_H
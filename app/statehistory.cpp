@@ -0,0 +1,139 @@
+// Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "statehistory.h"
+
+#include <algorithm>
+
+StateHistory::StateHistory(size_t capacity, int groupSize)
+    : m_capacity(capacity)
+    , m_groupSize(std::max(groupSize, 1))
+    , m_size(0)
+{
+}
+
+void StateHistory::clear()
+{
+    m_groups.clear();
+    m_size = 0;
+    m_last.clear();
+}
+
+void StateHistory::record(quint64 tick, const std::vector<uint8_t> &state)
+{
+    truncate(tick);
+    if (m_groups.empty() || (static_cast<int>(m_groups.back().ticks.size()) == m_groupSize) || (m_last.size() != state.size())) {
+        m_groups.emplace_back();
+        Group &group = m_groups.back();
+        group.ticks.push_back(tick);
+        group.begin.push_back(0);
+        group.data = state;
+        m_size += state.size();
+    } else {
+        // Each changed byte is stored as the number of unchanged bytes before it, as a varint, then its value.
+        Group &group = m_groups.back();
+        const size_t before = group.data.size();
+        group.ticks.push_back(tick);
+        group.begin.push_back(before);
+        size_t next = 0;
+        for (size_t idx = 0; idx < state.size(); ++idx) {
+            if (state[idx] == m_last[idx]) {
+                continue;
+            }
+            size_t gap = idx - next;
+            while (gap >= 0x80) {
+                group.data.push_back(static_cast<uint8_t>(gap | 0x80));
+                gap >>= 7;
+            }
+            group.data.push_back(static_cast<uint8_t>(gap));
+            group.data.push_back(state[idx]);
+            next = idx + 1;
+        }
+        m_size += group.data.size() - before;
+    }
+    m_last = state;
+    while ((m_size > m_capacity) && (m_groups.size() > 1)) {
+        m_size -= m_groups.front().data.size();
+        m_groups.pop_front();
+    }
+}
+
+int StateHistory::count() const
+{
+    return m_groups.empty() ? 0 : static_cast<int>((m_groups.size() - 1) * m_groupSize + m_groups.back().ticks.size());
+}
+
+quint64 StateHistory::tick(int index) const
+{
+    return m_groups[index / m_groupSize].ticks[index % m_groupSize];
+}
+
+int StateHistory::indexOf(quint64 tick) const
+{
+    // Ticks only grow along the records.
+    int low = 0;
+    int high = count();
+    while (low < high) {
+        const int mid = (low + high) / 2;
+        if (this->tick(mid) <= tick) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low - 1;
+}
+
+void StateHistory::state(int index, std::vector<uint8_t> &out) const
+{
+    const Group &group = m_groups[index / m_groupSize];
+    const int last = index % m_groupSize;
+    const size_t size = (group.begin.size() > 1) ? group.begin[1] : group.data.size();
+    out.assign(group.data.cbegin(), group.data.cbegin() + size);
+    for (int record = 1; record <= last; ++record) {
+        const size_t end = (record + 1 < static_cast<int>(group.begin.size())) ? group.begin[record + 1] : group.data.size();
+        size_t pos = 0;
+        for (size_t idx = group.begin[record]; idx < end;) {
+            size_t gap = 0;
+            int shift = 0;
+            uint8_t byte;
+            do {
+                byte = group.data[idx++];
+                gap |= static_cast<size_t>(byte & 0x7f) << shift;
+                shift += 7;
+            } while (byte & 0x80);
+            pos += gap;
+            out[pos++] = group.data[idx++];
+        }
+    }
+}
+
+size_t StateHistory::size() const
+{
+    return m_size;
+}
+
+void StateHistory::truncate(quint64 tick)
+{
+    const int keep = (tick == 0) ? 0 : indexOf(tick - 1) + 1;
+    if (keep == count()) {
+        return;
+    }
+    if (keep == 0) {
+        clear();
+        return;
+    }
+    while (static_cast<int>(m_groups.size()) > (keep - 1) / m_groupSize + 1) {
+        m_size -= m_groups.back().data.size();
+        m_groups.pop_back();
+    }
+    Group &group = m_groups.back();
+    const int records = (keep - 1) % m_groupSize + 1;
+    if (records < static_cast<int>(group.begin.size())) {
+        m_size -= group.data.size() - group.begin[records];
+        group.data.resize(group.begin[records]);
+        group.ticks.resize(records);
+        group.begin.resize(records);
+    }
+    state(keep - 1, m_last);
+}
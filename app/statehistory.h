@@ -0,0 +1,62 @@
+/*
+ * Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef STATEHISTORY_H
+#define STATEHISTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include <QtGlobal>
+
+/**
+ * @brief The StateHistory class keeps recent simulation state vectors in a bounded amount of memory.
+ *
+ * Records are grouped: the first record of a group is a full copy of the state, the others only hold the bytes
+ * that changed since the previous record. Restoring any record therefore costs one copy and at most a group of
+ * small deltas. When the memory limit is reached, the oldest group is dropped as a whole.
+ *
+ * Records are addressed by index, from the oldest one still kept. Recording at a tick first drops the records
+ * of that tick and later ones, so stepping back and running again starts a new timeline.
+ */
+class StateHistory
+{
+public:
+    explicit StateHistory(size_t capacity = DefaultCapacity, int groupSize = 64);
+
+    static constexpr size_t DefaultCapacity = 16 * 1024 * 1024;
+
+    void clear();
+    void record(quint64 tick, const std::vector<uint8_t> &state);
+
+    int count() const;
+    quint64 tick(int index) const;
+    //! Index of the latest record at or before tick, -1 when there is none.
+    int indexOf(quint64 tick) const;
+    void state(int index, std::vector<uint8_t> &out) const;
+    //! Bytes used by the records.
+    size_t size() const;
+
+private:
+    struct Group {
+        std::vector<quint64> ticks;
+        //! Where each record starts in data; the first one is a full state, the others are deltas.
+        std::vector<size_t> begin;
+        std::vector<uint8_t> data;
+    };
+
+    void truncate(quint64 tick);
+
+    size_t m_capacity;
+    int m_groupSize;
+    std::deque<Group> m_groups;
+    size_t m_size;
+    //! The state of the last record, which the next delta is taken against.
+    std::vector<uint8_t> m_last;
+};
+
+#endif // STATEHISTORY_H
@@ -29,7 +29,7 @@ void ThemeManager::initialize()
     emit themeChanged();
 }
 
-ThemeAttrs ThemeManager::getAttrs() const
+const ThemeAttrs &ThemeManager::getAttrs() const
 {
     return m_attrs;
 }
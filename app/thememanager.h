@@ -62,7 +62,7 @@ public:
     void setTheme(const Theme &theme);
 
     void initialize();
-    ThemeAttrs getAttrs() const;
+    const ThemeAttrs &getAttrs() const;
 
 signals:
     void themeChanged();
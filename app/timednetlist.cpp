@@ -0,0 +1,188 @@
+// Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "timednetlist.h"
+
+#include <algorithm>
+
+#include "compilednetlist.h"
+
+TimedNetlist::TimedNetlist(const CompiledNetlist &netlist)
+    : m_netlist(netlist)
+    , m_delays(TypeCount)
+    , m_signals(netlist.m_signals)
+    , m_state(netlist.m_state)
+    , m_projected(netlist.m_signals)
+    , m_isDirty(netlist.m_types.size(), 1)
+    , m_sequence(0)
+    , m_lastChange(0)
+    , m_eventCount(0)
+{
+    for (int type = 0; type < TypeCount; ++type) {
+        m_delays[type] = defaultDelay(static_cast<LogicType>(type));
+    }
+    m_dirty.resize(m_isDirty.size());
+    for (size_t gate = 0; gate < m_dirty.size(); ++gate) {
+        m_dirty[gate] = static_cast<int>(gate);
+    }
+}
+
+int TimedNetlist::defaultDelay(LogicType type)
+{
+    switch (type) {
+    case LogicType::INPUT:
+    case LogicType::OUTPUT:
+    case LogicType::NODE:
+        return 0;
+    case LogicType::NOT:
+    case LogicType::AND:
+    case LogicType::OR:
+    case LogicType::NAND:
+    case LogicType::NOR:
+        return 1;
+    default:
+        return 2;
+    }
+}
+
+int TimedNetlist::delay(LogicType type) const
+{
+    return m_delays[static_cast<int>(type)];
+}
+
+void TimedNetlist::setDelay(LogicType type, int delay)
+{
+    m_delays[static_cast<int>(type)] = std::max(delay, 0);
+}
+
+bool TimedNetlist::value(int slot) const
+{
+    return m_signals[slot];
+}
+
+void TimedNetlist::setValue(int slot, bool value)
+{
+    m_projected[slot] = value;
+    if (m_signals[slot] != value) {
+        m_signals[slot] = value;
+        m_lastChange = m_wheel.now();
+        ++m_eventCount;
+        markFanout(slot);
+    }
+}
+
+uint64_t TimedNetlist::now() const
+{
+    return m_wheel.now();
+}
+
+uint64_t TimedNetlist::nextTime() const
+{
+    return m_dirty.empty() ? m_wheel.nextTime() : m_wheel.now();
+}
+
+void TimedNetlist::advance(uint64_t time)
+{
+    evaluateDirty();
+    while (m_wheel.nextTime() <= time) {
+        m_due.clear();
+        m_wheel.advance(m_wheel.nextTime(), m_due);
+        // A slot changed twice at the same time, within delta passes, ends with the value scheduled last.
+        std::sort(m_due.begin(), m_due.end(), [this](int a, int b) { return m_events[a].sequence < m_events[b].sequence; });
+        for (int idx : m_due) {
+            const Event &event = m_events[idx];
+            if (m_signals[event.slot] != event.value) {
+                m_signals[event.slot] = event.value;
+                m_lastChange = m_wheel.now();
+                ++m_eventCount;
+                markFanout(event.slot);
+            }
+            m_freeEvents.push_back(idx);
+        }
+        evaluateDirty();
+    }
+    m_wheel.advance(time, m_due);
+}
+
+uint64_t TimedNetlist::lastChange() const
+{
+    return m_lastChange;
+}
+
+quint64 TimedNetlist::eventCount() const
+{
+    return m_eventCount;
+}
+
+void TimedNetlist::markFanout(int slot)
+{
+    const int node = m_netlist.m_slotNode[slot];
+    for (int idx = m_netlist.m_fanoutBegin[node]; idx < m_netlist.m_fanoutBegin[node + 1]; ++idx) {
+        const int gate = m_netlist.m_fanout[idx];
+        if (!m_isDirty[gate]) {
+            m_isDirty[gate] = true;
+            m_dirty.push_back(gate);
+        }
+    }
+}
+
+void TimedNetlist::evaluateDirty()
+{
+    // Gates without delay feed the next pass within the same time unit; a loop of them gives up eventually.
+    const size_t passLimit = m_isDirty.size() + 1;
+    for (size_t pass = 0; !m_dirty.empty() && (pass < passLimit); ++pass) {
+        m_evaluating.swap(m_dirty);
+        std::sort(m_evaluating.begin(), m_evaluating.end());
+        for (int gate : m_evaluating) {
+            m_isDirty[gate] = false;
+        }
+        for (int gate : m_evaluating) {
+            evaluateGate(gate);
+        }
+        m_evaluating.clear();
+    }
+    for (int gate : m_dirty) {
+        m_isDirty[gate] = false;
+    }
+    m_dirty.clear();
+}
+
+void TimedNetlist::evaluateGate(int gate)
+{
+    const CompiledNetlist &nl = m_netlist;
+    const int outBegin = nl.m_outputBegin[gate];
+    const int outEnd = nl.m_outputEnd[gate];
+    // Gates that keep their outputs (latches, flip-flops) keep the value they are heading to.
+    m_scratch.assign(m_projected.cbegin() + outBegin, m_projected.cbegin() + outEnd);
+    CompiledNetlist::evaluate(nl.m_types[gate],
+                              m_signals.data(),
+                              nl.m_inputSlots.data() + nl.m_inputBegin[gate],
+                              nl.m_inputSlots.data() + nl.m_inputBegin[gate + 1],
+                              m_scratch.data(),
+                              m_state.data() + nl.m_stateBegin[gate]);
+    const int delay = m_delays[static_cast<int>(nl.m_types[gate])];
+    for (int slot = outBegin; slot < outEnd; ++slot) {
+        const uint8_t value = m_scratch[slot - outBegin];
+        if (value == m_projected[slot]) {
+            continue;
+        }
+        m_projected[slot] = value;
+        if (delay == 0) {
+            m_signals[slot] = value;
+            m_lastChange = m_wheel.now();
+            ++m_eventCount;
+            markFanout(slot);
+            continue;
+        }
+        int idx;
+        if (m_freeEvents.empty()) {
+            idx = static_cast<int>(m_events.size());
+            m_events.push_back({m_sequence++, slot, value});
+        } else {
+            idx = m_freeEvents.back();
+            m_freeEvents.pop_back();
+            m_events[idx] = {m_sequence++, slot, value};
+        }
+        m_wheel.schedule(idx, m_wheel.now() + static_cast<uint64_t>(delay));
+    }
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef TIMEDNETLIST_H
+#define TIMEDNETLIST_H
+
+#include <cstdint>
+#include <vector>
+
+#include "logicelement.h"
+#include "timingwheel.h"
+
+class CompiledNetlist;
+
+/**
+ * @brief The TimedNetlist class simulates a CompiledNetlist with a propagation delay on every gate.
+ *
+ * Time advances in integer delay units. When an input of a gate changes, the gate is evaluated right away
+ * and each output that differs from the value it is already heading to is scheduled to change after the delay
+ * of the gate type (transport delay), on a TimingWheel used as a calendar queue. Pulses shorter than a delay
+ * therefore travel through the circuit, so glitches and ripple settling show up. Gates with no delay change
+ * their outputs within the same time unit, in delta passes.
+ *
+ * The timed netlist starts from the current signals and state of the compiled netlist it was built from,
+ * which is left untouched, and evaluates every gate once at time zero. The zero-delay engines do not pay
+ * anything for it.
+ */
+class TimedNetlist
+{
+public:
+    static constexpr int TypeCount = static_cast<int>(LogicType::DEMUX) + 1;
+
+    explicit TimedNetlist(const CompiledNetlist &netlist);
+
+    //! Delay of a gate type before setDelay(): none for inputs, outputs and nodes, one or two units for the rest.
+    static int defaultDelay(LogicType type);
+    int delay(LogicType type) const;
+    //! Only affects changes scheduled afterwards.
+    void setDelay(LogicType type, int delay);
+
+    bool value(int slot) const;
+    //! Changes a signal at the current time, e.g. an input driven by a waveform.
+    void setValue(int slot, bool value);
+
+    uint64_t now() const;
+    //! Time of the next scheduled change, or TimingWheel::Never when the circuit has settled.
+    uint64_t nextTime() const;
+    //! Applies every change due up to time, included, and moves there.
+    void advance(uint64_t time);
+    //! Time of the last signal change, e.g. when the outputs settled after an input change.
+    uint64_t lastChange() const;
+    //! Signal changes applied so far.
+    quint64 eventCount() const;
+
+private:
+    struct Event {
+        quint64 sequence;
+        int slot;
+        uint8_t value;
+    };
+
+    void markFanout(int slot);
+    void evaluateDirty();
+    void evaluateGate(int gate);
+
+    const CompiledNetlist &m_netlist;
+    std::vector<int> m_delays;
+
+    std::vector<uint8_t> m_signals;
+    std::vector<uint8_t> m_state;
+    //! The value every slot has once the scheduled changes are applied.
+    std::vector<uint8_t> m_projected;
+    std::vector<uint8_t> m_scratch;
+
+    /* Gates to evaluate at the current time. */
+    std::vector<int> m_dirty;
+    std::vector<int> m_evaluating;
+    std::vector<uint8_t> m_isDirty;
+
+    /* Pending changes: the wheel holds indices into m_events; freed indices are reused. */
+    TimingWheel m_wheel;
+    std::vector<Event> m_events;
+    std::vector<int> m_freeEvents;
+    std::vector<int> m_due;
+    quint64 m_sequence;
+
+    uint64_t m_lastChange;
+    quint64 m_eventCount;
+};
+
+#endif // TIMEDNETLIST_H
@@ -0,0 +1,94 @@
+// Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "timingwheel.h"
+
+#include <algorithm>
+
+#include <QtGlobal>
+
+TimingWheel::TimingWheel(int slots)
+    : m_slots(slots)
+    , m_mask(static_cast<uint64_t>(slots) - 1)
+    , m_now(0)
+    , m_count(0)
+    , m_next(Never)
+    , m_nextValid(true)
+{
+    Q_ASSERT((slots > 0) && ((slots & (slots - 1)) == 0));
+}
+
+void TimingWheel::clear(uint64_t now)
+{
+    for (auto &slot : m_slots) {
+        slot.clear();
+    }
+    m_now = now;
+    m_count = 0;
+    m_next = Never;
+    m_nextValid = true;
+}
+
+void TimingWheel::schedule(int id, uint64_t time)
+{
+    Q_ASSERT(time > m_now);
+    m_slots[time & m_mask].emplace_back(time, id);
+    ++m_count;
+    if (m_nextValid) {
+        m_next = std::min(m_next, time);
+    }
+}
+
+uint64_t TimingWheel::now() const
+{
+    return m_now;
+}
+
+uint64_t TimingWheel::nextTime() const
+{
+    if (m_nextValid) {
+        return m_next;
+    }
+    m_nextValid = true;
+    m_next = Never;
+    if (m_count == 0) {
+        return m_next;
+    }
+    // One turn of the wheel, from the slot after now; a slot may also hold events of later turns.
+    for (uint64_t time = m_now + 1; time <= m_now + m_slots.size(); ++time) {
+        for (const auto &event : m_slots[time & m_mask]) {
+            if (event.first == time) {
+                m_next = time;
+                return m_next;
+            }
+        }
+    }
+    for (const auto &slot : m_slots) {
+        for (const auto &event : slot) {
+            m_next = std::min(m_next, event.first);
+        }
+    }
+    return m_next;
+}
+
+void TimingWheel::advance(uint64_t time, std::vector<int> &due)
+{
+    const uint64_t next = nextTime();
+    Q_ASSERT((time >= m_now) && (time <= next));
+    m_now = time;
+    if (next != time) {
+        return;
+    }
+    auto &slot = m_slots[time & m_mask];
+    for (size_t idx = 0; idx < slot.size();) {
+        if (slot[idx].first == time) {
+            due.push_back(slot[idx].second);
+            slot[idx] = slot.back();
+            slot.pop_back();
+            --m_count;
+        } else {
+            ++idx;
+        }
+    }
+    m_nextValid = false;
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef TIMINGWHEEL_H
+#define TIMINGWHEEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief The TimingWheel class schedules events at integer times, e.g. the next edge of every clock in ticks.
+ *
+ * It is a hashed wheel: an event goes to the slot of its time modulo the number of slots, so scheduling an
+ * event and taking the events due at a time only touch one slot. The time of the next event is searched slot
+ * by slot from the current time and cached; events more than one turn away are only considered when the rest
+ * of the wheel is empty. Events due at the same time are all returned together, so any number of periodic
+ * events with unrelated periods interleave exactly.
+ */
+class TimingWheel
+{
+public:
+    static constexpr uint64_t Never = ~uint64_t(0);
+
+    //! The number of slots must be a power of two.
+    explicit TimingWheel(int slots = 256);
+
+    //! Drops every event and moves to time now.
+    void clear(uint64_t now = 0);
+    //! Schedules id at a time after now().
+    void schedule(int id, uint64_t time);
+
+    uint64_t now() const;
+    //! Time of the earliest event, or Never.
+    uint64_t nextTime() const;
+    //! Moves to time, which must not be after nextTime(), and appends the events due at it to due.
+    void advance(uint64_t time, std::vector<int> &due);
+
+private:
+    /* (time, id) pairs, in the slot of their time. */
+    std::vector<std::vector<std::pair<uint64_t, int>>> m_slots;
+    uint64_t m_mask;
+    uint64_t m_now;
+    size_t m_count;
+    mutable uint64_t m_next;
+    mutable bool m_nextValid;
+};
+
+#endif // TIMINGWHEEL_H
@@ -0,0 +1,89 @@
+// Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "workerpool.h"
+
+WorkerPool::WorkerPool(int participants)
+    : m_job(nullptr)
+    , m_generation(0)
+    , m_running(0)
+    , m_quit(false)
+    , m_barrierCount(0)
+    , m_barrierGeneration(0)
+{
+    for (int participant = 1; participant < participants; ++participant) {
+        m_threads.emplace_back(&WorkerPool::work, this, participant);
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_start.notify_all();
+    for (std::thread &thread : m_threads) {
+        thread.join();
+    }
+}
+
+int WorkerPool::participantCount() const
+{
+    return static_cast<int>(m_threads.size()) + 1;
+}
+
+void WorkerPool::run(const std::function<void(int)> &job)
+{
+    if (m_threads.empty()) {
+        job(0);
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = &job;
+        m_running = static_cast<int>(m_threads.size());
+        ++m_generation;
+    }
+    m_start.notify_all();
+    job(0);
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_finished.wait(lock, [this] { return m_running == 0; });
+    m_job = nullptr;
+}
+
+void WorkerPool::barrier()
+{
+    // Barriers are short (one level of gates), so waiting threads spin instead of sleeping.
+    const unsigned generation = m_barrierGeneration.load(std::memory_order_acquire);
+    if (m_barrierCount.fetch_add(1, std::memory_order_acq_rel) + 1 == participantCount()) {
+        m_barrierCount.store(0, std::memory_order_relaxed);
+        m_barrierGeneration.fetch_add(1, std::memory_order_release);
+        return;
+    }
+    while (m_barrierGeneration.load(std::memory_order_acquire) == generation) {
+        std::this_thread::yield();
+    }
+}
+
+void WorkerPool::work(int participant)
+{
+    unsigned seen = 0;
+    for (;;) {
+        const std::function<void(int)> *job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_start.wait(lock, [&] { return m_quit || (m_generation != seen); });
+            if (m_quit) {
+                return;
+            }
+            seen = m_generation;
+            job = m_job;
+        }
+        (*job)(participant);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_running == 0) {
+            m_finished.notify_one();
+        }
+    }
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2015 - 2021, GIBIS-Unifesp and the wiRedPanda contributors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief The WorkerPool class keeps a set of threads alive to run one job on all of them at once.
+ *
+ * The calling thread takes part in every run() as participant 0, so a pool of N participants owns N - 1
+ * threads. Jobs split their work dynamically (e.g. by claiming chunks from an atomic counter) and can
+ * synchronize between phases with barrier(). Idle threads sleep until the next run().
+ */
+class WorkerPool
+{
+public:
+    explicit WorkerPool(int participants);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    int participantCount() const;
+
+    //! Runs job(participant) on every participant and returns once all of them finished.
+    void run(const std::function<void(int)> &job);
+
+    //! Waits until every participant of the current run() reached the barrier. Only valid inside a job.
+    void barrier();
+
+private:
+    void work(int participant);
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_start;
+    std::condition_variable m_finished;
+    const std::function<void(int)> *m_job;
+    unsigned m_generation;
+    int m_running;
+    bool m_quit;
+
+    std::atomic<int> m_barrierCount;
+    std::atomic<unsigned> m_barrierGeneration;
+};
+
+#endif // WORKERPOOL_H
@@ -43,7 +43,9 @@ include($$PWD/app/logicelement/logicelement.pri)
 SOURCES += \
     $$PWD/app/arduino/codegenerator.cpp \
     $$PWD/app/bewaveddolphin.cpp \
+    $$PWD/app/bytecodeprogram.cpp \
     $$PWD/app/clockDialog.cpp \
+    $$PWD/app/delaydialog.cpp \
     $$PWD/app/elementeditor.cpp \
     $$PWD/app/elementfactory.cpp \
     $$PWD/app/commands.cpp \
@@ -59,6 +61,8 @@ SOURCES += \
     $$PWD/app/icnotfoundexception.cpp \
     $$PWD/app/icprototype.cpp \
     $$PWD/app/icprototypeimpl.cpp \
+    $$PWD/app/ictemplate.cpp \
+    $$PWD/app/inputlog.cpp \
     $$PWD/app/label.cpp \
     $$PWD/app/lengthDialog.cpp \
     $$PWD/app/listitemwidget.cpp \
@@ -66,21 +70,33 @@ SOURCES += \
     $$PWD/app/nodes/qneconnection.cpp \
     $$PWD/app/nodes/qneport.cpp \
     $$PWD/app/recentfilescontroller.cpp \
+    $$PWD/app/sccscheduler.cpp \
     $$PWD/app/scene.cpp \
     $$PWD/app/scstop.cpp \
     $$PWD/app/serializationfunctions.cpp \
     $$PWD/app/simulationcontroller.cpp \
+    $$PWD/app/simulationworker.cpp \
     $$PWD/app/itemwithid.cpp \
     $$PWD/app/simplewaveform.cpp \
+    $$PWD/app/statehistory.cpp \
     $$PWD/app/thememanager.cpp \
+    $$PWD/app/timednetlist.cpp \
+    $$PWD/app/timingwheel.cpp \
     $$PWD/app/logicelement.cpp \
     $$PWD/app/elementmapping.cpp \
-    $$PWD/app/common.cpp
+    $$PWD/app/common.cpp \
+    $$PWD/app/compilednetlist.cpp \
+    $$PWD/app/nativecompiler.cpp \
+    $$PWD/app/parallelnetlist.cpp \
+    $$PWD/app/workerpool.cpp
 
 HEADERS  +=  \
   $$PWD/app/bewaveddolphin.h \
+    $$PWD/app/bytecodeprogram.h \
   $$PWD/app/clockDialog.h \
+    $$PWD/app/delaydialog.h \
     $$PWD/app/common.h \
+    $$PWD/app/compilednetlist.h \
   $$PWD/app/filehelper.h \
     $$PWD/app/graphicsviewzoom.h \
     $$PWD/app/arduino/codegenerator.h\
@@ -98,22 +114,33 @@ HEADERS  +=  \
   $$PWD/app/icnotfoundexception.h \
   $$PWD/app/icprototype.h \
   $$PWD/app/icprototypeimpl.h \
+  $$PWD/app/ictemplate.h \
+  $$PWD/app/inputlog.h \
     $$PWD/app/label.h \
   $$PWD/app/lengthDialog.h \
     $$PWD/app/listitemwidget.h \
     $$PWD/app/mainwindow.h \
     $$PWD/app/nodes/qneconnection.h \
     $$PWD/app/nodes/qneport.h \
+    $$PWD/app/nativecompiler.h \
+    $$PWD/app/parallelnetlist.h \
     $$PWD/app/recentfilescontroller.h \
+    $$PWD/app/sccscheduler.h \
     $$PWD/app/scene.h \
   $$PWD/app/scstop.h \
     $$PWD/app/serializationfunctions.h \
     $$PWD/app/simulationcontroller.h \
+    $$PWD/app/simulationworker.h \
+    $$PWD/app/spscqueue.h \
     $$PWD/app/itemwithid.h \
     $$PWD/app/simplewaveform.h \
+    $$PWD/app/statehistory.h \
     $$PWD/app/thememanager.h \
+    $$PWD/app/timednetlist.h \
+    $$PWD/app/timingwheel.h \
     $$PWD/app/logicelement.h \
-    $$PWD/app/elementmapping.h
+    $$PWD/app/elementmapping.h \
+    $$PWD/app/workerpool.h
 
 INCLUDEPATH += \
     $$PWD/app \
@@ -6,6 +6,7 @@
 #include "demux.h"
 #include "dlatch.h"
 #include "editor.h"
+#include "graphicsviewzoom.h"
 #include "ic.h"
 #include "inputbutton.h"
 #include "iostream"
@@ -14,6 +15,9 @@
 #include "led.h"
 #include "mux.h"
 #include "node.h"
+#include "qneport.h"
+#include "scene.h"
+#include "simulationcontroller.h"
 #include "srflipflop.h"
 #include "tflipflop.h"
 //#include "tlatch.h"
@@ -21,12 +25,17 @@
 #include "and.h"
 #include "dflipflop.h"
 #include "icmanager.h"
+#include "icmapping.h"
+#include "icprototype.h"
+#include "logicelement.h"
 #include "inputgnd.h"
 #include "inputvcc.h"
 #include "or.h"
 #include "qneport.h"
 
 #include <QDebug>
+#include <QGraphicsView>
+#include <QSignalSpy>
 #include <iostream>
 
 TestElements::TestElements(QObject *parent)
@@ -323,3 +332,85 @@ void TestElements::testICs()
         manager.loadIC(&ic, f.absoluteFilePath());
     }
 }
+
+void TestElements::testICTemplate()
+{
+    ICManager manager;
+    QString icFile = testFile("jkflipflop.panda");
+    IC ic;
+    manager.loadIC(&ic, icFile);
+    ICPrototype *prototype = manager.getPrototype(icFile);
+    QVERIFY(prototype);
+
+    /* Every instance is a separate copy of the same template. */
+    ICMapping *first = prototype->generateMapping();
+    ICMapping *second = prototype->generateMapping();
+    QVERIFY(first->canRun());
+    QVERIFY(!first->logicElements().isEmpty());
+    QCOMPARE(first->logicElements().size(), second->logicElements().size());
+    for (int elm = 0; elm < first->logicElements().size(); ++elm) {
+        LogicElement *elm1 = first->logicElements().at(elm);
+        LogicElement *elm2 = second->logicElements().at(elm);
+        QVERIFY(elm1 != elm2);
+        QCOMPARE(elm1->type(), elm2->type());
+        QCOMPARE(elm1->inputSize(), elm2->inputSize());
+        for (size_t in = 0; in < elm1->inputSize(); ++in) {
+            QCOMPARE(first->logicElements().indexOf(elm1->predecessor(in)), second->logicElements().indexOf(elm2->predecessor(in)));
+        }
+    }
+    for (int port = 0; port < prototype->inputSize(); ++port) {
+        QCOMPARE(first->getInput(port)->type(), LogicType::NODE);
+        QVERIFY(first->getInput(port) != second->getInput(port));
+    }
+    delete first;
+    delete second;
+}
+
+void TestElements::testSharedSkins()
+{
+    InputButton button1;
+    InputButton button2;
+    QCOMPARE(button1.getPixmap().cacheKey(), button2.getPixmap().cacheKey());
+    const qint64 offKey = button1.getPixmap().cacheKey();
+    button1.setOn(true);
+    QVERIFY(button1.getPixmap().cacheKey() != offKey);
+    button2.setOn(true);
+    QCOMPARE(button2.getPixmap().cacheKey(), button1.getPixmap().cacheKey());
+
+    /* Showing the skin already shown requests no repaint. */
+    const quint64 repaints = SimulationController::repaintCount();
+    button1.setOn(true);
+    QCOMPARE(SimulationController::repaintCount(), repaints);
+    button1.setOn(false);
+    QCOMPARE(button1.getPixmap().cacheKey(), offKey);
+}
+
+void TestElements::testZoomedOutStateColor()
+{
+    Scene scene;
+    auto *andItem = new And();
+    scene.addItem(andItem);
+    QGraphicsView view(&scene);
+
+    /* In full detail, the value of an unwired output shows nowhere. */
+    const quint64 repaints = SimulationController::repaintCount();
+    andItem->output()->setValue(1);
+    QCOMPARE(SimulationController::repaintCount(), repaints);
+
+    /* Zoomed out, the element is a block in the color of that value: all of it is repainted. */
+    view.setTransform(QTransform::fromScale(GraphicsViewZoom::minZoom, GraphicsViewZoom::minZoom));
+    QSignalSpy changed(&scene, &QGraphicsScene::changed);
+    andItem->output()->setValue(0);
+    QCOMPARE(SimulationController::repaintCount(), repaints + 1);
+    QTRY_VERIFY(!changed.isEmpty());
+    QRectF region;
+    for (const QList<QVariant> &args : qAsConst(changed)) {
+        const auto rects = args.at(0).value<QList<QRectF>>();
+        for (const QRectF &rect : rects) {
+            region |= rect;
+        }
+    }
+    QVERIFY(region.contains(andItem->sceneBoundingRect()));
+    andItem->output()->setValue(0);
+    QCOMPARE(SimulationController::repaintCount(), repaints + 1);
+}
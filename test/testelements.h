@@ -48,6 +48,10 @@ private slots:
 
     void testIC();
     void testICs();
+    void testICTemplate();
+
+    void testSharedSkins();
+    void testZoomedOutStateColor();
 };
 
 #endif /* TESTELEMENTS_H */
@@ -3,9 +3,13 @@
 
 #include "testfiles.h"
 
+#include <deque>
 #include <stdexcept>
 
+#include "bytecodeprogram.h"
 #include "commands.h"
+#include "compilednetlist.h"
+#include "elementmapping.h"
 #include "globalproperties.h"
 #include "mainwindow.h"
 #include "qneconnection.h"
@@ -20,6 +24,32 @@ void TestFiles::cleanup()
     delete editor;
 }
 
+QFileInfoList TestFiles::exampleFiles()
+{
+    /*  qDebug( ) << "CURRENTDIR: " << CURRENTDIR; */
+    QDir examplesDir(QString("%1/../examples/").arg(CURRENTDIR));
+    /*  qDebug( ) << "Examples dir:" << examplesDir.absolutePath( ); */
+    return examplesDir.entryInfoList(QStringList{"*.panda"});
+}
+
+bool TestFiles::loadExample(const QFileInfo &file)
+{
+    QFile pandaFile(file.absoluteFilePath());
+    GlobalProperties::currentFile = file.absoluteFilePath();
+    if (!pandaFile.open(QFile::ReadOnly)) {
+        qWarning() << "Could not open" << file.absoluteFilePath();
+        return false;
+    }
+    QDataStream ds(&pandaFile);
+    try {
+        editor->load(ds);
+    } catch (std::runtime_error &e) {
+        qWarning() << "Could not load the file! Error:" << e.what();
+        return false;
+    }
+    return true;
+}
+
 void TestFiles::testFiles()
 {
     /*  qDebug( ) << "CURRENTDIR: " << CURRENTDIR; */
@@ -81,3 +111,109 @@ void TestFiles::testFiles()
         outfile.remove();
     }
 }
+
+void TestFiles::testExampleEngines()
+{
+    /* The reference elements, the interpreted sweep and the bytecode program must agree on every example, and so
+     * must the netlist the editor builds, which folds the constants and prunes what the scene does not show. */
+    QFileInfoList files = exampleFiles();
+    QVERIFY(files.size() > 0);
+    for (const QFileInfo &f : qAsConst(files)) {
+        QVERIFY(loadExample(f));
+        ElementMapping mapping(editor->getScene()->getElements(), f.absoluteFilePath());
+        if (!mapping.canInitialize()) {
+            continue;
+        }
+        mapping.initialize();
+        mapping.sort();
+        const QVector<LogicElement *> &elms = mapping.logicElements();
+        CompiledNetlist interpreted(elms, mapping.loops());
+        interpreted.setBytecode(false);
+        CompiledNetlist bytecode(elms, mapping.loops());
+        QVERIFY(bytecode.bytecode());
+        CompiledNetlist hashed(elms, mapping.loops(), nullptr, nullptr, true);
+        const QSet<const LogicElement *> constants = mapping.constantElements();
+        const QSet<const LogicElement *> observed = mapping.observedElements();
+        CompiledNetlist production(elms, mapping.loops(), &constants, &observed, true);
+        quint32 seed = 1;
+        for (int tick = 0; tick < 200; ++tick) {
+            for (LogicElement *elm : elms) {
+                if ((elm->type() != LogicType::INPUT) || constants.contains(elm)) {
+                    continue;
+                }
+                for (size_t port = 0; port < elm->outputSize(); ++port) {
+                    seed = seed * 1103515245 + 12345;
+                    const bool value = (seed >> 16) & 1;
+                    elm->setOutputValue(port, value);
+                    interpreted.setValue(interpreted.outputSlot(elm, static_cast<int>(port)), value);
+                    bytecode.setValue(bytecode.outputSlot(elm, static_cast<int>(port)), value);
+                    hashed.setValue(hashed.outputSlot(elm, static_cast<int>(port)), value);
+                    production.setValue(production.outputSlot(elm, static_cast<int>(port)), value);
+                }
+            }
+            mapping.updateLogicElements();
+            interpreted.update();
+            bytecode.update();
+            hashed.update();
+            production.update();
+            for (LogicElement *elm : elms) {
+                for (size_t port = 0; port < elm->outputSize(); ++port) {
+                    const int slot = interpreted.outputSlot(elm, static_cast<int>(port));
+                    QCOMPARE(interpreted.value(slot), elm->getOutputValue(port));
+                    QCOMPARE(bytecode.value(slot), elm->getOutputValue(port));
+                    QCOMPARE(hashed.value(hashed.outputSlot(elm, static_cast<int>(port))), elm->getOutputValue(port));
+                    if (!production.isPruned(elm)) {
+                        QCOMPARE(production.value(production.outputSlot(elm, static_cast<int>(port))), elm->getOutputValue(port));
+                    }
+                }
+            }
+        }
+    }
+}
+
+void TestFiles::benchmarkStructuralHashing_data()
+{
+    QTest::addColumn<bool>("hashing");
+    QTest::newRow("plain") << false;
+    QTest::newRow("hashed") << true;
+}
+
+void TestFiles::benchmarkStructuralHashing()
+{
+    QFETCH(bool, hashing);
+    /* One tick of every example, with and without merging the duplicated gates. */
+    QFileInfoList files = exampleFiles();
+    QVERIFY(files.size() > 0);
+    /* Deques never move their elements, and the netlists point into the mappings. */
+    std::deque<ElementMapping> mappings;
+    std::deque<CompiledNetlist> netlists;
+    int sourceGates = 0;
+    int gates = 0;
+    int merged = 0;
+    for (const QFileInfo &f : qAsConst(files)) {
+        QVERIFY(loadExample(f));
+        mappings.emplace_back(editor->getScene()->getElements(), f.absoluteFilePath());
+        ElementMapping &mapping = mappings.back();
+        if (!mapping.canInitialize()) {
+            continue;
+        }
+        mapping.initialize();
+        mapping.sort();
+        netlists.emplace_back(mapping.logicElements(), mapping.loops(), nullptr, nullptr, hashing);
+        CompiledNetlist &netlist = netlists.back();
+        QVERIFY(netlist.gateCount() + netlist.mergedGateCount() <= netlist.sourceGateCount());
+        QVERIFY(hashing || (netlist.mergedGateCount() == 0));
+        sourceGates += netlist.sourceGateCount();
+        gates += netlist.gateCount();
+        merged += netlist.mergedGateCount();
+    }
+    QVERIFY(gates <= sourceGates);
+    if (hashing) {
+        QVERIFY(merged > 0);
+    }
+    QBENCHMARK {
+        for (CompiledNetlist &netlist : netlists) {
+            netlist.update();
+        }
+    }
+}
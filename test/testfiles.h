@@ -6,6 +6,7 @@
 #ifndef TESTFILES_H
 #define TESTFILES_H
 
+#include <QFileInfo>
 #include <QObject>
 #include <QTest>
 
@@ -15,6 +16,11 @@ class TestFiles : public QObject
 {
     Q_OBJECT
     Editor *editor;
+
+    QFileInfoList exampleFiles();
+    //! Loads an example into the editor. Returns false, with a warning, when it cannot be read.
+    bool loadExample(const QFileInfo &file);
+
 private slots:
 
     /* functions executed by QtTest before and after each test */
@@ -22,6 +28,9 @@ private slots:
     void cleanup();
 
     void testFiles();
+    void testExampleEngines();
+    void benchmarkStructuralHashing_data();
+    void benchmarkStructuralHashing();
 };
 
 #endif /* TESTFILES_H */
\ No newline at end of file
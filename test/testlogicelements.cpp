@@ -3,6 +3,25 @@
 
 #include "testlogicelements.h"
 
+#include <functional>
+#include <numeric>
+
+#include <QDateTime>
+#include <QDir>
+#include <QTemporaryDir>
+
+#include "bytecodeprogram.h"
+#include "compilednetlist.h"
+#include "inputlog.h"
+#include "nativecompiler.h"
+#include "parallelnetlist.h"
+#include "sccscheduler.h"
+#include "simulationworker.h"
+#include "statehistory.h"
+#include "timednetlist.h"
+#include "timingwheel.h"
+#include "workerpool.h"
+
 #include "logicelement/logicand.h"
 #include "logicelement/logicdemux.h"
 #include "logicelement/logicdflipflop.h"
@@ -20,6 +39,26 @@
 #include "logicelement/logicxnor.h"
 #include "logicelement/logicxor.h"
 
+namespace
+{
+/* The update path before the kernel table: inputs gathered into a vector<bool>, then a virtual call. */
+class LegacyGate
+{
+public:
+    virtual ~LegacyGate() = default;
+    virtual bool update(const std::vector<bool> &inputs) const = 0;
+};
+
+class LegacyAnd : public LegacyGate
+{
+public:
+    bool update(const std::vector<bool> &inputs) const override
+    {
+        return std::accumulate(inputs.begin(), inputs.end(), true, std::bit_and<bool>());
+    }
+};
+}
+
 TestLogicElements::TestLogicElements(QObject *parent)
     : QObject(parent)
 {
@@ -353,4 +392,891 @@ void TestLogicElements::testLogicTFlipFlop()
         QCOMPARE(static_cast<int>(elm.getOutputValue(0)), truthTable.at(test).at(5));
         QCOMPARE(static_cast<int>(elm.getOutputValue(1)), truthTable.at(test).at(6));
     }
-}
\ No newline at end of file
+}
+
+void TestLogicElements::testSelfFedFlipFlops()
+{
+    /* Flip-flops fed by their own outputs: inputs are sampled before the outputs change, as in the reference. */
+    LogicDFlipFlop dff;
+    LogicTFlipFlop tff;
+    LogicJKFlipFlop jkff;
+    dff.connectPredecessor(0, &dff, 1);
+    tff.connectPredecessor(0, &tff, 1);
+    jkff.connectPredecessor(0, &jkff, 1);
+    jkff.connectPredecessor(2, &jkff, 0);
+    for (LogicElement *elm : {static_cast<LogicElement *>(&dff), static_cast<LogicElement *>(&tff)}) {
+        elm->connectPredecessor(1, sw.at(0), 0);
+        elm->connectPredecessor(2, sw.at(1), 0);
+        elm->connectPredecessor(3, sw.at(2), 0);
+    }
+    jkff.connectPredecessor(1, sw.at(0), 0);
+    jkff.connectPredecessor(3, sw.at(1), 0);
+    jkff.connectPredecessor(4, sw.at(2), 0);
+
+    const QVector<LogicElement *> elms{sw.at(0), sw.at(1), sw.at(2), &dff, &tff, &jkff};
+    CompiledNetlist netlist(elms);
+    /* A preset or clear right before a clock edge is where sampling after writing Q shows. */
+    for (int tick = 0; tick < 64; ++tick) {
+        const bool values[3] = {static_cast<bool>(tick & 1), tick % 5 != 2, tick % 7 != 4};
+        for (int in = 0; in < 3; ++in) {
+            sw.at(in)->setOutputValue(values[in]);
+            netlist.setValue(netlist.outputSlot(sw.at(in)), values[in]);
+        }
+        for (LogicElement *elm : elms) {
+            elm->updateLogic();
+        }
+        netlist.update();
+        for (LogicElement *elm : elms) {
+            for (size_t port = 0; port < elm->outputSize(); ++port) {
+                QCOMPARE(netlist.value(netlist.outputSlot(elm, static_cast<int>(port))), elm->getOutputValue(port));
+            }
+        }
+    }
+}
+
+void TestLogicElements::testCompiledNetlist()
+{
+    LogicAnd andElm(2);
+    LogicNot notElm;
+    LogicDFlipFlop dff;
+    LogicJKFlipFlop jkff;
+    LogicMux mux;
+    andElm.connectPredecessor(0, sw.at(0), 0);
+    andElm.connectPredecessor(1, sw.at(1), 0);
+    notElm.connectPredecessor(0, &andElm, 0);
+    dff.connectPredecessor(0, &notElm, 0);
+    dff.connectPredecessor(1, sw.at(2), 0);
+    dff.connectPredecessor(2, sw.at(3), 0);
+    dff.connectPredecessor(3, sw.at(3), 0);
+    jkff.connectPredecessor(0, &dff, 0);
+    jkff.connectPredecessor(1, sw.at(2), 0);
+    jkff.connectPredecessor(2, &andElm, 0);
+    jkff.connectPredecessor(3, sw.at(3), 0);
+    jkff.connectPredecessor(4, sw.at(4), 0);
+    mux.connectPredecessor(0, &jkff, 0);
+    mux.connectPredecessor(1, &jkff, 1);
+    mux.connectPredecessor(2, sw.at(0), 0);
+
+    const QVector<LogicElement *> elms{sw.at(0), sw.at(1), sw.at(2), sw.at(3), sw.at(4), &andElm, &notElm, &dff, &jkff, &mux};
+    CompiledNetlist netlist(elms);
+    QCOMPARE(netlist.gateCount(), 5);
+
+    /* The reference LogicElement graph and the compiled netlist must agree on every tick. */
+    for (int tick = 0; tick < 64; ++tick) {
+        for (int in = 0; in < sw.size(); ++in) {
+            const bool value = (in >= 3) ? (tick % 23 != 0) : ((tick >> in) & 1);
+            sw.at(in)->setOutputValue(value);
+            netlist.setValue(netlist.outputSlot(sw.at(in)), value);
+        }
+        for (LogicElement *elm : elms) {
+            elm->updateLogic();
+        }
+        netlist.update();
+        for (LogicElement *elm : elms) {
+            for (size_t port = 0; port < elm->outputSize(); ++port) {
+                QCOMPARE(netlist.value(netlist.outputSlot(elm, static_cast<int>(port))), elm->getOutputValue(port));
+            }
+        }
+    }
+}
+
+void TestLogicElements::testEventDrivenNetlist()
+{
+    /* Cross-coupled NOR latch (a back edge) driving a T flip-flop and a wide AND. */
+    LogicNor norQ(2);
+    LogicNor norQn(2);
+    LogicTFlipFlop tff;
+    LogicAnd andElm(3);
+    norQ.connectPredecessor(0, sw.at(0), 0);
+    norQ.connectPredecessor(1, &norQn, 0);
+    norQn.connectPredecessor(0, sw.at(1), 0);
+    norQn.connectPredecessor(1, &norQ, 0);
+    tff.connectPredecessor(0, &norQ, 0);
+    tff.connectPredecessor(1, sw.at(2), 0);
+    tff.connectPredecessor(2, sw.at(3), 0);
+    tff.connectPredecessor(3, sw.at(3), 0);
+    andElm.connectPredecessor(0, &tff, 0);
+    andElm.connectPredecessor(1, &norQn, 0);
+    andElm.connectPredecessor(2, sw.at(4), 0);
+
+    const QVector<LogicElement *> elms{sw.at(0), sw.at(1), sw.at(2), sw.at(3), sw.at(4), &norQ, &norQn, &tff, &andElm};
+    CompiledNetlist sweep(elms);
+    CompiledNetlist events(elms);
+    events.setEventDriven(true);
+    QVERIFY(events.isEventDriven());
+
+    for (int tick = 0; tick < 128; ++tick) {
+        for (int in = 0; in < sw.size(); ++in) {
+            const bool value = (in == 3) || ((tick >> (in + 2)) & 1);
+            sweep.setValue(sweep.outputSlot(sw.at(in)), value);
+            events.setValue(events.outputSlot(sw.at(in)), value);
+        }
+        sweep.update();
+        events.update();
+        for (int slot = 0; slot < sweep.signalCount(); ++slot) {
+            QCOMPARE(events.value(slot), sweep.value(slot));
+        }
+    }
+    QCOMPARE(sweep.skippedEvaluationCount(), quint64(0));
+    QVERIFY(events.skippedEvaluationCount() > 0);
+    QCOMPARE(events.evaluationCount() + events.skippedEvaluationCount(), sweep.evaluationCount());
+}
+
+void TestLogicElements::testSettledLoop()
+{
+    /* A NOR latch feeding an AND gate: the latch is a combinational loop, settled within the tick. */
+    LogicNor norQ(2);
+    LogicNor norQn(2);
+    LogicAnd andElm(2);
+    norQ.connectPredecessor(0, sw.at(0), 0);
+    norQ.connectPredecessor(1, &norQn, 0);
+    norQn.connectPredecessor(0, sw.at(1), 0);
+    norQn.connectPredecessor(1, &norQ, 0);
+    andElm.connectPredecessor(0, &norQ, 0);
+    andElm.connectPredecessor(1, sw.at(2), 0);
+
+    const QVector<LogicElement *> elms{sw.at(0), sw.at(1), sw.at(2), &norQ, &norQn, &andElm};
+    SccScheduler scheduler(elms.size());
+    for (int node = 0; node < elms.size(); ++node) {
+        for (LogicElement *succ : elms.at(node)->successors()) {
+            if (elms.contains(succ)) {
+                scheduler.addEdge(node, elms.indexOf(succ));
+            }
+        }
+    }
+    scheduler.run();
+    QCOMPARE(scheduler.loopCount(), 1);
+    QCOMPARE(scheduler.loop(3), 0);
+    QCOMPARE(scheduler.loop(4), 0);
+    QCOMPARE(scheduler.loop(5), -1);
+    QCOMPARE(scheduler.priority(3), scheduler.priority(4));
+    QVERIFY(scheduler.priority(3) > scheduler.priority(5));
+
+    const QVector<QVector<LogicElement *>> loops{{&norQ, &norQn}};
+    CompiledNetlist sweep(elms, loops);
+    sweep.setBytecode(false);
+    CompiledNetlist bytecode(elms, loops);
+    CompiledNetlist events(elms, loops);
+    events.setEventDriven(true);
+    CompiledNetlist unsettled(elms);
+    unsettled.setBytecode(false);
+    QCOMPARE(sweep.loopCount(), 1);
+    const QVector<CompiledNetlist *> netlists{&sweep, &bytecode, &events, &unsettled};
+    const auto tick = [this, &netlists](bool reset, bool set) {
+        for (CompiledNetlist *netlist : netlists) {
+            netlist->setValue(netlist->outputSlot(sw.at(0)), reset);
+            netlist->setValue(netlist->outputSlot(sw.at(1)), set);
+            netlist->setValue(netlist->outputSlot(sw.at(2)), true);
+            netlist->update();
+        }
+    };
+    tick(true, false);
+    tick(false, false);
+    // Setting a reset latch takes two passes: a single sweep leaves both outputs low.
+    tick(false, true);
+    for (CompiledNetlist *netlist : {&sweep, &bytecode, &events}) {
+        QVERIFY(netlist->value(netlist->outputSlot(&norQ)));
+        QVERIFY(!netlist->value(netlist->outputSlot(&norQn)));
+        QVERIFY(netlist->value(netlist->outputSlot(&andElm)));
+    }
+    QVERIFY(!unsettled.value(unsettled.outputSlot(&norQ)));
+    QVERIFY(!unsettled.value(unsettled.outputSlot(&norQn)));
+
+    /* A NOT gate reading itself never settles: every engine stops after the same number of passes. */
+    LogicNot ring;
+    ring.connectPredecessor(0, &ring, 0);
+    const QVector<LogicElement *> ringElms{&ring};
+    const QVector<QVector<LogicElement *>> ringLoops{ringElms};
+    CompiledNetlist ringSweep(ringElms, ringLoops);
+    ringSweep.setBytecode(false);
+    CompiledNetlist ringBytecode(ringElms, ringLoops);
+    for (int idx = 0; idx < 3; ++idx) {
+        ringSweep.update();
+        ringBytecode.update();
+        QCOMPARE(ringBytecode.value(0), ringSweep.value(0));
+    }
+
+    /* Long ripple chains are scheduled without recursion. */
+    const int chain = 1 << 20;
+    SccScheduler ripple(chain);
+    for (int node = 0; node + 1 < chain; ++node) {
+        ripple.addEdge(node, node + 1);
+    }
+    ripple.run();
+    QCOMPARE(ripple.priority(0), chain);
+    QCOMPARE(ripple.loopCount(), 0);
+}
+
+void TestLogicElements::testConstantFolding()
+{
+    LogicInput vcc(true);
+    LogicInput gnd(false);
+    /* Decided by a constant, so folded: NAND with GND, and the NOT of a folded gate. */
+    LogicNand nandElm(2);
+    nandElm.connectPredecessor(0, sw.at(0), 0);
+    nandElm.connectPredecessor(1, &gnd, 0);
+    LogicNot notElm;
+    notElm.connectPredecessor(0, &nandElm, 0);
+    /* Left with their variable inputs: AND with VCC, XOR with VCC and a MUX with a constant select. */
+    LogicAnd andElm(3);
+    andElm.connectPredecessor(0, sw.at(0), 0);
+    andElm.connectPredecessor(1, &vcc, 0);
+    andElm.connectPredecessor(2, sw.at(1), 0);
+    LogicXor xorElm(2);
+    xorElm.connectPredecessor(0, &vcc, 0);
+    xorElm.connectPredecessor(1, sw.at(1), 0);
+    LogicMux mux;
+    mux.connectPredecessor(0, sw.at(0), 0);
+    mux.connectPredecessor(1, &xorElm, 0);
+    mux.connectPredecessor(2, &vcc, 0);
+    const QVector<LogicElement *> elms{sw.at(0), sw.at(1), &vcc, &gnd, &nandElm, &notElm, &andElm, &xorElm, &mux};
+    const QSet<const LogicElement *> constants{&vcc, &gnd};
+    CompiledNetlist folded(elms, {}, &constants);
+    CompiledNetlist reference(elms);
+    QCOMPARE(folded.foldedGateCount(), 2);
+    // The MUX is left as a wire to the XOR, which is collapsed into an alias.
+    QCOMPARE(folded.aliasCount(), 1);
+    QCOMPARE(folded.gateCount(), reference.gateCount() - 3);
+    for (int inputs = 0; inputs < 4; ++inputs) {
+        for (CompiledNetlist *netlist : {&folded, &reference}) {
+            netlist->setValue(netlist->outputSlot(sw.at(0)), inputs & 1);
+            netlist->setValue(netlist->outputSlot(sw.at(1)), inputs & 2);
+            netlist->update();
+        }
+        for (const LogicElement *elm : elms.mid(4)) {
+            QCOMPARE(folded.value(folded.outputSlot(elm)), reference.value(reference.outputSlot(elm)));
+        }
+    }
+    QCOMPARE(folded.value(folded.outputSlot(&nandElm)), true);
+    QCOMPARE(folded.value(folded.outputSlot(&notElm)), false);
+}
+
+void TestLogicElements::testBufferAliases()
+{
+    /* A chain of nodes, like the port nodes of nested ICs, between an input and a NOT, which also feeds a node
+     * read before it is evaluated. */
+    LogicNode first;
+    first.connectPredecessor(0, sw.at(0), 0);
+    LogicNode second;
+    second.connectPredecessor(0, &first, 0);
+    LogicNode early;
+    LogicNode third;
+    third.connectPredecessor(0, &second, 0);
+    LogicAnd andElm(2);
+    andElm.connectPredecessor(0, &third, 0);
+    andElm.connectPredecessor(1, &early, 0);
+    LogicNot notElm;
+    notElm.connectPredecessor(0, &third, 0);
+    early.connectPredecessor(0, &notElm, 0);
+    const QVector<LogicElement *> elms{sw.at(0), &first, &second, &early, &third, &andElm, &notElm};
+    const QSet<const LogicElement *> constants;
+    CompiledNetlist aliased(elms, {}, &constants);
+    CompiledNetlist events(elms, {}, &constants);
+    events.setEventDriven(true);
+    CompiledNetlist reference(elms);
+    QCOMPARE(aliased.aliasCount(), 3);
+    QCOMPARE(aliased.gateCount(), reference.gateCount() - 3);
+    QCOMPARE(aliased.outputSlot(&third), aliased.outputSlot(sw.at(0)));
+    QCOMPARE(aliased.inputSlot(&notElm), aliased.outputSlot(sw.at(0)));
+    for (int tick = 0; tick < 6; ++tick) {
+        for (CompiledNetlist *netlist : {&aliased, &events, &reference}) {
+            netlist->setValue(netlist->outputSlot(sw.at(0)), tick & 2);
+            netlist->update();
+        }
+        for (const LogicElement *elm : elms.mid(1)) {
+            QCOMPARE(aliased.value(aliased.outputSlot(elm)), reference.value(reference.outputSlot(elm)));
+            QCOMPARE(events.value(events.outputSlot(elm)), reference.value(reference.outputSlot(elm)));
+        }
+    }
+}
+
+void TestLogicElements::testUnobservedPruning()
+{
+    /* Only the NOT is shown. The XOR feeds nothing shown and is pruned; the flip-flop keeps state, so it stays. */
+    LogicAnd andElm(2);
+    andElm.connectPredecessor(0, sw.at(0), 0);
+    andElm.connectPredecessor(1, sw.at(1), 0);
+    LogicNot notElm;
+    notElm.connectPredecessor(0, &andElm, 0);
+    LogicXor xorElm(2);
+    xorElm.connectPredecessor(0, &andElm, 0);
+    xorElm.connectPredecessor(1, sw.at(2), 0);
+    LogicDFlipFlop flipflop;
+    flipflop.connectPredecessor(0, sw.at(2), 0);
+    flipflop.connectPredecessor(1, sw.at(0), 0);
+    flipflop.connectPredecessor(2, sw.at(3), 0);
+    flipflop.connectPredecessor(3, sw.at(3), 0);
+    const QVector<LogicElement *> elms{sw.at(0), sw.at(1), sw.at(2), sw.at(3), &andElm, &notElm, &xorElm, &flipflop};
+    QSet<const LogicElement *> observed{&notElm};
+    CompiledNetlist pruned(elms, {}, nullptr, &observed);
+    CompiledNetlist reference(elms);
+    QCOMPARE(pruned.prunedGateCount(), 1);
+    QVERIFY(pruned.isPruned(&xorElm));
+    QVERIFY(!pruned.isPruned(&flipflop));
+    const auto tick = [&](CompiledNetlist &netlist, int inputs) {
+        for (int in = 0; in < 4; ++in) {
+            netlist.setValue(netlist.outputSlot(sw.at(in)), (in == 3) || (inputs & (1 << in)));
+        }
+        netlist.update();
+    };
+    for (int inputs = 0; inputs < 8; ++inputs) {
+        tick(pruned, inputs);
+        tick(reference, inputs);
+        QCOMPARE(pruned.value(pruned.outputSlot(&notElm)), reference.value(reference.outputSlot(&notElm)));
+        QCOMPARE(pruned.value(pruned.outputSlot(&flipflop)), reference.value(reference.outputSlot(&flipflop)));
+    }
+    /* Observed again: the rebuilt netlist takes the state and the XOR is right after one tick. */
+    observed.insert(&xorElm);
+    CompiledNetlist revived(elms, {}, nullptr, &observed);
+    QCOMPARE(revived.prunedGateCount(), 0);
+    revived.copyState(pruned);
+    tick(revived, 5);
+    tick(reference, 5);
+    for (const LogicElement *elm : elms.mid(4)) {
+        QCOMPARE(revived.value(revived.outputSlot(elm)), reference.value(reference.outputSlot(elm)));
+    }
+}
+
+void TestLogicElements::testStructuralHashing()
+{
+    /* The same decoder term twice, inputs swapped, an inverter pair and two MUXes whose data inputs differ. */
+    LogicAnd term(2);
+    term.connectPredecessor(0, sw.at(0), 0);
+    term.connectPredecessor(1, sw.at(1), 0);
+    LogicAnd copy(2);
+    copy.connectPredecessor(0, sw.at(1), 0);
+    copy.connectPredecessor(1, sw.at(0), 0);
+    LogicNot inverted;
+    inverted.connectPredecessor(0, &copy, 0);
+    LogicNot twice;
+    twice.connectPredecessor(0, &inverted, 0);
+    LogicOr orElm(2);
+    orElm.connectPredecessor(0, &twice, 0);
+    orElm.connectPredecessor(1, sw.at(2), 0);
+    LogicMux mux;
+    mux.connectPredecessor(0, &term, 0);
+    mux.connectPredecessor(1, sw.at(2), 0);
+    mux.connectPredecessor(2, sw.at(0), 0);
+    LogicMux swapped;
+    swapped.connectPredecessor(0, sw.at(2), 0);
+    swapped.connectPredecessor(1, &copy, 0);
+    swapped.connectPredecessor(2, sw.at(0), 0);
+    const QVector<LogicElement *> elms{sw.at(0), sw.at(1), sw.at(2), &term, &copy, &inverted, &twice, &orElm, &mux, &swapped};
+    CompiledNetlist hashed(elms, {}, nullptr, nullptr, true);
+    CompiledNetlist reference(elms);
+    QCOMPARE(hashed.mergedGateCount(), 2);
+    QCOMPARE(hashed.sourceGateCount(), reference.gateCount());
+    QCOMPARE(hashed.gateCount(), reference.gateCount() - 2);
+    QCOMPARE(hashed.outputSlot(&copy), hashed.outputSlot(&term));
+    QCOMPARE(hashed.inputSlot(&orElm), hashed.outputSlot(&term));
+    for (int inputs = 0; inputs < 8; ++inputs) {
+        for (CompiledNetlist *netlist : {&hashed, &reference}) {
+            for (int in = 0; in < 3; ++in) {
+                netlist->setValue(netlist->outputSlot(sw.at(in)), inputs & (1 << in));
+            }
+            netlist->update();
+        }
+        for (const LogicElement *elm : elms.mid(3)) {
+            QCOMPARE(hashed.value(hashed.outputSlot(elm)), reference.value(reference.outputSlot(elm)));
+        }
+    }
+}
+
+void TestLogicElements::testTimingWheel()
+{
+    /* Clocks with unrelated intervals, one longer than a turn of the wheel, against per-tick counting. */
+    const QVector<int> intervals{3, 7, 300};
+    QVector<int> elapsed{0, 5, 299};
+    TimingWheel wheel;
+    for (int clk = 0; clk < intervals.size(); ++clk) {
+        wheel.schedule(clk, static_cast<uint64_t>(intervals.at(clk) - elapsed.at(clk)));
+    }
+    QCOMPARE(wheel.nextTime(), uint64_t(1));
+    std::vector<int> due;
+    for (uint64_t tick = 1; tick <= 2000; ++tick) {
+        QVector<int> expected;
+        for (int clk = 0; clk < intervals.size(); ++clk) {
+            if ((++elapsed[clk] % intervals.at(clk)) == 0) {
+                expected.append(clk);
+            }
+        }
+        QCOMPARE(wheel.nextTime() == tick, !expected.isEmpty());
+        if (expected.isEmpty()) {
+            continue;
+        }
+        due.clear();
+        wheel.advance(tick, due);
+        std::sort(due.begin(), due.end());
+        QCOMPARE(QVector<int>(due.cbegin(), due.cend()), expected);
+        for (int clk : due) {
+            wheel.schedule(clk, tick + static_cast<uint64_t>(intervals.at(clk)));
+        }
+    }
+    wheel.clear(2000);
+    QCOMPARE(wheel.nextTime(), TimingWheel::Never);
+
+    /* A T flip-flop: once an update changes nothing, updates are skipped until the clock input changes. */
+    LogicTFlipFlop tff;
+    tff.connectPredecessor(0, sw.at(0), 0);
+    tff.connectPredecessor(1, sw.at(1), 0);
+    tff.connectPredecessor(2, sw.at(2), 0);
+    tff.connectPredecessor(3, sw.at(2), 0);
+    const QVector<LogicElement *> elms{sw.at(0), sw.at(1), sw.at(2), &tff};
+    CompiledNetlist reference(elms);
+    CompiledNetlist netlist(elms);
+    for (CompiledNetlist *nl : {&reference, &netlist}) {
+        nl->setValue(nl->outputSlot(sw.at(0)), true);
+        nl->setValue(nl->outputSlot(sw.at(2)), true);
+    }
+    for (int tick = 0; tick < 64; ++tick) {
+        const bool clock = ((tick / 8) & 1) == 0;
+        reference.setValue(reference.outputSlot(sw.at(1)), clock);
+        netlist.setValue(netlist.outputSlot(sw.at(1)), clock);
+        reference.update();
+        netlist.updateIfActive();
+        QCOMPARE(netlist.isQuiescent(), (tick % 8) != 0);
+        for (int slot = 0; slot < reference.signalCount(); ++slot) {
+            QCOMPARE(netlist.value(slot), reference.value(slot));
+        }
+    }
+    QVERIFY(netlist.skippedEvaluationCount() > 0);
+    QCOMPARE(netlist.evaluationCount() + netlist.skippedEvaluationCount(), reference.evaluationCount());
+}
+
+void TestLogicElements::testWorkerSpeed()
+{
+    /* A clock with an edge every 1000 ticks and an inverter: quiescent between the edges. */
+    LogicNot notElm;
+    notElm.connectPredecessor(0, sw.at(0), 0);
+    const QVector<LogicElement *> elms{sw.at(0), &notElm};
+    CompiledNetlist netlist(elms);
+    const QVector<SimulationWorker::ClockState> clocks{{netlist.outputSlot(sw.at(0)), 1000, 0, true, false}};
+    {
+        /* The first interval runs right away; the next one is a minute later. */
+        SimulationWorker worker(netlist, clocks, true, 60000, 7);
+        QTRY_COMPARE(worker.tickCount(), quint64(7));
+        QTest::qWait(20);
+        QCOMPARE(worker.tickCount(), quint64(7));
+    }
+    {
+        /* Every interval runs speed ticks, and stop() waits for the interval in progress. */
+        SimulationWorker worker(netlist, clocks, true, 1, 7);
+        QTRY_VERIFY(worker.tickCount() >= 3 * 7);
+        worker.stop();
+        QCOMPARE(worker.tickCount() % 7, quint64(0));
+    }
+    {
+        /* Turbo jumps over the quiescent ticks, up to the next edge or TurboSpan ticks at once. */
+        const quint64 evaluations = netlist.evaluationCount();
+        SimulationWorker worker(netlist, clocks, true, 10, SimulationWorker::TurboSpeed);
+        QTRY_VERIFY(worker.tickCount() > 2 * SimulationWorker::TurboSpan);
+        worker.stop();
+        /* One sweep on every edge, and one more to find the netlist settled. */
+        const quint64 sweeps = 2 * (worker.tickCount() / 1000 + 2);
+        QVERIFY(worker.evaluationCount() - evaluations <= sweeps * static_cast<quint64>(netlist.gateCount()));
+    }
+}
+
+void TestLogicElements::testTimedNetlist()
+{
+    /* a AND (NOT a): a static hazard, which a zero-delay simulation never shows. */
+    LogicNot notElm;
+    LogicAnd andElm(2);
+    notElm.connectPredecessor(0, sw.at(0), 0);
+    andElm.connectPredecessor(0, sw.at(0), 0);
+    andElm.connectPredecessor(1, &notElm, 0);
+    /* A chain of inverters: the last one follows the first input after the sum of the delays. */
+    QVector<LogicNot *> chain(9);
+    for (int idx = 0; idx < chain.size(); ++idx) {
+        chain[idx] = new LogicNot();
+        chain[idx]->connectPredecessor(0, (idx == 0) ? static_cast<LogicElement *>(sw.at(1)) : chain.at(idx - 1), 0);
+    }
+    QVector<LogicElement *> elms{sw.at(0), sw.at(1), &notElm, &andElm};
+    for (LogicNot *elm : chain) {
+        elms.append(elm);
+    }
+    CompiledNetlist netlist(elms);
+    netlist.update();
+
+    TimedNetlist timed(netlist);
+    timed.setDelay(LogicType::AND, 1);
+    timed.setDelay(LogicType::NOT, 1);
+    timed.advance(100);
+    QCOMPARE(timed.nextTime(), TimingWheel::Never);
+    timed.setValue(netlist.outputSlot(sw.at(0)), true);
+    timed.setValue(netlist.outputSlot(sw.at(1)), true);
+    const int andSlot = netlist.outputSlot(&andElm);
+    const int chainSlot = netlist.outputSlot(chain.last());
+    const bool chainBefore = timed.value(chainSlot);
+    QVector<bool> glitch;
+    for (uint64_t time = 100; time <= 112; ++time) {
+        timed.advance(time);
+        glitch.append(timed.value(andSlot));
+        QCOMPARE(timed.value(chainSlot), (time < 109) ? chainBefore : !chainBefore);
+    }
+    QCOMPARE(glitch.mid(0, 4), QVector<bool>({false, true, false, false}));
+    QCOMPARE(timed.lastChange(), uint64_t(109));
+    QCOMPARE(timed.nextTime(), TimingWheel::Never);
+
+    /* Once settled, the timed signals are the zero-delay ones. */
+    netlist.setValue(netlist.outputSlot(sw.at(0)), true);
+    netlist.setValue(netlist.outputSlot(sw.at(1)), true);
+    netlist.update();
+    for (int slot = 0; slot < netlist.signalCount(); ++slot) {
+        QCOMPARE(timed.value(slot), netlist.value(slot));
+    }
+    qDeleteAll(chain);
+}
+
+void TestLogicElements::testStateHistory()
+{
+    /* A T flip-flop toggled every other tick, with a small group so records span several keyframes. */
+    LogicTFlipFlop tff;
+    tff.connectPredecessor(0, sw.at(0), 0);
+    tff.connectPredecessor(1, sw.at(1), 0);
+    tff.connectPredecessor(2, sw.at(2), 0);
+    tff.connectPredecessor(3, sw.at(2), 0);
+    CompiledNetlist netlist(QVector<LogicElement *>{sw.at(0), sw.at(1), sw.at(2), &tff});
+    netlist.setValue(netlist.outputSlot(sw.at(0)), true);
+    netlist.setValue(netlist.outputSlot(sw.at(2)), true);
+    StateHistory history(StateHistory::DefaultCapacity, 4);
+    QVector<std::vector<uint8_t>> states;
+    std::vector<uint8_t> state;
+    for (quint64 tick = 0; tick < 20; ++tick) {
+        netlist.setValue(netlist.outputSlot(sw.at(1)), (tick & 1) != 0);
+        netlist.update();
+        state.clear();
+        netlist.saveState(state);
+        QCOMPARE(static_cast<int>(state.size()), netlist.stateVectorSize());
+        history.record(tick * 10, state);
+        states.append(state);
+    }
+    QCOMPARE(history.count(), 20);
+    QCOMPARE(history.indexOf(55), 5);
+    QCOMPARE(history.indexOf(1000), 19);
+    for (int idx = 0; idx < history.count(); ++idx) {
+        history.state(idx, state);
+        QVERIFY(state == states.at(idx));
+    }
+
+    /* Restoring a record brings back the flip-flop, which then runs on as it did the first time. */
+    const bool before = netlist.value(netlist.outputSlot(&tff));
+    history.state(6, state);
+    netlist.restoreState(state.data());
+    QCOMPARE(netlist.value(netlist.outputSlot(&tff)), static_cast<bool>(states.at(6)[static_cast<size_t>(netlist.outputSlot(&tff))]));
+    for (int tick = 7; tick < 20; ++tick) {
+        netlist.setValue(netlist.outputSlot(sw.at(1)), (tick & 1) != 0);
+        netlist.update();
+    }
+    QCOMPARE(netlist.value(netlist.outputSlot(&tff)), before);
+
+    /* Recording at an earlier tick drops the records after it. */
+    history.record(65, states.at(0));
+    QCOMPARE(history.count(), 8);
+    QCOMPARE(history.tick(7), quint64(65));
+    history.state(6, state);
+    QVERIFY(state == states.at(6));
+    history.state(7, state);
+    QVERIFY(state == states.at(0));
+}
+
+void TestLogicElements::testInputLog()
+{
+    InputLog log(3);
+    log.append(1, 0, true);
+    log.append(1, 2, false);
+    log.append(40, 1, true);
+    log.append(100000, 2, true);
+    log.setEndTick(100010);
+    const std::vector<uint8_t> data = log.serialize();
+    InputLog loaded;
+    QVERIFY(loaded.deserialize(data.data(), data.size()));
+    QCOMPARE(loaded.inputCount(), 3);
+    QCOMPARE(loaded.count(), 4);
+    QCOMPARE(loaded.endTick(), quint64(100010));
+
+    /* A reader starts at the first event on or after its tick. */
+    InputLog::Reader reader(&loaded, 2);
+    QCOMPARE(reader.tick(), quint64(40));
+    QCOMPARE(reader.event().input, 1);
+    QCOMPARE(reader.event().value, true);
+    reader.advance();
+    QCOMPARE(reader.tick(), quint64(100000));
+    QCOMPARE(reader.event().input, 2);
+    reader.advance();
+    QCOMPARE(reader.tick(), InputLog::Reader::End);
+
+    /* A truncated file is refused as a whole. */
+    QVERIFY(!loaded.deserialize(data.data(), data.size() - 1));
+    QVERIFY(loaded.isEmpty());
+}
+
+void TestLogicElements::testParallelNetlist()
+{
+    LogicXor xorElm(2);
+    LogicDemux demux;
+    LogicSRFlipFlop srff;
+    LogicDLatch latch;
+    xorElm.connectPredecessor(0, sw.at(0), 0);
+    xorElm.connectPredecessor(1, sw.at(1), 0);
+    demux.connectPredecessor(0, &xorElm, 0);
+    demux.connectPredecessor(1, sw.at(2), 0);
+    srff.connectPredecessor(0, &demux, 0);
+    srff.connectPredecessor(1, sw.at(3), 0);
+    srff.connectPredecessor(2, &demux, 1);
+    srff.connectPredecessor(3, sw.at(4), 0);
+    srff.connectPredecessor(4, sw.at(4), 0);
+    latch.connectPredecessor(0, &srff, 1);
+    latch.connectPredecessor(1, sw.at(0), 0);
+
+    const QVector<LogicElement *> elms{sw.at(0), sw.at(1), sw.at(2), sw.at(3), sw.at(4), &xorElm, &demux, &srff, &latch};
+    CompiledNetlist netlist(elms);
+    QVERIFY(!netlist.hasFeedback());
+    QVERIFY(!netlist.isCombinational());
+
+    /* Every lane is an independent copy of the circuit: compare each of them with a scalar netlist. */
+    QVector<CompiledNetlist *> scalar;
+    for (int lane = 0; lane < ParallelNetlist::Lanes; ++lane) {
+        scalar.append(new CompiledNetlist(elms));
+    }
+    ParallelNetlist parallel(netlist);
+    quint64 seed = 0x9E3779B97F4A7C15ull;
+    for (int tick = 0; tick < 16; ++tick) {
+        for (int in = 0; in < sw.size(); ++in) {
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            const ParallelNetlist::Word word = (in == 4) ? ~ParallelNetlist::Word(0) : seed;
+            const int slot = netlist.outputSlot(sw.at(in));
+            parallel.setLanes(slot, word);
+            for (int lane = 0; lane < ParallelNetlist::Lanes; ++lane) {
+                scalar.at(lane)->setValue(slot, (word >> lane) & 1);
+            }
+        }
+        parallel.update();
+        for (int lane = 0; lane < ParallelNetlist::Lanes; ++lane) {
+            scalar.at(lane)->update();
+            for (int slot = 0; slot < netlist.signalCount(); ++slot) {
+                QCOMPARE(bool((parallel.lanes(slot) >> lane) & 1), scalar.at(lane)->value(slot));
+            }
+        }
+    }
+    qDeleteAll(scalar);
+}
+
+void TestLogicElements::testMultiThreadedNetlist()
+{
+    /* Layers of XOR, AND and D flip-flops, each layer reading the previous one, large enough for the threaded sweep. */
+    const int width = 64;
+    const int depth = CompiledNetlist::ParallelThreshold / width + 1;
+    QVector<LogicElement *> elms(sw.cbegin(), sw.cend());
+    QVector<LogicElement *> gates;
+    QVector<LogicElement *> previous = elms;
+    for (int layer = 0; layer < depth; ++layer) {
+        QVector<LogicElement *> current;
+        for (int col = 0; col < width; ++col) {
+            LogicElement *left = previous.at(col % previous.size());
+            LogicElement *right = previous.at((col * 7 + layer + 1) % previous.size());
+            LogicElement *gate;
+            switch ((layer + col) % 3) {
+            case 0:
+                gate = new LogicXor(2);
+                gate->connectPredecessor(0, left, 0);
+                gate->connectPredecessor(1, right, 0);
+                break;
+            case 1:
+                gate = new LogicAnd(2);
+                gate->connectPredecessor(0, left, 0);
+                gate->connectPredecessor(1, right, 0);
+                break;
+            default:
+                gate = new LogicDFlipFlop();
+                gate->connectPredecessor(0, left, 0);
+                gate->connectPredecessor(1, sw.at(col % sw.size()), 0);
+                gate->connectPredecessor(2, right, 0);
+                gate->connectPredecessor(3, sw.at(4), 0);
+                break;
+            }
+            current.append(gate);
+        }
+        gates += current;
+        previous = current;
+    }
+    elms += gates;
+
+    WorkerPool pool(4);
+    CompiledNetlist serial(elms);
+    CompiledNetlist threaded(elms);
+    threaded.setWorkerPool(&pool);
+    QVERIFY(!serial.isMultiThreaded());
+    QVERIFY(threaded.isMultiThreaded());
+    QCOMPARE(threaded.levelCount(), depth);
+
+    for (int tick = 0; tick < 32; ++tick) {
+        for (int in = 0; in < sw.size(); ++in) {
+            const bool value = (in == 4) || (((tick * 5) >> in) & 1);
+            serial.setValue(serial.outputSlot(sw.at(in)), value);
+            threaded.setValue(threaded.outputSlot(sw.at(in)), value);
+        }
+        serial.update();
+        threaded.update();
+        for (int slot = 0; slot < serial.signalCount(); ++slot) {
+            QCOMPARE(threaded.value(slot), serial.value(slot));
+        }
+    }
+    qDeleteAll(gates);
+}
+
+void TestLogicElements::testNativeNetlist()
+{
+    LogicNand nandElm(2);
+    LogicJKFlipFlop jkff;
+    LogicTFlipFlop tff;
+    LogicDemux demux;
+    nandElm.connectPredecessor(0, sw.at(0), 0);
+    nandElm.connectPredecessor(1, &tff, 1);
+    jkff.connectPredecessor(0, &nandElm, 0);
+    jkff.connectPredecessor(1, sw.at(1), 0);
+    jkff.connectPredecessor(2, sw.at(2), 0);
+    jkff.connectPredecessor(3, sw.at(3), 0);
+    jkff.connectPredecessor(4, sw.at(4), 0);
+    tff.connectPredecessor(0, &jkff, 0);
+    tff.connectPredecessor(1, sw.at(1), 0);
+    tff.connectPredecessor(2, sw.at(4), 0);
+    tff.connectPredecessor(3, sw.at(4), 0);
+    demux.connectPredecessor(0, &tff, 0);
+    demux.connectPredecessor(1, &jkff, 1);
+
+    const QVector<LogicElement *> elms{sw.at(0), sw.at(1), sw.at(2), sw.at(3), sw.at(4), &nandElm, &jkff, &tff, &demux};
+    CompiledNetlist interpreted(elms);
+    CompiledNetlist native(elms);
+    QVERIFY(NativeCompiler::generateSource(native).contains("wpanda_update"));
+    if (NativeCompiler::compilerPath().isEmpty()) {
+        QSKIP("No C++ compiler available.");
+    }
+    QTemporaryDir cache;
+    QVERIFY(cache.isValid());
+    NativeCompiler::setCacheDirectory(cache.path());
+    NativeCompiler build(native);
+    QTRY_VERIFY_WITH_TIMEOUT(build.isFinished(), 60000);
+    native.setNativeUpdate(build.result());
+    QVERIFY(native.isNative());
+
+    /* Loading another module evicts the least recently used ones beyond the limit, here the stale copies. */
+    const QFileInfoList modules = QDir(cache.path()).entryInfoList(QDir::Files);
+    QCOMPARE(modules.size(), 1);
+    for (int idx = 0; idx < NativeCompiler::CacheLimit; ++idx) {
+        QFile stale(cache.filePath(QString("stale%1.%2").arg(idx).arg(modules.first().suffix())));
+        QVERIFY(stale.open(QIODevice::WriteOnly));
+        QVERIFY(stale.setFileTime(QDateTime::currentDateTime().addDays(-1), QFileDevice::FileModificationTime));
+    }
+    CompiledNetlist other(elms.mid(0, 6));
+    QVERIFY(NativeCompiler::load(other));
+    QCOMPARE(QDir(cache.path()).entryInfoList(QDir::Files).size(), NativeCompiler::CacheLimit);
+    QVERIFY(QFile::exists(modules.first().absoluteFilePath()));
+    NativeCompiler::setCacheDirectory(QString());
+
+    for (int tick = 0; tick < 64; ++tick) {
+        for (int in = 0; in < sw.size(); ++in) {
+            const bool value = (in >= 3) ? (tick % 19 != 0) : ((tick >> in) & 1);
+            interpreted.setValue(interpreted.outputSlot(sw.at(in)), value);
+            native.setValue(native.outputSlot(sw.at(in)), value);
+        }
+        interpreted.update();
+        native.update();
+        for (int slot = 0; slot < interpreted.signalCount(); ++slot) {
+            QCOMPARE(native.value(slot), interpreted.value(slot));
+        }
+    }
+}
+
+void TestLogicElements::testBytecodeNetlist()
+{
+    /* The NOT followed by the AND it feeds becomes one fused instruction. */
+    LogicNot notElm;
+    LogicAnd andElm(2);
+    LogicOr orElm(3);
+    LogicSRFlipFlop srff;
+    LogicDLatch latch;
+    LogicDemux demux;
+    notElm.connectPredecessor(0, sw.at(0), 0);
+    andElm.connectPredecessor(0, sw.at(1), 0);
+    andElm.connectPredecessor(1, &notElm, 0);
+    orElm.connectPredecessor(0, &andElm, 0);
+    orElm.connectPredecessor(1, sw.at(2), 0);
+    orElm.connectPredecessor(2, &latch, 1);
+    srff.connectPredecessor(0, &orElm, 0);
+    srff.connectPredecessor(1, sw.at(3), 0);
+    srff.connectPredecessor(2, &notElm, 0);
+    srff.connectPredecessor(3, sw.at(4), 0);
+    srff.connectPredecessor(4, sw.at(4), 0);
+    latch.connectPredecessor(0, &srff, 0);
+    latch.connectPredecessor(1, sw.at(2), 0);
+    demux.connectPredecessor(0, &latch, 0);
+    demux.connectPredecessor(1, sw.at(1), 0);
+
+    const QVector<LogicElement *> elms{sw.at(0), sw.at(1), sw.at(2), sw.at(3), sw.at(4), &notElm, &andElm, &orElm, &srff, &latch, &demux};
+    CompiledNetlist interpreted(elms);
+    interpreted.setBytecode(false);
+    QVERIFY(!interpreted.bytecode());
+    CompiledNetlist bytecode(elms);
+    QVERIFY(bytecode.bytecode());
+    QCOMPARE(bytecode.bytecode()->fusedCount(), 1);
+    QCOMPARE(bytecode.bytecode()->instructionCount(), bytecode.gateCount() - 1);
+
+    for (int tick = 0; tick < 64; ++tick) {
+        for (int in = 0; in < sw.size(); ++in) {
+            const bool value = (in >= 4) ? (tick % 13 != 0) : ((tick >> in) & 1);
+            interpreted.setValue(interpreted.outputSlot(sw.at(in)), value);
+            bytecode.setValue(bytecode.outputSlot(sw.at(in)), value);
+        }
+        interpreted.update();
+        bytecode.update();
+        for (int slot = 0; slot < interpreted.signalCount(); ++slot) {
+            QCOMPARE(bytecode.value(slot), interpreted.value(slot));
+        }
+    }
+}
+
+void TestLogicElements::benchmarkGateKernels_data()
+{
+    QTest::addColumn<bool>("legacy");
+    QTest::newRow("legacy") << true;
+    QTest::newRow("kernel") << false;
+}
+
+void TestLogicElements::benchmarkGateKernels()
+{
+    QFETCH(bool, legacy);
+    /* A chain of four input AND gates, each one reading the previous gate and three switches. */
+    const int gateCount = 1024;
+    QVector<LogicElement *> gates;
+    for (int idx = 0; idx < gateCount; ++idx) {
+        auto *gate = new LogicAnd(4);
+        gate->connectPredecessor(0, gates.isEmpty() ? sw.at(0) : gates.last(), 0);
+        for (int in = 1; in < 4; ++in) {
+            gate->connectPredecessor(in, sw.at(in), 0);
+        }
+        gates.append(gate);
+    }
+    for (LogicInput *input : qAsConst(sw)) {
+        input->setOutputValue(true);
+    }
+    const LegacyAnd legacyAnd;
+    const LegacyGate &legacyGate = legacyAnd;
+    std::vector<bool> inputValues(4);
+    QBENCHMARK {
+        for (LogicElement *gate : qAsConst(gates)) {
+            if (legacy) {
+                for (size_t in = 0; in < gate->inputSize(); ++in) {
+                    inputValues[in] = gate->getInputValue(in);
+                }
+                gate->setOutputValue(legacyGate.update(inputValues));
+            } else {
+                gate->updateLogic();
+            }
+        }
+    }
+    QVERIFY(gates.last()->getOutputValue());
+    qDeleteAll(gates);
+}
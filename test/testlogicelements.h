@@ -36,6 +36,25 @@ private slots:
     void testLogicJKFlipFlop();
     void testLogicSRFlipFlop();
     void testLogicTFlipFlop();
+    void testSelfFedFlipFlops();
+    void testCompiledNetlist();
+    void testEventDrivenNetlist();
+    void testSettledLoop();
+    void testConstantFolding();
+    void testBufferAliases();
+    void testUnobservedPruning();
+    void testStructuralHashing();
+    void testTimingWheel();
+    void testWorkerSpeed();
+    void testTimedNetlist();
+    void testStateHistory();
+    void testInputLog();
+    void testParallelNetlist();
+    void testMultiThreadedNetlist();
+    void testNativeNetlist();
+    void testBytecodeNetlist();
+    void benchmarkGateKernels_data();
+    void benchmarkGateKernels();
 };
 
 #endif // TESTLOGICELEMENTS_H
\ No newline at end of file
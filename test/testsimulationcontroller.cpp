@@ -4,11 +4,22 @@
 #include "testsimulationcontroller.h"
 
 #include "and.h"
+#include "clock.h"
+#include "commands.h"
+#include "delaydialog.h"
+#include "dflipflop.h"
 #include "elementmapping.h"
 #include "graphicelement.h"
 #include "inputbutton.h"
+#include "inputswitch.h"
 #include "led.h"
+#include "logicelement.h"
+#include "not.h"
 #include "qneconnection.h"
+#include "qneport.h"
+#include "simulationcontroller.h"
+#include "simulationworker.h"
+#include "timednetlist.h"
 
 void TestSimulationController::init()
 {
@@ -20,6 +31,22 @@ void TestSimulationController::cleanup()
     editor->deleteLater();
 }
 
+QNEConnection *TestSimulationController::buildInverterCircuit(GraphicElement *input, Not *notItem, Led *led)
+{
+    QNEConnection *conn = new QNEConnection();
+    QNEConnection *conn2 = new QNEConnection();
+    editor->getScene()->addItem(input);
+    editor->getScene()->addItem(notItem);
+    editor->getScene()->addItem(led);
+    editor->getScene()->addItem(conn);
+    editor->getScene()->addItem(conn2);
+    conn->setStart(input->output());
+    conn->setEnd(notItem->input());
+    conn2->setStart(notItem->output());
+    conn2->setEnd(led->input());
+    return conn2;
+}
+
 void TestSimulationController::testCase1()
 {
     InputButton *btn1 = new InputButton();
@@ -47,4 +74,370 @@ void TestSimulationController::testCase1()
     QVERIFY(elms.at(0) == btn2 || elms.at(1) == btn2);
     QVERIFY(elms.at(2) == andItem);
     QVERIFY(elms.at(3) == led);
-}
\ No newline at end of file
+}
+
+void TestSimulationController::testThreadedSimulation()
+{
+    InputButton *btn = new InputButton();
+    Not *notItem = new Not();
+    Led *led = new Led();
+    buildInverterCircuit(btn, notItem, led);
+
+    SimulationController *sc = editor->getSimulationController();
+    sc->setThreaded(true);
+    sc->start();
+    QVERIFY(sc->isRunning());
+    /* Input changes reach the worker on the next view update, and results come back in a later snapshot. */
+    auto ledValue = [&] {
+        sc->updateAll();
+        return static_cast<int>(led->input()->value());
+    };
+    QTRY_COMPARE(ledValue(), 1);
+    btn->setOn(true);
+    QTRY_COMPARE(ledValue(), 0);
+    btn->setOn(false);
+    QTRY_COMPARE(ledValue(), 1);
+    sc->stop();
+    QVERIFY(!sc->isRunning());
+}
+
+void TestSimulationController::testWorkerClockPhase()
+{
+    Clock *clk = new Clock();
+    Led *led = new Led();
+    QNEConnection *conn = new QNEConnection();
+    editor->getScene()->addItem(clk);
+    editor->getScene()->addItem(led);
+    editor->getScene()->addItem(conn);
+    conn->setStart(clk->output());
+    conn->setEnd(led->input());
+
+    SimulationController *sc = editor->getSimulationController();
+    sc->setThreaded(true);
+    sc->setSpeed(20);
+    sc->start();
+    /* The clock element follows the phase of the worker, not only its value. */
+    QTRY_VERIFY([&] {
+        sc->updateAll();
+        return (sc->tickCount() > static_cast<quint64>(clk->interval())) && (clk->elapsed() != 0);
+    }());
+    QVERIFY(clk->elapsed() > 0);
+    QVERIFY(clk->elapsed() < clk->interval());
+    sc->stop();
+    sc->setSpeed(1);
+}
+
+void TestSimulationController::testSimulationSpeed()
+{
+    InputButton *btn = new InputButton();
+    Led *led = new Led();
+    QNEConnection *conn = new QNEConnection();
+    editor->getScene()->addItem(btn);
+    editor->getScene()->addItem(led);
+    editor->getScene()->addItem(conn);
+    conn->setStart(btn->output());
+    conn->setEnd(led->input());
+
+    SimulationController *sc = editor->getSimulationController();
+    /* Without the worker, every timer tick runs speed ticks. The timer only fires from the event loop. */
+    sc->setThreaded(false);
+    sc->setSpeed(1);
+    sc->start();
+    quint64 ticks = sc->tickCount();
+    QVERIFY(QMetaObject::invokeMethod(sc, "timerTick"));
+    QCOMPARE(sc->tickCount(), ticks + 1);
+    sc->setSpeed(8);
+    ticks = sc->tickCount();
+    QVERIFY(QMetaObject::invokeMethod(sc, "timerTick"));
+    QCOMPARE(sc->tickCount(), ticks + 8);
+    sc->stop();
+
+    /* The worker count stops with the worker. How the worker runs its speed is checked on the worker itself. */
+    sc->setThreaded(true);
+    sc->setSpeed(SimulationWorker::TurboSpeed);
+    sc->start();
+    QTRY_VERIFY_WITH_TIMEOUT(sc->tickCount() > ticks, 2000);
+    sc->stop();
+    ticks = sc->tickCount();
+    QTest::qWait(20);
+    QCOMPARE(sc->tickCount(), ticks);
+    sc->setSpeed(1);
+}
+
+void TestSimulationController::testIncrementalPatch()
+{
+    InputSwitch *data = new InputSwitch();
+    InputButton *clk = new InputButton();
+    DFlipFlop *dff = new DFlipFlop();
+    Led *led = new Led();
+    QNEConnection *conn = new QNEConnection();
+    QNEConnection *conn2 = new QNEConnection();
+    QNEConnection *conn3 = new QNEConnection();
+    editor->getScene()->addItem(data);
+    editor->getScene()->addItem(clk);
+    editor->getScene()->addItem(dff);
+    editor->getScene()->addItem(led);
+    editor->getScene()->addItem(conn);
+    editor->getScene()->addItem(conn2);
+    editor->getScene()->addItem(conn3);
+    conn->setStart(data->output());
+    conn->setEnd(dff->input(0));
+    conn2->setStart(clk->output());
+    conn2->setEnd(dff->input(1));
+    conn3->setStart(dff->output(0));
+    conn3->setEnd(led->input());
+
+    SimulationController *sc = editor->getSimulationController();
+    sc->setThreaded(false);
+    sc->start();
+    data->setOn(true);
+    sc->update();
+    clk->setOn(true);
+    sc->update();
+    data->setOn(false);
+    clk->setOn(false);
+    sc->update();
+    sc->updateAll();
+    QCOMPARE(static_cast<int>(led->input()->value()), 1);
+
+    /* Edits through the undo commands patch the netlist, so the flip-flop keeps its state. */
+    Not *notItem = new Not();
+    Led *led2 = new Led();
+    QNEConnection *conn4 = new QNEConnection();
+    QNEConnection *conn5 = new QNEConnection();
+    editor->getScene()->addItem(conn4);
+    editor->getScene()->addItem(conn5);
+    conn4->setStart(data->output());
+    conn4->setEnd(notItem->input());
+    conn5->setStart(notItem->output());
+    conn5->setEnd(led2->input());
+    editor->receiveCommand(new AddItemsCommand(QList<QGraphicsItem *>({notItem, led2}), editor));
+    sc->update();
+    sc->updateAll();
+    QCOMPARE(static_cast<int>(led->input()->value()), 1);
+    QCOMPARE(static_cast<int>(led2->input()->value()), 1);
+
+    editor->receiveCommand(new DeleteItemsCommand(notItem, editor));
+    sc->update();
+    sc->updateAll();
+    QCOMPARE(static_cast<int>(led->input()->value()), 1);
+    QCOMPARE(static_cast<int>(led2->input()->value()), -1);
+
+    editor->getUndoStack()->undo();
+    sc->update();
+    sc->updateAll();
+    QCOMPARE(static_cast<int>(led->input()->value()), 1);
+    QCOMPARE(static_cast<int>(led2->input()->value()), 1);
+    sc->stop();
+}
+
+void TestSimulationController::testChangedSlots()
+{
+    InputButton *btn = new InputButton();
+    Not *notItem = new Not();
+    Led *led = new Led();
+    buildInverterCircuit(btn, notItem, led);
+
+    ElementMapping mapping(editor->getScene()->getElements());
+    QVERIFY(mapping.canInitialize());
+    mapping.initialize();
+    mapping.sort();
+    /* A new netlist is shown in full, then only what changes is reported. */
+    QVector<int> changed;
+    QVERIFY(!mapping.takeChangedSlots(changed));
+    mapping.update();
+    mapping.update();
+    QVERIFY(mapping.takeChangedSlots(changed));
+    QVERIFY(mapping.takeChangedSlots(changed));
+    QVERIFY(changed.isEmpty());
+    btn->setOn(true);
+    mapping.update();
+    QVERIFY(mapping.takeChangedSlots(changed));
+    QVERIFY(changed.contains(mapping.outputSlot(mapping.getLogicElement(btn))));
+    QVERIFY(changed.contains(mapping.inputSlot(mapping.getLogicElement(led))));
+    mapping.update();
+    QVERIFY(mapping.takeChangedSlots(changed));
+    QVERIFY(changed.isEmpty());
+}
+
+void TestSimulationController::testObservePruned()
+{
+    InputButton *btn = new InputButton();
+    Not *notItem = new Not();
+    Led *led = new Led();
+    buildInverterCircuit(btn, notItem, led);
+    /* A second inverter with its output unwired: nothing shows it. */
+    Not *unwired = new Not();
+    QNEConnection *conn = new QNEConnection();
+    editor->getScene()->addItem(unwired);
+    editor->getScene()->addItem(conn);
+    conn->setStart(btn->output());
+    conn->setEnd(unwired->input());
+
+    ElementMapping mapping(editor->getScene()->getElements());
+    QVERIFY(mapping.canInitialize());
+    mapping.initialize();
+    mapping.sort();
+    LogicElement *logElm = mapping.getLogicElement(unwired);
+    QVERIFY(mapping.isPruned(logElm));
+    mapping.update();
+    mapping.observe(logElm);
+    QVERIFY(!mapping.isPruned(logElm));
+    /* Compared with the LogicElement graph, which evaluates everything. */
+    LogicElement *input = mapping.getLogicElement(btn);
+    for (bool value : {false, true, false}) {
+        btn->setOn(value);
+        mapping.update();
+        input->setOutputValue(value);
+        for (LogicElement *elm : mapping.logicElements()) {
+            elm->updateLogic();
+        }
+        QCOMPARE(mapping.getOutputValue(logElm, 0), logElm->getOutputValue(0));
+        QCOMPARE(mapping.getOutputValue(logElm, 0), !value);
+    }
+}
+
+void TestSimulationController::testHistoryInterval()
+{
+    InputButton *btn = new InputButton();
+    Not *notItem = new Not();
+    Led *led = new Led();
+    buildInverterCircuit(btn, notItem, led);
+
+    /* By default a state is kept every DefaultHistoryInterval ticks, starting with the first one. */
+    ElementMapping mapping(editor->getScene()->getElements());
+    QVERIFY(mapping.canInitialize());
+    mapping.initialize();
+    mapping.sort();
+    QVERIFY(mapping.historyInterval() == ElementMapping::DefaultHistoryInterval);
+    for (int tick = 0; tick < 2 * ElementMapping::DefaultHistoryInterval + 1; ++tick) {
+        mapping.update();
+    }
+    QCOMPARE(mapping.history().count(), 3);
+
+    ElementMapping disabled(editor->getScene()->getElements());
+    disabled.initialize();
+    disabled.sort();
+    disabled.setHistoryInterval(0);
+    for (int tick = 0; tick < ElementMapping::DefaultHistoryInterval; ++tick) {
+        disabled.update();
+    }
+    QCOMPARE(disabled.history().count(), 0);
+    QVERIFY(!disabled.stepHistory(-1));
+}
+
+void TestSimulationController::testGateDelays()
+{
+    InputButton *btn = new InputButton();
+    Not *notItem = new Not();
+    Led *led = new Led();
+    buildInverterCircuit(btn, notItem, led);
+
+    /* The delays go through the editor the way the waveform window reads them back. */
+    const QVector<int> saved;
+    DelayDialog dialog(saved);
+    QCOMPARE(dialog.delays().size(), static_cast<int>(TimedNetlist::TypeCount));
+    QCOMPARE(dialog.delays().at(static_cast<int>(LogicType::NOT)), TimedNetlist::defaultDelay(LogicType::NOT));
+    dialog.setDelay(static_cast<int>(LogicType::NOT), 3);
+    const QVector<int> delays = dialog.delays();
+    QCOMPARE(DelayDialog(delays).delays(), delays);
+
+    ElementMapping mapping(editor->getScene()->getElements());
+    QVERIFY(mapping.canInitialize());
+    mapping.initialize();
+    mapping.sort();
+    mapping.update();
+    const QVector<QVector<uchar>> stimulus = {{0, 1, 1, 1, 1, 1}};
+    QVector<QVector<uchar>> results;
+    /* The button rises in column 1 and the inverter answers three units later, or one by default. */
+    QVERIFY(mapping.simulateTimed({btn}, ElementMapping::outputPorts({led}), stimulus, delays, results));
+    QCOMPARE(results, QVector<QVector<uchar>>({{1, 1, 1, 1, 0, 0}}));
+    QVERIFY(mapping.simulateTimed({btn}, ElementMapping::outputPorts({led}), stimulus, QVector<int>(), results));
+    QCOMPARE(results, QVector<QVector<uchar>>({{1, 0, 0, 0, 0, 0}}));
+}
+
+void TestSimulationController::testPortBindings()
+{
+    InputButton *btn = new InputButton();
+    Not *notItem = new Not();
+    Led *led = new Led();
+    buildInverterCircuit(btn, notItem, led);
+
+    SimulationController *sc = editor->getSimulationController();
+    sc->setThreaded(false);
+    sc->start();
+    sc->update();
+    sc->updateView();
+    QCOMPARE(static_cast<int>(notItem->output()->value()), 1);
+    QCOMPARE(static_cast<int>(led->input()->value()), 1);
+    btn->setOn(true);
+    sc->update();
+    sc->updateView();
+    QCOMPARE(static_cast<int>(notItem->output()->value()), 0);
+    QCOMPARE(static_cast<int>(led->input()->value()), 0);
+
+    /* A patch binds the new ports and keeps the others. */
+    Not *notItem2 = new Not();
+    Led *led2 = new Led();
+    QNEConnection *conn3 = new QNEConnection();
+    QNEConnection *conn4 = new QNEConnection();
+    editor->getScene()->addItem(conn3);
+    editor->getScene()->addItem(conn4);
+    conn3->setStart(notItem->output());
+    conn3->setEnd(notItem2->input());
+    conn4->setStart(notItem2->output());
+    conn4->setEnd(led2->input());
+    editor->receiveCommand(new AddItemsCommand(QList<QGraphicsItem *>({notItem2, led2}), editor));
+    sc->update();
+    sc->updateView();
+    QCOMPARE(static_cast<int>(led->input()->value()), 0);
+    QCOMPARE(static_cast<int>(led2->input()->value()), 1);
+
+    editor->receiveCommand(new DeleteItemsCommand(notItem2, editor));
+    sc->update();
+    sc->updateView();
+    QCOMPARE(static_cast<int>(led->input()->value()), 0);
+    QCOMPARE(static_cast<int>(led2->input()->value()), -1);
+    btn->setOn(false);
+    sc->update();
+    sc->updateView();
+    QCOMPARE(static_cast<int>(led->input()->value()), 1);
+    sc->stop();
+}
+
+void TestSimulationController::testSteadyFrames()
+{
+    InputSwitch *sw = new InputSwitch();
+    Not *notItem = new Not();
+    Led *led = new Led();
+    QNEConnection *conn2 = buildInverterCircuit(sw, notItem, led);
+
+    /* Ports and connections only restyle when their state changes. */
+    notItem->output()->setValue(1);
+    const quint64 repaints = SimulationController::repaintCount();
+    notItem->output()->setValue(1);
+    led->input()->setValue(1);
+    QCOMPARE(SimulationController::repaintCount(), repaints);
+    QCOMPARE(static_cast<int>(conn2->status()), static_cast<int>(QNEConnection::Status::Active));
+
+    SimulationController *sc = editor->getSimulationController();
+    sc->setThreaded(false);
+    sc->start();
+    sc->update();
+    sc->updateView();
+    QVERIFY(sc->frameRepaintCount() > 0);
+    sc->update();
+    sc->updateView();
+    sc->update();
+    sc->updateView();
+    QCOMPARE(sc->frameRepaintCount(), 0);
+    sw->setOn(true);
+    sc->update();
+    sc->updateView();
+    QVERIFY(sc->frameRepaintCount() > 0);
+    QCOMPARE(static_cast<int>(conn2->status()), static_cast<int>(QNEConnection::Status::Inactive));
+    sc->update();
+    sc->updateView();
+    QCOMPARE(sc->frameRepaintCount(), 0);
+    sc->stop();
+}
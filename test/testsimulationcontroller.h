@@ -12,6 +12,9 @@
 #include "editor.h"
 
 class GraphicElement;
+class Led;
+class Not;
+class QNEConnection;
 
 class TestSimulationController : public QObject
 {
@@ -19,12 +22,26 @@ class TestSimulationController : public QObject
 
     QVector<GraphicElement *> elms;
     Editor *editor;
+
+    //! Adds input, notItem and led to the scene, wired input -> notItem -> led. Returns the connection to led.
+    QNEConnection *buildInverterCircuit(GraphicElement *input, Not *notItem, Led *led);
+
 private slots:
 
     /* functions executed by QtTest before and after each test */
     void init();
     void cleanup();
     void testCase1();
+    void testThreadedSimulation();
+    void testWorkerClockPhase();
+    void testSimulationSpeed();
+    void testIncrementalPatch();
+    void testChangedSlots();
+    void testObservePruned();
+    void testHistoryInterval();
+    void testGateDelays();
+    void testPortBindings();
+    void testSteadyFrames();
 };
 
 #endif /* TESTSIMULATIONCONTROLLER_H */
\ No newline at end of file